@@ -1,6 +1,10 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <iostream>
+#include <vector>
+
+#include "service_installer/Platform.hpp"
 
 namespace svcinst {
 
@@ -11,6 +15,12 @@ namespace svcinst {
 	Uninstall,
 	Start,
 	Stop,
+	Status,						// Состояние службы (--status)
+	Manifest,					// Пакетный режим: команды из файла (--manifest=)
+	Stream,						// Потоковый режим: команды построчно из stdin (--stdin)
+	Reconcile,					// Приведение установленных служб к желаемому состоянию (--reconcile=)
+	Serve,						// Агент: команды от локальных клиентов через Unix-сокет (--serve=)
+	Reclaim,					// Фоновый уборщик (--reclaim=/--reclaim-dir=, запускается самим установщиком)
 	Invalid
 	};
 
@@ -34,6 +44,8 @@ namespace svcinst {
 		std::string exe;			//	Путь к EXE
 		std::string args;			//	Аргументы командной строки для EXE
 		std::string description;	//	Описание службы
+		std::string dependsOn;		//	Зависимости через запятую: службы, запускаемые раньше (--depends-on=)
+		std::string group;			//	Группа служб через запятую для --start/--stop с учётом зависимостей (--group=)
 
 		//---Флаги
 		bool runNow = false;		//	Запустить службу сразу после установки
@@ -43,9 +55,34 @@ namespace svcinst {
 
 		std::string dataRoot;       // путь к данным (если нужен)
 		bool fromInno = false;      // чтобы на Windows не удалять {app} из helper'а
+		bool trash = false;         // --delete через корзину ФС и фоновую очистку (--trash)
+		bool throttle = false;      // Щадящее удаление: idle I/O, nice 19, пауза по PSI (--throttle)
+		std::uint32_t maxUnlinks = 0;		// Лимит удалений в секунду при --throttle, 0 - нет (--max-unlinks=)
+		std::uint64_t maxDeleteBytes = 0;	// Лимит объёма удаления в секунду при --throttle, 0 - нет (--max-delete-bytes=)
+		std::vector<std::string> dataInclude;	// Выборочная очистка DataRoot: удалять только совпавшее (--data-include=<glob>)
+		std::vector<std::string> dataExclude;	// и оставить совпавшее вместе с содержимым (--data-exclude=<glob>)
+
+		BackendKind backend = BackendKind::Default;	//	Бэкенд управления службами (--backend=)
+		EnableMode enableMode = EnableMode::Links;	//	Способ enable/disable (--enable-via=)
+		std::string root;							//	Offline-режим: корень образа/chroot (--root=)
+		Durability durability = Durability::File;	//	fsync записанных unit'ов (--durability=)
+		std::uint32_t lockWaitMs = 30000;			//	Ожидание блокировки службы, мс (--lock-wait=)
+		std::string manifest;						//	Пакетный режим: файл со списком команд (--manifest=)
+		std::string reconcile;						//	Файл желаемого состояния служб (--reconcile=)
+		bool plan = false;							//	Только показать шаги, ничего не меняя (--plan)
+		std::string serve;							//	Агент: путь Unix-сокета (--serve=)
+		std::uint32_t workers = 4;					//	Агент: число рабочих потоков (--workers=)
+		std::string reclaim;						//	Уборщик: очищаемая корзина (--reclaim=) или каталог (--reclaim-dir=)
+		bool reclaimDir = false;					//	Уборщик: reclaim - каталог, удаляется целиком
+		std::string reclaimWait;					//	Уборщик: билет и чей выход ждать, <token>[,pidfd:<fd>|,pid:<pid>|,delay:<ms>] (--wait-for=)
+
+		std::string error;							//	Причина Command::Invalid (неизвестная опция, конфликт, неверное значение)
 	};
 
+	//---Разбор argv (argv[0] - имя программы); @файл подставляет аргументы из файла
 	CliOptions parceCli(int argc, char** argv);
+	//---Разбор аргументов без имени программы (строки манифеста, запросы агента)
+	CliOptions parceCli(const std::vector<std::string>& args);
 	void printHelp(std::ostream& os);
 
 };//---namespace svcinst
\ No newline at end of file
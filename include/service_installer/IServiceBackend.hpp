@@ -1,18 +1,122 @@
 #pragma once
 #include <string>
+#include <vector>
 #include "ServiceSpec.hpp"
 
 namespace svcinst {
 
+	//---Что фактически сделал installOrUpdate
+	//	Повторная установка той же спецификации ничего не меняет: unit совпадает с файлом на диске,
+	//	автозапуск уже в нужном состоянии - запись, reload, enable и restart пропускаются.
+	struct InstallReport final {
+		bool unitWritten = false;		//	Unit-файл / конфигурация службы записаны
+		bool reloaded = false;			//	Выполнен daemon-reload
+		bool autostartChanged = false;	//	Изменено состояние автозапуска (enable/disable)
+		bool restarted = false;			//	Работающая служба перезапущена
+		bool started = false;			//	Бэкенд сам обеспечил запуск (runNow), отдельный start не нужен
+
+		//---Ничего не изменилось
+		bool noChange() const { return !unitWritten && !reloaded && !autostartChanged && !restarted; }
+	};
+
+	//---Итог пакетной операции (*Many) по одной службе
+	struct BatchResult final {
+		bool ok = false;
+		std::string error;			//	Причина ошибки (ok == false)
+		InstallReport report;		//	Только для installMany
+	};
+
+	//---Состояние установленной службы относительно спецификации (--reconcile)
+	enum class SpecState {
+		Missing,		//	Служба не установлена
+		Differs,		//	Установлена, но конфигурация/автозапуск отличаются (или бэкенд не умеет сравнивать)
+		UpToDate		//	Совпадает со спецификацией - делать нечего
+	};
+
+	//---Текущее состояние службы (--status)
+	struct ServiceStatus final {
+		bool installed = false;		//	Служба установлена (unit-файл / служба SCM существует)
+		bool managed = false;		//	Установлена этим установщиком
+		bool autostart = false;		//	Автозапуск включён
+		std::string activeState;	//	Состояние у менеджера служб: active, inactive, failed, ... (пусто - неизвестно)
+	};
+
 	//---Интерфейс бэкэнда установки службы
 	class IServiceBackend {
 	public:
 		virtual ~IServiceBackend() = default;
 
-		virtual bool installOrUpdate(const ServiceSpec& spec, std::string* error) = 0;
+		virtual bool installOrUpdate(const ServiceSpec& spec, std::string* error, InstallReport* report = nullptr) = 0;
 		virtual bool uninstall(const std::string& name, bool stopFirst, std::string* error) = 0;
 
 		virtual bool start(const std::string& name, std::string* error) = 0;
 		virtual bool stop(const std::string& name, std::string* error) = 0;
+
+		//---Пакетные операции: results[i] соответствует specs[i]/names[i]
+		//	По умолчанию - поэлементные вызовы. Бэкенд может переопределить их, чтобы выполнить
+		//	общие шаги один раз на весь пакет (Linux: один daemon-reload, один systemctl enable a b c ...).
+		//	installMany сам запускает службы с runNow.
+		virtual void installMany(const std::vector<ServiceSpec>& specs, std::vector<BatchResult>& results)
+		{
+			results.assign(specs.size(), {});
+			for (std::size_t i = 0; i < specs.size(); ++i)
+			{
+				BatchResult& r = results[i];
+				r.ok = installOrUpdate(specs[i], &r.error, &r.report);
+				if (r.ok && specs[i].runNow && !r.report.started)
+				{
+					r.ok = start(specs[i].name, &r.error);
+					r.report.started = r.ok;
+				}
+			}
+		}
+		virtual void uninstallMany(const std::vector<std::string>& names, bool stopFirst, std::vector<BatchResult>& results)
+		{
+			results.assign(names.size(), {});
+			for (std::size_t i = 0; i < names.size(); ++i) results[i].ok = uninstall(names[i], stopFirst, &results[i].error);
+		}
+		virtual void startMany(const std::vector<std::string>& names, std::vector<BatchResult>& results)
+		{
+			results.assign(names.size(), {});
+			for (std::size_t i = 0; i < names.size(); ++i) results[i].ok = start(names[i], &results[i].error);
+		}
+		virtual void stopMany(const std::vector<std::string>& names, std::vector<BatchResult>& results)
+		{
+			results.assign(names.size(), {});
+			for (std::size_t i = 0; i < names.size(); ++i) results[i].ok = stop(names[i], &results[i].error);
+		}
+
+		//---Сравнение установленной службы со спецификацией без изменений в системе
+		//	По умолчанию сравнивать не с чем - Differs (installOrUpdate сам пропустит лишнее)
+		virtual SpecState inspect(const ServiceSpec& spec) { (void)spec; return SpecState::Differs; }
+		//---Имена служб, установленных этим установщиком (для удаления "осиротевших" в --reconcile)
+		//	false - бэкенд не умеет отличать свои службы от чужих
+		virtual bool listManaged(std::vector<std::string>& names, std::string* error)
+		{
+			names.clear();
+			if (error) *error = "listing installer-managed services is not supported by this backend";
+			return false;
+		}
+
+		//---Состояние службы без изменений в системе; по умолчанию не поддерживается
+		virtual bool status(const std::string& name, ServiceStatus& out, std::string* error)
+		{
+			(void)name;
+			out = {};
+			if (error) *error = "status is not supported by this backend";
+			return false;
+		}
+
+		//---Службы, которые должны быть запущены раньше name (для группового start/stop)
+		//	По умолчанию зависимости неизвестны - пустой список
+		virtual bool dependencies(const std::string& name, std::vector<std::string>& out, std::string* error)
+		{
+			(void)name; (void)error;
+			out.clear();
+			return true;
+		}
+
+		//---Сбросить на диск отложенные изменения (Durability::Batch); по умолчанию нечего сбрасывать
+		virtual bool flush(std::string* error) { (void)error; return true; }
 	};
 };//---namespace svcinst
\ No newline at end of file
@@ -1,9 +1,33 @@
 #pragma once
+#include <string>
+
 #include "Cli.hpp"
+#include "IServiceBackend.hpp"
 
 namespace svcinst {
 
+//---Код выхода: служба занята другим экземпляром установщика (EX_TEMPFAIL - можно повторить позже)
+constexpr int kExitBusy = 75;
+
+//---Итог одной команды: значение вместо строк журнала (для встраивания svcinst_core)
+struct CommandResult final {
+	int code = 0;				//	Код выхода, как у InstallService: 0, 1, 2 (неверная команда), kExitBusy
+	std::string error;			//	Текст ошибки (code != 0)
+	InstallReport report;		//	--install: что фактически сделано
+	ServiceStatus status;		//	--status: состояние службы
+	std::string warning;		//	Успех с оговоркой (code == 0): каталог --delete не удалён или удаление отложено
+
+	bool ok() const { return code == 0; }
+	bool busy() const { return code == kExitBusy; }
+};
+
 //---Оркестратор: запуск установщика службы с заданными опциями
 int runInstaller(const CliOptions& options);
 
+//---Одна команда (--install/--uninstall/--start/--stop/--status, в т.ч. --group) на готовом бэкенде
+//	Без проверки прав и без вывода в stdout: бэкенд создаётся вызывающим (makeBackend) один
+//	раз на любое число команд. root, lockWaitMs и plan берутся из command; plan - тот же Plan,
+//	что в BackendOptions бэкенда (в него же попадут шаги удаления каталогов --delete).
+CommandResult execute(const CliOptions& command, IServiceBackend& backend, Plan* plan = nullptr);
+
 };//---namespace svcinst
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Cli.hpp"
+
+namespace svcinst {
+
+	namespace fs = std::filesystem;
+
+	//---Одна команда пакетного (--manifest=<file>) или потокового (--stdin) режима
+	struct ManifestEntry final {
+		std::size_t line = 0;		//	Номер строки (с 1)
+		CliOptions opt;				//	Разобранная команда
+		std::string error;			//	Ошибка разбора строки (пусто - строка корректна)
+		bool json = false;			//	Команда записана JSON-объектом (ответ - тоже JSON)
+		std::string id;				//	JSON: значение "id" как есть (JSON-текст) - для ответа
+	};
+
+	//--Разбиение строки на аргументы по правилам, близким к shell:
+	//	разделители - пробелы/табуляции, "..." и '...' группируют (кавычки снимаются),
+	//	\ экранирует только кавычку или пробел - пути Windows пишутся как есть
+	bool splitCommandLine(const std::string& line, std::vector<std::string>& out, std::string* error);
+
+	//--Разбор одной команды. Две формы:
+	//	    --install --name=a --exe=/opt/a/a --run
+	//	    {"cmd":"install","name":"a","exe":"/opt/a/a","run":true,"id":17}
+	//	JSON (NDJSON - по объекту на строку): ключи - имена опций без "--", строка → --key=value,
+	//	true → --key, false/null - опция не задана; "cmd" - сама команда; "id" не разбирается
+	//	и возвращается в ответе. Общие для запуска ключи не допускаются (см. loadManifest).
+	void parseCommand(const std::string& line, ManifestEntry& e);
+
+	//--Экранирование строки для JSON-ответа (без кавычек вокруг)
+	std::string jsonEscape(const std::string& s);
+
+	//--Чтение манифеста: одна команда установщика на строку, в синтаксисе командной строки
+	//	    --install --name=a --exe=/opt/a/a --run
+	//	    --uninstall --name=b --stop-first
+	//	Пустые строки и строки, начинающиеся с '#', пропускаются; строка может быть и JSON-объектом.
+	//	Общие для всего запуска ключи (--root, --backend, --enable-via, --durability, --lock-wait, --plan)
+	//	в строках не допускаются - они задаются в командной строке.
+	//	Ошибка отдельной строки попадает в ManifestEntry::error; false - файл не прочитан.
+	bool loadManifest(const fs::path& file, std::vector<ManifestEntry>& out, std::string* error);
+
+};//---namespace svcinst
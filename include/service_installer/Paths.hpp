@@ -15,4 +15,10 @@ namespace svcinst {
 	//	Если exeArg абсолютный путь → остаётся без изменений"
 	fs::path resolveServiceExePath(const std::string& exeArgs);
 
+	//--Определение пути к исполняемому файлу службы внутри альтернативного корня (--root):
+	//	Если root пустой → как resolveServiceExePath(exeArg)
+	//	Иначе путь считается путём внутри образа: относительный exeArg → "/" / exeArg.
+	//	Результат - путь с точки зрения образа (без префикса root)
+	fs::path resolveServiceExePath(const std::string& exeArg, const fs::path& root);
+
 };//---namespace svcinst	
\ No newline at end of file
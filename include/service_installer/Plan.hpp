@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace svcinst {
+
+	//---Шаг плана (--plan): что было бы сделано без --plan
+	struct PlanStep final {
+		std::string action;			//	"write", "remove", "link", "unlink", "systemctl", "sc", "syncfs", "remove-dir", "keep-dir"
+		std::string target;			//	Файл / unit / команда / каталог
+		std::uint64_t bytes = 0;	//	Записываемый или удаляемый объём
+		std::uint64_t files = 0;	//	Число удаляемых файлов (remove-dir)
+		std::string note;			//	Пояснение ("new", "changed", "estimate" и т.п.)
+	};
+
+	//---Накопитель шагов --plan
+	//	Бэкенд, получивший Plan в BackendOptions, ничего не меняет в системе (только читает её
+	//	состояние) и записывает сюда шаги, которые выполнил бы.
+	class Plan final {
+	public:
+		void add(PlanStep step) { steps_.push_back(std::move(step)); }
+		const std::vector<PlanStep>& steps() const { return steps_; }
+
+		//---Вывод шагов и итогов (объём записи, число вызовов, объём удаления)
+		void print(std::ostream& os) const;
+
+	private:
+		std::vector<PlanStep> steps_;
+	};
+
+};//---namespace svcinst
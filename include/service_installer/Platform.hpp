@@ -1,4 +1,5 @@
 #pragma once
+#include <filesystem>
 #include <memory>
 
 namespace svcinst {
@@ -6,10 +7,42 @@ namespace svcinst {
 	//---Интерфейс бэкэнда установки службы
 	class IServiceBackend;
 
+	//---Накопитель шагов режима --plan (Plan.hpp)
+	class Plan;
+
 	//---Запуск с правами администратора
 	bool requireAdminRoot();
 
+	//---Вид бэкенда управления службами
+	enum class BackendKind {
+		Default,		//---Платформенный по умолчанию (Linux: systemctl, Windows: SCM)
+		SystemdDbus		//---Linux: прямые вызовы systemd по D-Bus (без запуска systemctl)
+	};
+
+	//---Способ включения/отключения автозапуска (Linux/systemctl бэкенд)
+	enum class EnableMode {
+		Links,			//---Симлинки <target>.wants/ по секции [Install] напрямую (без systemctl)
+		Systemctl		//---systemctl enable/disable
+	};
+
+	//---Гарантии сохранности записанных unit-файлов/симлинков при сбое питания
+	enum class Durability {
+		File,			//---fsync каждого файла и каталога сразу после записи
+		Batch,			//---без fsync по ходу работы, один syncfs в IServiceBackend::flush()
+		None			//---без fsync (кэш страниц сбросит ядро)
+	};
+
+	//---Параметры создания бэкенда
+	struct BackendOptions {
+		BackendKind kind = BackendKind::Default;
+		EnableMode enableMode = EnableMode::Links;
+		Durability durability = Durability::File;
+		std::filesystem::path root;	//---Linux: offline-режим, unit'ы пишутся под этот корень (пусто - живая система)
+		Plan* plan = nullptr;		//-----plan: система только читается, изменения записываются шагами сюда
+	};
+
 	//---Создание бэкенда для текущей платформы
-	std::unique_ptr<IServiceBackend> makeBackend();
+	//   nullptr, если запрошенный вид бэкенда не поддерживается этой сборкой/платформой
+	std::unique_ptr<IServiceBackend> makeBackend(const BackendOptions& opt = {});
 
 };//---namespace svcinst
\ No newline at end of file
@@ -1,38 +1,264 @@
 #pragma once
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
 #include <cstdint>
+#include <exception>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace svcinst::process {
 
     namespace fs = std::filesystem;
 
+    //---Способ порождения дочернего процесса (Linux; на Windows всегда CreateProcess)
+    enum class SpawnStrategy {
+        Default,        // Из переменной окружения SVCINST_SPAWN=fork|posix_spawn|clone, иначе PosixSpawn
+        Fork,           // fork() + execv: копирование таблиц страниц родителя
+        PosixSpawn,     // posix_spawn: в glibc это clone(CLONE_VM|CLONE_VFORK) без копирования памяти
+        CloneVfork,     // clone(CLONE_VM|CLONE_VFORK|CLONE_PIDFD): pidfd сразу, без отдельного pidfd_open
+    };
+
     struct RunOptions final {
-        fs::path workingDir;          //      ()
-        std::uint32_t timeoutMs = 0;  //    , 0 - 
-        bool hideWindow = true;       //    (Windows: CREATE_NO_WINDOW, Linux: )
+        fs::path workingDir;          // Рабочий каталог для запускаемого процесса (опционально)
+        std::uint32_t timeoutMs = 0;  // Таймаут выполнения в миллисекундах, 0 - бесконечно
+        std::uint32_t killGraceMs = 3000; // Linux: пауза между SIGTERM и SIGKILL после таймаута (Windows: игнорируется)
+        bool hideWindow = true;       // Скрыть окно консоли (Windows: CREATE_NO_WINDOW, Linux: игнорируется)
+        bool captureOutput = false;   // Захватить stdout/stderr в RunResult (Linux; на Windows пока игнорируется)
+        std::size_t maxCaptureBytes = 64 * 1024; // Лимит захвата на каждый поток, остаток читается и отбрасывается
+        SpawnStrategy spawn = SpawnStrategy::Default; // Способ порождения процесса (Linux)
+    };
+
+    //---Ресурсы, потреблённые дочерним процессом
+    //   Linux: wait4()/rusage; Windows: GetProcessTimes/GetProcessMemoryInfo (без переключений контекста)
+    struct RunStats final {
+        std::uint64_t wallUs = 0;           // Время от запуска до завершения, мкс
+        std::uint64_t userCpuUs = 0;        // Процессорное время в user mode, мкс
+        std::uint64_t sysCpuUs = 0;         // Процессорное время в kernel mode, мкс
+        std::uint64_t maxRssKb = 0;         // Пиковый резидентный объём памяти, КиБ
+        std::uint64_t volCtxSwitches = 0;   // Добровольные переключения контекста (ожидание I/O, блокировки)
+        std::uint64_t involCtxSwitches = 0; // Вынужденные переключения контекста (вытеснение планировщиком)
     };
 
     struct RunResult final {
-        bool started = false;         //     (true - , false -  )
-        bool timedOut = false;        //      (true - )
-        int exitCode = 0;             //    (    )
-        std::uint32_t sysError = 0;   //    (GetLastError()  Windows  errno  Linux)
+        bool started = false;         // Успешно ли запущен процесс (true - да, false - ошибка запуска)
+        bool timedOut = false;        // Был ли превышен таймаут выполнения (true - да)
+        int exitCode = 0;             // Код завершения процесса (или синтетический код при ошибках)
+        std::uint32_t sysError = 0;   // Код системной ошибки (GetLastError() на Windows или errno на Linux)
+
+        std::string stdOut;           // Захваченный stdout (если RunOptions::captureOutput)
+        std::string stdErr;           // Захваченный stderr (если RunOptions::captureOutput)
+        bool stdOutTruncated = false; // stdout превысил maxCaptureBytes и был обрезан
+        bool stdErrTruncated = false; // stderr превысил maxCaptureBytes и был обрезан
+
+        RunStats stats;               // Учёт ресурсов потомка (заполняется, если процесс был запущен)
+
+        //---Сброс результата перед новым запуском.
+        //   Буферы stdOut/stdErr очищаются, но сохраняют ёмкость,
+        //   поэтому один RunResult можно переиспользовать между вызовами без аллокаций
+        void reset()
+        {
+            started = false;
+            timedOut = false;
+            exitCode = 0;
+            sysError = 0;
+            stdOut.clear();
+            stdErr.clear();
+            stdOutTruncated = false;
+            stdErrTruncated = false;
+            stats = {};
+        }
     };
-    //---     
+    //---Запускает внешний процесс с заданными параметрами
     // 
-    // :
-    //   exe -    
-    //   args -      
-    //   out -      (  )
-    //   opt -    (  )
-    // :
-    //   true -       (  exitCode)
-    //   false -      
-    // :
-    //     -      
+    // Параметры:
+    //   exe - путь к исполняемому файлу
+    //   args - аргументы командной строки для передачи процессу
+    //   out - структура для записи результатов выполнения (передается по ссылке)
+    //   opt - опции запуска процесса (по умолчанию пустые)
+    // Возвращает:
+    //   true - если процесс успешно запущен и завершился (независимо от exitCode)
+    //   false - если произошла ошибка при запуске процесса
+    // Примечание:
+    //   Функция блокирующая - ожидает завершения процесса или истечения таймаута.
+    //   out сбрасывается через RunResult::reset(): при пакетных запусках выгодно
+    //   передавать один и тот же RunResult, чтобы буферы захвата не перевыделялись
     bool run(const fs::path& exe, const std::vector<std::string>& args,
         RunResult& out, const RunOptions& opt = {});
 
+    //---Суммарные ресурсы всех потомков, запущенных через run()/AsyncRunner в этом процессе
+    struct RunTotals final {
+        std::uint64_t count = 0;    // Сколько процессов было запущено
+        RunStats sum;               // Сумма по всем (maxRssKb - максимум, а не сумма)
+    };
+
+    //---Снимок накопленной статистики (потокобезопасно)
+    RunTotals totals();
+
+    //---Колбэк завершения асинхронного запуска
+    using RunCallback = std::function<void(RunResult&)>;
+
+    namespace detail { class AsyncEngine; }
+
+    class RunAwaitable;
+
+    //---Асинхронный запуск множества процессов в одном потоке
+    //
+    //   Потомки работают параллельно, ожидание идёт в цикле событий
+    //   (Linux: epoll по pidfd и pipe'ам захвата). Опции те же, что у process::run,
+    //   включая таймаут и захват вывода. Колбэки и продолжения корутин выполняются
+    //   в потоке, вызвавшем run()/runOnce(). Объект не потокобезопасен.
+    //
+    //   Колбэк:   runner.spawn(exe, args, opt, [](RunResult& r) { ... }); runner.run();
+    //   Корутина: RunResult r = co_await runner.runAsync(exe, args, opt);
+    //   (args собирать заранее: GCC 12 не компилирует { "литерал", ... } внутри co_await)
+    class AsyncRunner final {
+    public:
+        AsyncRunner();
+        ~AsyncRunner();
+
+        AsyncRunner(const AsyncRunner&) = delete;
+        AsyncRunner& operator=(const AsyncRunner&) = delete;
+
+        //---Запуск процесса; cb будет вызван из run()/runOnce() по завершении.
+        //   false - процесс не запустился (cb всё равно получит результат с started == false)
+        bool spawn(const fs::path& exe, const std::vector<std::string>& args,
+            const RunOptions& opt, RunCallback cb);
+
+        //---Awaitable для co_await: запускает процесс при приостановке корутины
+        //   (перегрузка вместо аргумента по умолчанию: GCC 12 дважды разрушает
+        //   такой временный RunOptions внутри co_await)
+        RunAwaitable runAsync(fs::path exe, std::vector<std::string> args, RunOptions opt);
+        RunAwaitable runAsync(fs::path exe, std::vector<std::string> args);
+
+        //---Крутить цикл, пока все запущенные процессы не завершатся
+        void run();
+        //---Одна итерация цикла (timeoutMs: -1 - ждать событие). false - больше ждать нечего
+        bool runOnce(int timeoutMs = -1);
+        //---Сколько процессов ещё не доставлено
+        std::size_t pending() const;
+
+    private:
+        std::unique_ptr<detail::AsyncEngine> engine_;
+    };
+
+    //---Результат runAsync(): co_await возвращает RunResult
+    //
+    //   Awaitable живёт в кадре корутины. Если кадр уничтожен, пока процесс ещё идёт
+    //   (разрушена Task, ждущая в co_await), доставка отменяется: колбэк движка держит
+    //   только общее состояние и не трогает ни кадр, ни корутину. Сам потомок доживает
+    //   под управлением AsyncRunner (таймаут, при разрушении раннера - SIGKILL группе)
+    class RunAwaitable final {
+    public:
+        RunAwaitable(AsyncRunner& runner, fs::path exe, std::vector<std::string> args, RunOptions opt)
+            : runner_(&runner), exe_(std::move(exe)), args_(std::move(args)), opt_(std::move(opt)) {}
+        RunAwaitable(const RunAwaitable&) = delete;
+        RunAwaitable& operator=(const RunAwaitable&) = delete;
+        ~RunAwaitable()
+        {
+            if (state_) state_->cancelled = true;
+        }
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            state_ = std::make_shared<State>();
+            state_->h = h;
+
+            //---Ошибка запуска доставляется асинхронно, поэтому корутина приостанавливается в любом случае
+            (void)runner_->spawn(exe_, args_, opt_, [s = state_](RunResult& r) {
+                if (s->cancelled) return;
+                s->result = std::move(r);
+                s->h.resume();
+            });
+            return true;
+        }
+        RunResult await_resume() { return std::move(state_->result); }
+
+    private:
+        struct State {
+            RunResult result;
+            std::coroutine_handle<> h;
+            bool cancelled = false;     // Awaitable (и кадр корутины) уже уничтожен
+        };
+
+        AsyncRunner* runner_;
+        fs::path exe_;
+        std::vector<std::string> args_;
+        RunOptions opt_;
+        std::shared_ptr<State> state_;
+    };
+
+    //---Задача-корутина для AsyncRunner
+    //
+    //   Стартует сразу при вызове и выполняется до первого co_await.
+    //   Её можно co_await'ить из другой Task или дождаться, прокрутив
+    //   AsyncRunner::run(), и затем взять result()
+    template <class T>
+    class Task final {
+    public:
+        struct promise_type {
+            std::optional<T> value;
+            std::exception_ptr error;
+            std::coroutine_handle<> continuation;
+
+            Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+
+            //---По завершении передаём управление ожидающей корутине (если есть)
+            struct FinalAwaiter {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+                {
+                    auto c = h.promise().continuation;
+                    return c ? c : std::noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+            FinalAwaiter final_suspend() noexcept { return {}; }
+
+            template <class U>
+            void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+            void unhandled_exception() { error = std::current_exception(); }
+        };
+
+        Task(Task&& other) noexcept : h_(std::exchange(other.h_, {})) {}
+        Task& operator=(Task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (h_) h_.destroy();
+                h_ = std::exchange(other.h_, {});
+            }
+            return *this;
+        }
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+        ~Task() { if (h_) h_.destroy(); }
+
+        //---Корутина завершилась (результат или исключение готовы)
+        bool done() const noexcept { return h_ && h_.done(); }
+
+        //---Результат завершившейся задачи (исключение из корутины пробрасывается); только при done()
+        T& result()
+        {
+            assert(done() && "Task::result() before the coroutine finished");
+            if (h_.promise().error) std::rethrow_exception(h_.promise().error);
+            return *h_.promise().value;
+        }
+
+        bool await_ready() const noexcept { return done(); }
+        void await_suspend(std::coroutine_handle<> c) noexcept { h_.promise().continuation = c; }
+        T await_resume() { return std::move(result()); }
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type> h) : h_(h) {}
+        std::coroutine_handle<promise_type> h_;
+    };
+
 } // namespace svcinst::process
@@ -1,6 +1,7 @@
 #pragma once
 #include <filesystem>
 #include <string>
+#include <vector>
 
 namespace svcinst {
 	
@@ -16,6 +17,13 @@ namespace svcinst {
 		fs::path exeAbs;			//	Для установки / обновления требуется абсолютный путь
 		std::string args;			//	Аргументы командной строки для exe
 
+		//---Зависимости: службы, которые должны быть запущены раньше этой
+		std::vector<std::string> dependsOn;	//	Linux: After=/Wants=, Windows: depend=
+
+		//---Offline-режим (Linux): установка в дерево образа/chroot без живого systemd
+		fs::path root;				//	Альтернативный корень; пусто - живая система.
+									//	exeAbs задаётся как путь внутри этого корня
+
 		//---Флаги
 		bool autostart = true;		//	Включать при загрузке(включать systemd / автозапуск Windows)
 		bool runNow = false;		//	Запустить службу сразу после установки
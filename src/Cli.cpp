@@ -1,18 +1,14 @@
 #include "service_installer/Cli.hpp"
-#include "string_view"
+#include "service_installer/Manifest.hpp"
+#include "PathFilter.hpp"
+
+#include <cstdint>
+#include <fstream>
 #include <iomanip>
+#include <string_view>
+#include <vector>
 
 namespace svcinst {
-	//------------------------------------------------------------
-	//	Проверка, что строка соответствует флагу
-	//------------------------------------------------------------
-	static bool isFlag(std::string_view s, std::string_view f) { return s == f; }
-	//------------------------------------------------------------
-	//	Проверка, что строка начинается с префикса
-	//------------------------------------------------------------
-	static bool startsWith(std::string_view s, std::string_view p) {
-		return s.size() >= p.size() && s.substr(0, p.size()) == p;
-	}
 	//------------------------------------------------------------
 	//	Удаление кавычек в начале и конце строки
 	//------------------------------------------------------------
@@ -31,37 +27,6 @@ namespace svcinst {
 		return v;
 	}
 	//------------------------------------------------------------
-	//	Получение значения ключа из аргументов командной строки
-	//------------------------------------------------------------
-	static std::string getKv(int argc, char** argv, const std::string& key) {
-	
-		//---Формирование префикса ключа
-		const std::string prefix = key + "=";
-		
-		//---Поиск ключа в аргументах
-		for (size_t i = 0; i < argc; i++)
-		{
-			//---Проверка, что аргумент начинается с префикса
-			std::string_view a = argv[i];
-			if (startsWith(a,prefix))
-			{
-				//---Возврат значения без префикса и с удалёнными кавычками
-				return trimQuotes(std::string(a.substr(prefix.size())));
-			}
-		}
-		return{};
-	}
-	//------------------------------------------------------------
-	//	Проверка наличия флага в аргументах командной строки
-	//------------------------------------------------------------
-	static bool hasFlag(int argc, char** argv, std::string_view flag) {
-		for (size_t i = 0; i < argc; i++)
-		{
-			if (isFlag(argv[i], flag)) return true;
-		}
-		return false;
-	}
-	//------------------------------------------------------------
 	//	Парсинг политики удаления (--delete=none|data|install|all)
 	//------------------------------------------------------------
 	static bool parseDeletePolicy(std::string v, DeletePolicy& out)
@@ -78,79 +43,513 @@ namespace svcinst {
 		return false;
 	}
 	//------------------------------------------------------------
+	//	Парсинг бэкенда (--backend=systemctl|dbus)
+	//------------------------------------------------------------
+	static bool parseBackendKind(std::string v, BackendKind& out)
+	{
+		for (char& c : v) if (c >= 'A' && c <= 'Z') c = char(c - 'A' + 'a');
+
+		if (v.empty() || v == "default" || v == "systemctl") { out = BackendKind::Default; return true; }
+		if (v == "dbus") { out = BackendKind::SystemdDbus; return true; }
+
+		return false;
+	}
+	//------------------------------------------------------------
+	//	Парсинг способа enable/disable (--enable-via=links|systemctl)
+	//------------------------------------------------------------
+	static bool parseEnableMode(std::string v, EnableMode& out)
+	{
+		for (char& c : v) if (c >= 'A' && c <= 'Z') c = char(c - 'A' + 'a');
+
+		if (v.empty() || v == "links") { out = EnableMode::Links; return true; }
+		if (v == "systemctl") { out = EnableMode::Systemctl; return true; }
+
+		return false;
+	}
+	//------------------------------------------------------------
+	//	Парсинг гарантий записи (--durability=file|batch|none)
+	//------------------------------------------------------------
+	static bool parseDurability(std::string v, Durability& out)
+	{
+		for (char& c : v) if (c >= 'A' && c <= 'Z') c = char(c - 'A' + 'a');
+
+		if (v.empty() || v == "file") { out = Durability::File; return true; }
+		if (v == "batch") { out = Durability::Batch; return true; }
+		if (v == "none") { out = Durability::None; return true; }
+
+		return false;
+	}
+	//------------------------------------------------------------
+	//	Парсинг объёма с необязательным суффиксом K|M|G (--max-delete-bytes=)
+	//------------------------------------------------------------
+	static bool parseSize(std::string v, std::uint64_t& out)
+	{
+		std::uint64_t mul = 1;
+		if (!v.empty())
+		{
+			switch (v.back())
+			{
+			case 'k': case 'K': mul = 1ull << 10; break;
+			case 'm': case 'M': mul = 1ull << 20; break;
+			case 'g': case 'G': mul = 1ull << 30; break;
+			default: break;
+			}
+			if (mul != 1) v.pop_back();
+		}
+		if (v.empty() || v.size() > 12) return false;
+		std::uint64_t n = 0;
+		for (char c : v)
+		{
+			if (c < '0' || c > '9') return false;
+			n = n * 10 + std::uint64_t(c - '0');
+		}
+		if (n > UINT64_MAX / mul) return false;		//	С суффиксом 12 цифр уже не помещаются в uint64_t
+		out = n * mul;
+		return true;
+	}
+	//------------------------------------------------------------
+	//	Парсинг неотрицательного числа (--lock-wait=<ms>)
+	//------------------------------------------------------------
+	static bool parseUInt(const std::string& v, std::uint32_t& out)
+	{
+		if (v.empty() || v.size() > 9) return false;
+		std::uint32_t n = 0;
+		for (char c : v)
+		{
+			if (c < '0' || c > '9') return false;
+			n = n * 10 + std::uint32_t(c - '0');
+		}
+		out = n;
+		return true;
+	}
+	namespace {
+		//---Опции командной строки
+		enum class Opt : std::uint8_t {
+			Install, Uninstall, Start, Stop, Status, Help, StopFirst, Run, FromInno, Stdin, Plan, Trash, Throttle,
+			Name, Exe, Args, Desc, DependsOn, Group, Delete, DataRoot, Root, Backend, EnableVia,
+			Durability, LockWait, Manifest, Reconcile, Serve, Workers, Reclaim, ReclaimDir, WaitFor, MaxUnlinks, MaxDeleteBytes,
+			DataInclude, DataExclude,
+			Count
+		};
+
+		//---Повтор опции: Same - только с тем же значением; Join - фрагменты через пробел (--args);
+		//   List - элементы через запятую (--depends-on, --group); Many - несколько значений
+		//   (--name, --data-include, --data-exclude)
+		enum class Repeat : std::uint8_t { Same, Join, List, Many };
+
+		struct OptionDef {
+			std::string_view key;
+			Opt id;
+			bool hasValue;		//	--key=<значение> или флаг без значения
+			Repeat repeat;
+		};
+
+		constexpr OptionDef kOptions[] = {
+			{ "--install",    Opt::Install,    false, Repeat::Same },
+			{ "--uninstall",  Opt::Uninstall,  false, Repeat::Same },
+			{ "--start",      Opt::Start,      false, Repeat::Same },
+			{ "--stop",       Opt::Stop,       false, Repeat::Same },
+			{ "--status",     Opt::Status,     false, Repeat::Same },
+			{ "--help",       Opt::Help,       false, Repeat::Same },
+			{ "--stop-first", Opt::StopFirst,  false, Repeat::Same },
+			{ "--run",        Opt::Run,        false, Repeat::Same },
+			{ "--from-inno",  Opt::FromInno,   false, Repeat::Same },
+			{ "--stdin",      Opt::Stdin,      false, Repeat::Same },
+			{ "--plan",       Opt::Plan,       false, Repeat::Same },
+			{ "--trash",      Opt::Trash,      false, Repeat::Same },
+			{ "--throttle",   Opt::Throttle,   false, Repeat::Same },
+			{ "--name",       Opt::Name,       true,  Repeat::Many },
+			{ "--exe",        Opt::Exe,        true,  Repeat::Same },
+			{ "--args",       Opt::Args,       true,  Repeat::Join },
+			{ "--desc",       Opt::Desc,       true,  Repeat::Same },
+			{ "--depends-on", Opt::DependsOn,  true,  Repeat::List },
+			{ "--group",      Opt::Group,      true,  Repeat::List },
+			{ "--delete",     Opt::Delete,     true,  Repeat::Same },
+			{ "--data-root",  Opt::DataRoot,   true,  Repeat::Same },
+			{ "--root",       Opt::Root,       true,  Repeat::Same },
+			{ "--backend",    Opt::Backend,    true,  Repeat::Same },
+			{ "--enable-via", Opt::EnableVia,  true,  Repeat::Same },
+			{ "--durability", Opt::Durability, true,  Repeat::Same },
+			{ "--lock-wait",  Opt::LockWait,   true,  Repeat::Same },
+			{ "--manifest",   Opt::Manifest,   true,  Repeat::Same },
+			{ "--reconcile",  Opt::Reconcile,  true,  Repeat::Same },
+			{ "--serve",      Opt::Serve,      true,  Repeat::Same },
+			{ "--workers",    Opt::Workers,    true,  Repeat::Same },
+			{ "--reclaim",    Opt::Reclaim,    true,  Repeat::Same },
+			{ "--reclaim-dir", Opt::ReclaimDir, true, Repeat::Same },
+			{ "--wait-for",   Opt::WaitFor,    true,  Repeat::Same },
+			{ "--max-unlinks", Opt::MaxUnlinks, true, Repeat::Same },
+			{ "--max-delete-bytes", Opt::MaxDeleteBytes, true, Repeat::Same },
+			{ "--data-include", Opt::DataInclude, true, Repeat::Many },
+			{ "--data-exclude", Opt::DataExclude, true, Repeat::Many },
+		};
+		constexpr std::size_t kOptionCount = sizeof(kOptions) / sizeof(kOptions[0]);
+		static_assert(kOptionCount == std::size_t(Opt::Count), "kOptions must list every Opt");
+
+		//------------------------------------------------------------
+		//	Совершенный хеш ключей: FNV-1a с подбираемым на этапе
+		//	компиляции seed'ом, без коллизий в таблице из kSlots ячеек
+		//------------------------------------------------------------
+		constexpr std::size_t kSlots = 128;
+
+		constexpr std::uint32_t hashKey(std::string_view s, std::uint32_t seed)
+		{
+			std::uint32_t h = 2166136261u ^ seed;
+			for (char c : s) h = (h ^ std::uint8_t(c)) * 16777619u;
+			return h ^ (h >> 15);
+		}
+
+		struct PerfectHash {
+			std::uint32_t seed = 0;			//	0 - seed не найден
+			std::int8_t slot[kSlots] = {};	//	Индекс в kOptions или -1
+		};
+
+		constexpr PerfectHash buildPerfectHash()
+		{
+			for (std::uint32_t seed = 1; seed < 10000; ++seed)
+			{
+				PerfectHash h;
+				h.seed = seed;
+				for (std::int8_t& s : h.slot) s = -1;
+
+				bool ok = true;
+				for (std::size_t i = 0; i < kOptionCount && ok; ++i)
+				{
+					std::int8_t& s = h.slot[hashKey(kOptions[i].key, seed) % kSlots];
+					if (s >= 0) ok = false;
+					else s = std::int8_t(i);
+				}
+				if (ok) return h;
+			}
+			return {};
+		}
+
+		constexpr PerfectHash kOptionHash = buildPerfectHash();
+		static_assert(kOptionHash.seed != 0, "no collision-free seed for the option table; enlarge kSlots");
+
+		//---Поиск опции по ключу (до '='): одно хеширование и одно сравнение
+		constexpr const OptionDef* findOption(std::string_view key)
+		{
+			const int i = kOptionHash.slot[hashKey(key, kOptionHash.seed) % kSlots];
+			return (i >= 0 && kOptions[i].key == key) ? &kOptions[i] : nullptr;
+		}
+		static_assert(findOption("--install") && findOption("--install")->id == Opt::Install, "option lookup");
+		static_assert(findOption("--workers") && findOption("--workers")->id == Opt::Workers, "option lookup");
+		static_assert(findOption("--bogus") == nullptr && findOption("--name=x") == nullptr, "option lookup");
+
+		constexpr int kMaxResponseDepth = 8;	//	Вложенность @файлов
+
+		//------------------------------------------------------------
+		//	Один проход по аргументам: каждый разбирается один раз,
+		//	значения складываются по слотам Opt
+		//------------------------------------------------------------
+		class ArgParser final {
+		public:
+			bool feed(std::string_view a, int depth = 0)
+			{
+				//---@файл: аргументы из файла на месте этого аргумента
+				if (!a.empty() && a.front() == '@') return feedFile(std::string(a.substr(1)), depth);
+
+				const std::size_t eq = a.find('=');
+				const std::string_view key = (eq == std::string_view::npos) ? a : a.substr(0, eq);
+				const OptionDef* def = findOption(key);
+				if (!def)
+				{
+					if (a.size() < 2 || a.compare(0, 2, "--") != 0) return fail("unexpected argument: " + std::string(a));
+					return fail("unknown option: " + std::string(key));
+				}
+				if (!def->hasValue)
+				{
+					if (eq != std::string_view::npos) return fail(std::string(key) + " does not take a value");
+					seen[std::size_t(def->id)] = true;
+					return true;
+				}
+				if (eq == std::string_view::npos) return fail(std::string(key) + " requires a value: " + std::string(key) + "=<...>");
+
+				return store(*def, trimQuotes(std::string(a.substr(eq + 1))));
+			}
+
+			bool has(Opt id) const { return seen[std::size_t(id)]; }
+			const std::string& value(Opt id) const { return values[std::size_t(id)]; }
+			//---Все значения Repeat::Many по порядку
+			const std::vector<std::string>& all(Opt id) const { return lists[std::size_t(id)]; }
+
+			std::string error;
+
+		private:
+			bool fail(std::string what)
+			{
+				if (error.empty()) error = std::move(what);
+				return false;
+			}
+
+			bool store(const OptionDef& def, std::string v)
+			{
+				const std::size_t i = std::size_t(def.id);
+				if (def.repeat == Repeat::Many) lists[i].push_back(v);
+
+				std::string& cur = values[i];
+				if (!seen[i])
+				{
+					seen[i] = true;
+					cur = std::move(v);
+					return true;
+				}
+				switch (def.repeat)
+				{
+				case Repeat::Join:
+					if (!v.empty()) cur += cur.empty() ? v : " " + v;
+					return true;
+				case Repeat::List:
+					if (!v.empty()) cur += cur.empty() ? v : "," + v;
+					return true;
+				case Repeat::Many:
+					return true;
+				case Repeat::Same:
+					break;
+				}
+				if (cur == v) return true;
+				return fail("conflicting values for " + std::string(def.key) + ": '" + cur + "' and '" + v + "'");
+			}
+
+			bool feedFile(const std::string& file, int depth)
+			{
+				if (file.empty()) return fail("empty response file name after '@'");
+				if (depth >= kMaxResponseDepth) return fail("response files nested too deeply: @" + file);
+
+				std::ifstream in(fs::u8path(file), std::ios::binary);
+				if (!in) return fail("cannot open response file: " + file);
+
+				//---Синтаксис строк - как в манифесте: кавычки, '#' комментарии, пустые строки
+				std::string line;
+				std::vector<std::string> args;
+				std::size_t lineNo = 0;
+				while (std::getline(in, line))
+				{
+					++lineNo;
+					if (lineNo == 1 && line.compare(0, 3, "\xEF\xBB\xBF") == 0) line.erase(0, 3);
+					const std::size_t first = line.find_first_not_of(" \t\r");
+					if (first == std::string::npos || line[first] == '#') continue;
+
+					std::string lineError;
+					if (!splitCommandLine(line, args, &lineError)) return fail(file + ":" + std::to_string(lineNo) + ": " + lineError);
+					for (const std::string& a : args)
+					{
+						if (!feed(a, depth + 1)) return false;
+					}
+				}
+				return true;
+			}
+
+			bool seen[std::size_t(Opt::Count)] = {};
+			std::string values[std::size_t(Opt::Count)];
+			std::vector<std::string> lists[std::size_t(Opt::Count)];
+		};
+	} // namespace
+	//------------------------------------------------------------
 	//---Парсинг опций командной строки
 	//------------------------------------------------------------
 	CliOptions parceCli(int argc, char** argv) {
-	
+
+		//---argv[0] - имя программы
+		std::vector<std::string> args;
+		args.reserve(argc > 1 ? std::size_t(argc - 1) : 0);
+		for (int i = 1; i < argc; ++i) args.emplace_back(argv[i]);
+		return parceCli(args);
+	}
+	//------------------------------------------------------------
+	//---Парсинг опций: аргументы без имени программы
+	//------------------------------------------------------------
+	CliOptions parceCli(const std::vector<std::string>& args) {
+
 		//---Результирующие опции
 		CliOptions o;
+		const auto invalid = [&o](std::string why) {
+			o.cmd = Command::Invalid;
+			o.error = std::move(why);
+			return o;
+		};
 
-		//---Определение команды
-		const bool install = hasFlag(argc, argv, "--install");
-		const bool uninstall = hasFlag(argc, argv, "--uninstall");
-		const bool start = hasFlag(argc, argv, "--start");	
-		const bool stop = hasFlag(argc, argv, "--stop");
-		const bool stopFirst = hasFlag(argc, argv, "--stop-first");
+		//---Один проход по аргументам
+		ArgParser p;
+		for (const std::string& a : args)
+		{
+			if (!p.feed(a)) return invalid(p.error);
+		}
+		if (p.has(Opt::Help)) return o;
 
 		//---Запустить службу?
-		o.runNow = hasFlag(argc, argv, "--run");
+		o.runNow = p.has(Opt::Run);
 
 		//---Параметры службы
-		o.name = getKv(argc, argv, "--name");
-		o.exe = getKv(argc, argv, "--exe");
-		o.args = getKv(argc, argv, "--args");	
+		o.exe = p.value(Opt::Exe);
+		o.args = p.value(Opt::Args);
 
-		const std::string desc = getKv(argc, argv, "--desc");
+		const std::string& desc = p.value(Opt::Desc);
 		if (!desc.empty()) o.description = desc;
 
+		//---Зависимости и группа служб (списки через запятую)
+		o.dependsOn = p.value(Opt::DependsOn);
+		o.group = p.value(Opt::Group);
+
 		//---InstallService  запущен Inno Setup'ом?
-		o.fromInno = hasFlag(argc, argv, "--from-inno");
-		
-		//---Политика удаления
+		o.fromInno = p.has(Opt::FromInno);
+
+		//---Удаление через корзину: каталог уносится rename'ом, содержимое чистит фоновый процесс
+		o.trash = p.has(Opt::Trash);
+
+		//---Щадящее удаление; лимиты скорости его включают
 		{
-			const std::string delStr = getKv(argc, argv, "--delete");
-			if (!delStr.empty())
-			{
-				DeletePolicy dp{};
-				if (!parseDeletePolicy(delStr, dp))
-				{
-					o.cmd = Command::Invalid; //	неверное значение --delete
-					return o;
-				}
-				o.del = dp;
-			}
+			const std::string& unlinksStr = p.value(Opt::MaxUnlinks);
+			if (!unlinksStr.empty() && !parseUInt(unlinksStr, o.maxUnlinks))
+				return invalid("invalid --max-unlinks value '" + unlinksStr + "' (deletions per second)");
+			const std::string& bytesStr = p.value(Opt::MaxDeleteBytes);
+			if (!bytesStr.empty() && !parseSize(bytesStr, o.maxDeleteBytes))
+				return invalid("invalid --max-delete-bytes value '" + bytesStr + "' (bytes per second, K|M|G suffix)");
+			o.throttle = p.has(Opt::Throttle) || o.maxUnlinks > 0 || o.maxDeleteBytes > 0;
 		}
 
+		//---Политика удаления
+		if (!parseDeletePolicy(p.value(Opt::Delete), o.del))
+			return invalid("invalid --delete value '" + p.value(Opt::Delete) + "' (none|data|install|all)");
+
 		//---Путь к папке с данными
-		o.dataRoot = getKv(argc, argv, "--data-root");
+		o.dataRoot = p.value(Opt::DataRoot);
+
+		//---Offline-режим: корень образа/chroot
+		o.root = p.value(Opt::Root);
+
+		//---Бэкенд управления службами
+		if (!parseBackendKind(p.value(Opt::Backend), o.backend))
+			return invalid("invalid --backend value '" + p.value(Opt::Backend) + "' (systemctl|dbus)");
+		if (!parseEnableMode(p.value(Opt::EnableVia), o.enableMode))
+			return invalid("invalid --enable-via value '" + p.value(Opt::EnableVia) + "' (links|systemctl)");
+		if (!parseDurability(p.value(Opt::Durability), o.durability))
+			return invalid("invalid --durability value '" + p.value(Opt::Durability) + "' (file|batch|none)");
+		{
+			const std::string& waitStr = p.value(Opt::LockWait);
+			if (!waitStr.empty() && !parseUInt(waitStr, o.lockWaitMs))
+				return invalid("invalid --lock-wait value '" + waitStr + "' (milliseconds)");
+		}
+
+		//---Пакетный режим: файл со списком команд; потоковый - команды из stdin;
+		//   reconcile - файл желаемого состояния
+		o.manifest = p.value(Opt::Manifest);
+		const bool stream = p.has(Opt::Stdin);
+		o.reconcile = p.value(Opt::Reconcile);
+
+		//---Сухой прогон: шаги печатаются, система не меняется
+		o.plan = p.has(Opt::Plan);
+		if (o.plan && o.backend == BackendKind::SystemdDbus)
+			return invalid("--plan cannot be combined with --backend=dbus (steps are recorded as systemctl calls)");
+
+		//---Агент на Unix-сокете и размер его пула потоков
+		o.serve = p.value(Opt::Serve);
+		{
+			const std::string& workersStr = p.value(Opt::Workers);
+			if (!workersStr.empty() && (!parseUInt(workersStr, o.workers) || o.workers == 0 || o.workers > 256))
+				return invalid("invalid --workers value '" + workersStr + "' (1..256)");
+		}
+
+		//---Фоновый уборщик: корзина или недоудалённый каталог (его запускает сам установщик)
+		o.reclaim = p.value(Opt::Reclaim);
+		if (!p.value(Opt::ReclaimDir).empty())
+		{
+			if (!o.reclaim.empty()) return invalid("conflicting options: --reclaim and --reclaim-dir");
+			o.reclaim = p.value(Opt::ReclaimDir);
+			o.reclaimDir = true;
+		}
+		o.reclaimWait = p.value(Opt::WaitFor);
+		if (!o.reclaimWait.empty() && o.reclaim.empty()) return invalid("--wait-for is only valid with --reclaim/--reclaim-dir");
+		if (!o.reclaim.empty() && o.reclaimWait.empty()) return invalid("--reclaim/--reclaim-dir are internal: started by the installer itself with --wait-for");
 
-		//---Определение команды
-		const int cmdCount =
-			(install ? 1 : 0) +
-			(uninstall ? 1 : 0) +
-			(start ? 1 : 0) +
-			(stop ? 1 : 0);
+		//---Выборочная очистка DataRoot: шаблоны проверяются компиляцией сразу
+		o.dataInclude = p.all(Opt::DataInclude);
+		o.dataExclude = p.all(Opt::DataExclude);
+		const bool dataFilter = !o.dataInclude.empty() || !o.dataExclude.empty();
+		{
+			PathFilter filter;
+			std::string why;
+			if (!filter.compile(o.dataInclude, o.dataExclude, &why)) return invalid("invalid --data-include/--data-exclude " + why);
+		}
+		const char* const dataFilterUse = "--data-include/--data-exclude are only valid with --uninstall --delete=data|all";
+
+		//---Команды и режимы, заданные в аргументах
+		std::vector<std::string_view> cmds, modes;
+		for (Opt id : { Opt::Install, Opt::Uninstall, Opt::Start, Opt::Stop, Opt::Status })
+		{
+			if (p.has(id)) cmds.push_back(kOptions[std::size_t(id)].key);
+		}
+		if (!o.manifest.empty()) modes.push_back("--manifest");
+		if (stream) modes.push_back("--stdin");
+		if (!o.reconcile.empty()) modes.push_back("--reconcile");
+		if (!o.serve.empty()) modes.push_back("--serve");
+		if (!o.reclaim.empty()) modes.push_back(o.reclaimDir ? "--reclaim-dir" : "--reclaim");
+
+		//---Манифест, поток, reconcile и агент заменяют команду: вместе с ней (и друг с другом) не допускаются
+		if (!modes.empty())
+		{
+			if (!cmds.empty()) return invalid("conflicting options: " + std::string(modes[0]) + " and " + std::string(cmds[0]));
+			if (modes.size() > 1) return invalid("conflicting options: " + std::string(modes[0]) + " and " + std::string(modes[1]));
+			if (o.plan && (stream || !o.serve.empty() || !o.reclaim.empty())) return invalid("--plan cannot be combined with " + std::string(modes[0]));
+			if (dataFilter && !o.reclaimDir) return invalid(dataFilterUse);
 
+			if (stream) o.cmd = Command::Stream;
+			else if (!o.reclaim.empty()) o.cmd = Command::Reclaim;
+			else if (!o.serve.empty()) o.cmd = Command::Serve;
+			else if (!o.reconcile.empty()) o.cmd = Command::Reconcile;
+			else o.cmd = Command::Manifest;
+			return o;
+		}
 		//---Если не указана ни одна команда → Help
-		if (cmdCount == 0) 
+		if (cmds.empty())
 		{
 			o.cmd = Command::Help;
 			return o;
 		}
 		//---Если некорректно указана команда → Invalid
-		if (cmdCount > 1)
+		if (cmds.size() > 1) return invalid("conflicting commands: " + std::string(cmds[0]) + " and " + std::string(cmds[1]));
+
+		if (p.has(Opt::Install)) o.cmd = Command::Install;
+		if (p.has(Opt::Uninstall)) o.cmd = Command::Uninstall;
+		if (p.has(Opt::Start)) o.cmd = Command::Start;
+		if (p.has(Opt::Stop)) o.cmd = Command::Stop;
+		if (p.has(Opt::Status)) o.cmd = Command::Status;
+
+		//---Несколько --name - группа для --start/--stop, для остальных команд - конфликт
+		const bool groupCmd = (o.cmd == Command::Start || o.cmd == Command::Stop);
+		const std::vector<std::string>& names = p.all(Opt::Name);
+		if (names.size() > 1 && groupCmd)
 		{
-			o.cmd = Command::Invalid;
-			return o;
+			if (!o.group.empty()) return invalid("--group cannot be combined with --name");
+			for (const std::string& n : names)
+			{
+				if (n.empty()) continue;
+				if (!o.group.empty()) o.group += ",";
+				o.group += n;
+			}
 		}
-		if(install) o.cmd = Command::Install;
-		if(uninstall) o.cmd = Command::Uninstall;
-		if(start) o.cmd = Command::Start;
-		if(stop) o.cmd = Command::Stop;
-	
+		else
+		{
+			for (const std::string& n : names)
+			{
+				if (n != names.front())
+					return invalid("conflicting values for --name: '" + names.front() + "' and '" + n + "' (several names only with --start/--stop)");
+			}
+			o.name = p.value(Opt::Name);
+		}
+
+		//---Группа - только для --start/--stop и вместо --name
+		if (!o.group.empty() && !groupCmd) return invalid("--group is only valid with --start/--stop");
+		if (!o.group.empty() && !o.name.empty()) return invalid("--group cannot be combined with --name");
+
 		//---Флаг остановки службы перед удалением
-		o.stopFirst = (o.cmd == Command::Uninstall) && stopFirst;
-		
+		o.stopFirst = (o.cmd == Command::Uninstall) && p.has(Opt::StopFirst);
+
+		//---Шаблоны DataRoot - только при его удалении
+		const bool deletesData = (o.del == DeletePolicy::DataRoot || o.del == DeletePolicy::All);
+		if (dataFilter && (o.cmd != Command::Uninstall || !deletesData)) return invalid(dataFilterUse);
+
 		//---Возврат опций
 		return o;
 	}
@@ -174,16 +573,40 @@ namespace svcinst {
 			"  --install        Install or update service\n"
 			"  --uninstall      Uninstall service\n"
 			"  --start          Start service\n"
-			"  --stop           Stop service\n\n"
+			"  --stop           Stop service\n"
+			"  --status         Print service state: installed, managed, autostart, active state\n"
+			"  --manifest=<f>   Run many commands from file <f> in one process (see Manifest below)\n"
+			"  --stdin          Read commands from stdin, one per line, until EOF (see Stream below)\n"
+			"  --reconcile=<f>  Converge installed services to the desired state in <f> (see Reconcile below)\n"
+			"  --serve=<sock>   Linux: agent serving commands from local clients on a Unix socket (see Serve below)\n"
+			"  --help           Print this help\n\n"
+			"Unknown options, conflicting commands or repeated options with different values are errors (exit 2).\n"
+			"@<file> inserts arguments from <file> (manifest line syntax, '#' comments). --args may be repeated\n"
+			"(fragments joined with spaces), --depends-on/--group append; several --name for --start/--stop form a group.\n\n"
 			"Common options:\n";
 
 		printOpt(os, "--name=<name>", "Service name (required for any command except implicit help)");
+		printOpt(os, "--group=<a,b,...>", "For --start/--stop instead of --name: start in dependency order (independent");
+		printOpt(os, "", "services of a wave in parallel); --stop goes in reverse order");
+		printOpt(os, "--backend=systemctl|dbus", "Linux: manage units via /bin/systemctl (default) or directly over D-Bus");
+		printOpt(os, "--enable-via=links|systemctl", "Linux/systemctl: enable via [Install] symlinks (default) or systemctl enable");
+		printOpt(os, "--durability=file|batch|none", "Linux: fsync each unit file (default), one syncfs per run, or no fsync");
+		printOpt(os, "--lock-wait=<ms>", "Wait for another installer working on the same service (default 30000);");
+		printOpt(os, "", "on timeout exit with code 75 (busy)");
+		printOpt(os, "--plan", "Dry run: print the steps the command would perform (files written with sizes,");
+		printOpt(os, "", "systemctl/sc calls, directories removed with file counts and bytes) and change");
+		printOpt(os, "", "nothing. Works with every command, --manifest and --reconcile (not --stdin);");
+		printOpt(os, "", "not with --backend=dbus: steps are recorded as systemctl calls.");
+		printOpt(os, "--root=<dir>", "Linux: offline mode for image/chroot trees: write units and wants-links under <dir>,");
+		printOpt(os, "", "no daemon-reload/start; --exe is a path inside <dir>. Only --install/--uninstall.");
 
 		os << "\nInstall/update options:\n";
 		printOpt(os, "--exe=<path>", "Service executable (required for --install)");
 		printOpt(os, "", "If relative: resolved relative to service-installer location (selfDir).");
 		printOpt(os, "--args=\"...\"", "Optional args passed to the service (appended to binPath on Windows)");
 		printOpt(os, "--desc=\"...\"", "Optional description (defaults to service name if empty/whitespace)");
+		printOpt(os, "--depends-on=<a,b,...>", "Services that must be started before this one (Linux: After=/Wants=,");
+		printOpt(os, "", "Windows: depend=)");
 		printOpt(os, "--run", "For --install: start right after install");
 
 		os << "\nUninstall options:\n";
@@ -191,6 +614,46 @@ namespace svcinst {
 		printOpt(os, "--delete=none|data|install|all", "Cleanup policy after uninstall (default: none)");
 		printOpt(os, "--data-root=<path>", "Required for --delete=data|all (path to DataRoot)");
 		printOpt(os, "--from-inno", "Windows: called from Inno Setup (do not delete install dir here)");
+		printOpt(os, "--trash", "Linux: with --delete, rename the directories into <fs root>/.svcinst-trash");
+		printOpt(os, "", "(instant) and delete them in a background reclaimer process");
+		printOpt(os, "--throttle", "Linux: gentle --delete: idle I/O class, nice 19, pause while the disk is under");
+		printOpt(os, "", "pressure (PSI io some avg10 >= 10%); also applies to the --trash reclaimer");
+		printOpt(os, "--max-unlinks=<n>", "With --throttle (implies it): at most <n> deletions per second");
+		printOpt(os, "--max-delete-bytes=<n>", "With --throttle (implies it): at most <n>[K|M|G] bytes of files deleted per second");
+		printOpt(os, "--data-include=<glob>", "With --delete=data|all: delete only matching DataRoot entries (repeatable)");
+		printOpt(os, "--data-exclude=<glob>", "With --delete=data|all: keep matching entries and everything under them (repeatable)");
+		printOpt(os, "", "Globs are relative to DataRoot: * ? [a-z] within a name, ** any levels; without '/'");
+		printOpt(os, "", "a glob matches a name at any depth, a trailing '/' matches directories only. DataRoot");
+		printOpt(os, "", "itself stays unless it is selected and emptied; kept directories are not read.");
+
+		os << "\nManifest (--manifest=<file>):\n";
+		printOpt(os, "", "One command per line in command-line syntax, e.g. --install --name=a --exe=/opt/a/a --run");
+		printOpt(os, "", "('#' comments and blank lines are skipped). Units are written first, then one");
+		printOpt(os, "", "daemon-reload, one enable and one start for all of them. Order: stop, uninstall,");
+		printOpt(os, "", "install, start. --root/--backend/--enable-via/--durability/--lock-wait are given");
+		printOpt(os, "", "on the command line only. Prints one result line per entry; exit 1 if any failed.");
+
+		os << "\nStream (--stdin):\n";
+		printOpt(os, "", "Each stdin line is one command: command-line syntax as in a manifest, or a JSON object");
+		printOpt(os, "", "{\"cmd\":\"install\",\"name\":\"a\",\"exe\":\"/opt/a/a\",\"run\":true,\"id\":1}. The backend and");
+		printOpt(os, "", "root check are set up once. One result line per command on stdout:");
+		printOpt(os, "", "\"<line> <code> ok|<error>\", or {\"id\":..,\"ok\":..,\"code\":..,\"error\":..} for JSON input.");
+		printOpt(os, "", "--delete=install|all is refused in a line (the installer runs from the install dir).");
+		printOpt(os, "", "At EOF: exit 1 if any command failed (75 if all failures were busy services).");
+
+		os << "\nReconcile (--reconcile=<file>):\n";
+		printOpt(os, "", "<file> lists the desired services as --install lines (manifest syntax). Each is compared");
+		printOpt(os, "", "with what is installed: create, update or unchanged (untouched). Services installed by");
+		printOpt(os, "", "service-installer but absent from <file> are stopped and removed. Any invalid line aborts");
+		printOpt(os, "", "the run before changes. Prints one line per service; exit 1 if anything failed.");
+
+		os << "\nServe (--serve=<socket>):\n";
+		printOpt(os, "", "One long-running process with backends set up once. Clients connect to <socket> (mode 0600)");
+		printOpt(os, "", "and send request lines in --stdin syntax (install/uninstall/start/stop/status); each gets");
+		printOpt(os, "", "a reply line in the same format. Clients must run as root or as the agent's own user");
+		printOpt(os, "", "(SO_PEERCRED). Operations on one service are serialized, on different ones run in parallel.");
+		printOpt(os, "--workers=<n>", "Worker threads, each with its own backend (default 4)");
+		printOpt(os, "", "SIGINT/SIGTERM: stop accepting, finish running requests, remove the socket.");
 
 		os <<
 			"\nExamples:\n"
@@ -200,7 +663,15 @@ namespace svcinst {
 			"  service-installer --uninstall --name=Valenta --stop-first\n"
 			"  service-installer --uninstall --name=Valenta --stop-first --delete=data --data-root=\"C:\\\\ProgramData\\\\Valenta\"\n"
 			"  service-installer --uninstall --name=Valenta --stop-first --delete=all --data-root=\"C:\\\\ProgramData\\\\Valenta\" --from-inno\n"
+			"  service-installer --uninstall --name=valenta --delete=data --data-root=/var/lib/valenta --data-exclude=config/ --data-exclude=*.lic\n"
 			"  service-installer --start --name=Valenta\n"
-			"  service-installer --stop  --name=Valenta\n";
+			"  service-installer --stop  --name=Valenta\n"
+			"  service-installer --start --group=dbproxy,cache,api,worker\n"
+			"  service-installer --manifest=fleet.txt --enable-via=systemctl\n"
+			"  service-installer --reconcile=desired.txt\n"
+			"  service-installer --reconcile=desired.txt --plan\n"
+			"  service-installer --status --name=Valenta\n"
+			"  service-installer --serve=/run/svcinst/agent.sock --workers=8\n"
+			"  service-installer --install @common.args --name=api\n";
 	}
 };//---namespace svcinst
@@ -1,13 +1,25 @@
 #include "service_installer/Installer.hpp"
+#include "service_installer/Manifest.hpp"
 #include "service_installer/Platform.hpp"
 #include "service_installer/Paths.hpp"
+#include "service_installer/Plan.hpp"
 #include "service_installer/ServiceSpec.hpp"
 #include "service_installer/IServiceBackend.hpp"
+#include "service_installer/Process.hpp"
 #include "platform/PlatformImpl.hpp" 
+#include "Log.hpp"
+#include "Text.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
 #include <iostream>
 #include <filesystem>
-#include <glog/logging.h>
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace svcinst {
 
@@ -27,21 +39,111 @@ namespace svcinst {
 			return p == svcinst::DeletePolicy::DataRoot || p == svcinst::DeletePolicy::All;
 		}
 		//------------------------------------------------------------
+		//	--plan: удаление каталога - только оценка (файлы, байты)
+		//------------------------------------------------------------
+		static void planRemoveDir(svcinst::Plan& plan, const svcinst::fs::path& dir, std::string note, const svcinst::PathFilter* filter = nullptr)
+		{
+			svcinst::PlanStep step{ "remove-dir", dir.string(), 0, 0, {} };
+			std::string why;
+			if (!svcinst::platform::estimateRemoveDir(dir, step.files, step.bytes, &why, filter))
+			{
+				step.action = "keep-dir";	//	Удаление было бы отклонено
+				note = why;
+			}
+			step.note = std::move(note);
+			plan.add(std::move(step));
+		}
+		//------------------------------------------------------------
+		//	Щадящее удаление из опций (--throttle, --max-unlinks, --max-delete-bytes)
+		//------------------------------------------------------------
+		static svcinst::platform::DeleteThrottle deleteThrottle(const svcinst::CliOptions& opt)
+		{
+			svcinst::platform::DeleteThrottle t;
+			t.enabled = opt.throttle;
+			t.unlinksPerSec = opt.maxUnlinks;
+			t.bytesPerSec = opt.maxDeleteBytes;
+			return t;
+		}
+		//------------------------------------------------------------
+		//	--trash: каталог уносится в корзину своей ФС, уборщик стартует сразу
+		//	(false - перенос не удался, удаляем на месте)
+		//------------------------------------------------------------
+		static bool trashDir(const svcinst::fs::path& dir, const svcinst::platform::DeleteThrottle& throttle)
+		{
+			svcinst::fs::path trash;
+			std::string why;
+			if (!svcinst::platform::moveToTrash(dir, trash, &why))
+			{
+				LOG(WARNING) << why << "; removing in place";
+				return false;
+			}
+			svcinst::platform::ReclaimJob job;
+			job.target = trash;
+			job.throttle = throttle;
+			if (!trash.empty() && !svcinst::platform::startReclaimer(job, nullptr, &why))
+			{
+				LOG(WARNING) << why << " (" << trash.string() << " is emptied by the next reclaimer)";
+			}
+			return true;
+		}
+		//------------------------------------------------------------
+		//	Предупреждение для ответа: каталог не удалён или удаление отложено
+		//------------------------------------------------------------
+		static void noteRemove(std::string& warning, const char* what, const std::string& delErr, const svcinst::platform::DeferredRemove& defer)
+		{
+			std::string note;
+			if (!delErr.empty()) note = std::string(what) + " not removed: " + delErr;
+			else if (defer.deferred) note = std::string(what) + " removal deferred"
+				+ (defer.statusFile.empty() ? std::string() : ", status: " + defer.statusFile.string());
+			if (note.empty()) return;
+			if (!warning.empty()) warning += "; ";
+			warning += note;
+		}
+		//------------------------------------------------------------
 		//	Удаляем папку инсталляции и папку с сигналами
+		//	(plan != nullptr - только записываем шаги). untilExit - разовый
+		//	запуск: отложенное удаление ждёт нашего выхода; иначе (поток,
+		//	агент, встраивание) уборщик стартует через kDeferDelayMs.
+		//	Возврат - предупреждение для ответа (пусто - всё удалено)
 		//------------------------------------------------------------
-		static void cleanupAfterUninstall(const svcinst::CliOptions& opt)
+		static std::string cleanupAfterUninstall(const svcinst::CliOptions& opt, svcinst::Plan* plan, bool untilExit)
 		{
+			//---В offline-режиме пути относятся к образу
+			const bool offline = !opt.root.empty();
+			const svcinst::platform::DeleteThrottle throttle = deleteThrottle(opt);
+			std::string warning;
+			svcinst::platform::DeferredRemove defer;
+			defer.untilExit = untilExit;
+
 			//---DataRoot
 			if (wantDeleteDataRoot(opt.del))
 			{
 				if (!opt.dataRoot.empty())
 				{
+					svcinst::fs::path dataRoot(opt.dataRoot);
+					if (offline) dataRoot = svcinst::fs::absolute(opt.root) / dataRoot.relative_path();
+
+					//---Выборочная очистка (--data-include/--data-exclude): только на месте -
+					//   в корзину каталог уходит целиком
+					svcinst::PathFilter filter;
 					std::string delErr;
-					(void)svcinst::platform::removeDataRoot(svcinst::fs::path(opt.dataRoot), &delErr);
+					if (!filter.compile(opt.dataInclude, opt.dataExclude, &delErr))
+					{
+						delErr = "invalid --data-include/--data-exclude " + delErr + "; data root kept";
+					}
+					else
+					{
+						const bool trash = opt.trash && !filter.active();
+						if (opt.trash && !trash) LOG(INFO) << "--trash: data root is cleaned selectively in place";
+
+						if (plan) planRemoveDir(*plan, dataRoot, filter.active() ? "data root, estimate; selective" : trash ? "data root, estimate; to trash, background reclaim" : "data root, estimate", &filter);
+						else if (!trash || !trashDir(dataRoot, throttle)) (void)svcinst::platform::removeDataRoot(dataRoot, &delErr, throttle, &filter, &defer);
+					}
 					if (!delErr.empty())
 					{
 						LOG(WARNING) << "removeDataRoot: " << delErr;
 					}
+					noteRemove(warning, "data root", delErr, defer);
 				}
 				else
 				{
@@ -49,18 +151,27 @@ namespace svcinst {
 				}
 			}
 
-			//---InstallDir
-			if (wantDeleteInstallDir(opt.del))
+			//---InstallDir (папка самого установщика к образу отношения не имеет)
+			if (wantDeleteInstallDir(opt.del) && offline)
+			{
+				LOG(WARNING) << "--delete=install|all: install dir is not removed with --root";
+			}
+			else if (wantDeleteInstallDir(opt.del))
 			{
 				const svcinst::fs::path installDir = svcinst::selfDir();
 
 				std::string delErr;
-				(void)svcinst::platform::removeInstallDir(installDir, &delErr, opt.fromInno);
+				defer = {};
+				defer.untilExit = untilExit;
+				if (plan) planRemoveDir(*plan, installDir, opt.fromInno ? "install dir, estimate; Windows: left to Inno Setup" : "install dir, estimate");
+				else if (!opt.trash || !trashDir(installDir, throttle)) (void)svcinst::platform::removeInstallDir(installDir, &delErr, opt.fromInno, throttle, &defer);
 				if (!delErr.empty())
 				{
 					LOG(WARNING) << "removeInstallDir: " << delErr;
 				}
+				noteRemove(warning, "install dir", delErr, defer);
 			}
+			return warning;
 		}
 	} // namespace
 
@@ -82,97 +193,981 @@ namespace svcinst {
 		return true;
 	}
 	//------------------------------------------------------------
-	//	Оркестратор: запуск установщика службы с заданными опциями
+	//	Состояние службы одной строкой (--status)
 	//------------------------------------------------------------
-	int runInstaller(const CliOptions& opt) {
+	static std::string formatStatus(const ServiceStatus& st)
+	{
+		std::string s = st.installed ? "installed" : "not installed";
+		if (st.installed) s += st.managed ? ", managed" : ", not managed";
+		if (st.installed) s += st.autostart ? ", autostart on" : ", autostart off";
+		s += ", " + (st.activeState.empty() ? std::string("state unknown") : st.activeState);
+		return s;
+	}
+	//------------------------------------------------------------
+	//	Итог по внешним процессам (systemctl / sc.exe): какая часть
+	//	времени команды ушла на них, а какая - на собственный код.
+	//	totals() накапливается за весь процесс (библиотечный вызывающий
+	//	может звать runInstaller много раз) - в итог идёт разница со
+	//	снимком before; peak rss - максимум по процессу
+	//------------------------------------------------------------
+	static void logSpawnSummary(std::chrono::steady_clock::time_point started, const process::RunTotals& before)
+	{
+		const process::RunTotals now = process::totals();
+		process::RunTotals t;
+		t.count = now.count - before.count;
+		if (t.count == 0) return;
+		t.sum.wallUs = now.sum.wallUs - before.sum.wallUs;
+		t.sum.userCpuUs = now.sum.userCpuUs - before.sum.userCpuUs;
+		t.sum.sysCpuUs = now.sum.sysCpuUs - before.sum.sysCpuUs;
+		t.sum.maxRssKb = now.sum.maxRssKb;
+		t.sum.volCtxSwitches = now.sum.volCtxSwitches - before.sum.volCtxSwitches;
+		t.sum.involCtxSwitches = now.sum.involCtxSwitches - before.sum.involCtxSwitches;
 
-		//---Проверка прав администратора / root
-		if (!requireAdminRoot()) return fail("Administrator/root privileges required.");
+		const auto totalUs = (std::uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - started).count();
+		const std::uint64_t childPct = totalUs ? (t.sum.wallUs * 100 / totalUs) : 0;
+
+		LOG(INFO) << "child processes: " << t.count
+			<< ", wall " << t.sum.wallUs / 1000 << " ms of " << totalUs / 1000 << " ms total (" << childPct << "%)"
+			<< ", cpu user " << t.sum.userCpuUs / 1000 << " ms / sys " << t.sum.sysCpuUs / 1000 << " ms"
+			<< ", peak rss " << t.sum.maxRssKb << " KiB"
+			<< ", ctxsw " << t.sum.volCtxSwitches << "/" << t.sum.involCtxSwitches;
+	}
+	//------------------------------------------------------------
+	//	Итог installOrUpdate: что сделано, а что пропущено как
+	//	не требующееся (повторная установка той же спецификации)
+	//------------------------------------------------------------
+	static void logInstallReport(const ServiceSpec& spec, const InstallReport& r, bool offline)
+	{
+		std::string skipped;
+		auto skip = [&skipped](bool done, const char* step) {
+			if (done) return;
+			if (!skipped.empty()) skipped += ", ";
+			skipped += step;
+		};
+		skip(r.unitWritten, "write");
+		if (!offline) skip(r.reloaded, "reload");
+		skip(r.autostartChanged, "enable");
+		if (spec.runNow && !offline) skip(r.restarted, "restart");
+
+		if (r.noChange())
+		{
+			LOG(INFO) << "install " << spec.name << ": no change (skipped: " << skipped << ")";
+		}
+		else if (!skipped.empty())
+		{
+			VLOG(1) << "install " << spec.name << ": skipped " << skipped;
+		}
+	}
+	//------------------------------------------------------------
+	//	Ключ блокировки службы: имя, а в offline-режиме ещё и корень
+	//	образа - установки в разные образы друг другу не мешают
+	//------------------------------------------------------------
+	static std::string serviceLockKey(const std::string& name, const std::string& rootDir)
+	{
+		if (rootDir.empty()) return name;
+
+		const std::string root = fs::absolute(rootDir).lexically_normal().string();
+		char hex[17];
+		std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)std::hash<std::string>{}(root));
+		return name + "@" + hex;
+	}
+	static std::string serviceLockKey(const CliOptions& opt)
+	{
+		return serviceLockKey(opt.name, opt.root);
+	}
+	//------------------------------------------------------------
+	//	Список через запятую ("a, b,c") → элементы без пробелов
+	//------------------------------------------------------------
+	static std::vector<std::string> splitList(const std::string& s)
+	{
+		std::vector<std::string> out;
+		std::size_t from = 0;
+		while (from <= s.size())
+		{
+			std::size_t to = s.find(',', from);
+			if (to == std::string::npos) to = s.size();
+			const std::size_t b = s.find_first_not_of(" \t", from);
+			const std::size_t e = s.find_last_not_of(" \t", to == 0 ? 0 : to - 1);
+			if (b != std::string::npos && b < to && e != std::string::npos && e >= b)
+			{
+				std::string item = s.substr(b, e - b + 1);
+				if (std::find(out.begin(), out.end(), item) == out.end()) out.push_back(std::move(item));
+			}
+			from = to + 1;
+		}
+		return out;
+	}
+	//------------------------------------------------------------
+	//	Проверка прав и создание бэкенда по общим опциям запуска
+	//	(nullptr + err - продолжать нельзя)
+	//------------------------------------------------------------
+	static std::unique_ptr<IServiceBackend> openBackend(const CliOptions& opt, BackendOptions& bo, std::string& err) {
+
+		//---Offline-режим: дерево образа, живая система не затрагивается
+		const bool offline = !opt.root.empty();
+		if (offline && opt.backend != BackendKind::Default) { err = "--root cannot be combined with --backend=dbus."; return nullptr; }
+
+		//---Проверка прав администратора / root (в offline-режиме достаточно прав на запись в дерево,
+		//   для --plan - на чтение: система не меняется)
+		if (!offline && !bo.plan && !requireAdminRoot()) { err = "Administrator/root privileges required."; return nullptr; }
 
 		//---Создание бэкенда для текущей платформы
-		auto backend = makeBackend();
+		bo.kind = opt.backend;
+		bo.enableMode = opt.enableMode;
+		bo.durability = opt.durability;
+		if (offline) bo.root = fs::absolute(opt.root);
+		auto backend = makeBackend(bo);
 
 		//---Проверка доступности бэкенда
-		if (!backend) return fail("Backend not available on this platform.");
+		if (!backend && offline) err = "--root is not supported on this platform.";
+		else if (!backend && opt.backend != BackendKind::Default) err = "Requested --backend is not available in this build/platform.";
+		else if (!backend) err = "Backend not available on this platform.";
+		return backend;
+	}
+	//------------------------------------------------------------
+	//	Формирование спецификации службы для --install
+	//------------------------------------------------------------
+	static bool buildInstallSpec(const CliOptions& opt, const fs::path& root, ServiceSpec& spec, std::string& err) {
 
-		//---Валидация опций
-		if (opt.cmd != Command::Help)
+		const bool offline = !root.empty();
+
+		//---Если путь к исполняемому файлу службы не задан → ошибка
+		if (opt.exe.empty()) { err = "Missing required option for --install: --exe=<path_to_service_executable>"; return false; }
+
+		//---Формирование спецификации службы
+		spec.name = opt.name;
+		spec.description = opt.description;
+
+		//---Если описание службы пустое → использование имени службы
+		if (spec.description.empty() || isEmptyOrWhitespace(spec.description))
+		{
+			spec.description = spec.name;
+		}
+		//---Парсим путь к исполняемому файлу службы (в offline-режиме - путь внутри образа)
+		spec.root = root;
+		spec.exeAbs = resolveServiceExePath(opt.exe, spec.root);
+
+		//---Если путь к службе не задан → ошибка
+		if (spec.exeAbs.empty()) { err = "Failed to resolve --exe path."; return false; }
+
+		//---Проверяем наличие exe там, где его увидит служба
+		const fs::path exeOnDisk = offline ? spec.root / spec.exeAbs.relative_path() : spec.exeAbs;
+		std::error_code ec;
+		if (!fs::exists(exeOnDisk, ec)) { err = "Service executable does not exist: " + exeOnDisk.string(); return false; }
+
+		spec.args = opt.args;		//	Аргументы командной строки для exe
+		spec.dependsOn = splitList(opt.dependsOn);	//	Службы, запускаемые раньше этой
+		spec.autostart = true;		//	Включать при загрузке(включать systemd / автозапуск Windows)
+		spec.runNow = opt.runNow;	//	Запустить службу сразу после установки
+
+		//---В образе запускать нечего: служба стартует при загрузке по wants-симлинку
+		if (offline && spec.runNow)
 		{
-			if (opt.name.empty()) return fail("Missing required option: --name=<service_name>");
+			LOG(WARNING) << "--run is ignored with --root";
+			spec.runNow = false;
 		}
+		return true;
+	}
+	//------------------------------------------------------------
+	//	Блокировки служб пакета (ключ, индекс элемента): по возрастанию
+	//	ключа, чтобы два пакетных запуска не ждали друг друга по кругу.
+	//	Занятые дольше --lock-wait - onBusy(индекс, текст ошибки).
+	//	--plan ничего не меняет и не блокирует
+	//------------------------------------------------------------
+	template<class OnBusy>
+	static std::vector<std::unique_ptr<platform::ServiceLock>> lockServices(
+		std::vector<std::pair<std::string, std::size_t>> keys, const CliOptions& opt, OnBusy&& onBusy)
+	{
+		std::vector<std::unique_ptr<platform::ServiceLock>> locks;
+		if (opt.plan) return locks;
 
+		const std::uint32_t waitMs = opt.lockWaitMs;
+		std::sort(keys.begin(), keys.end());
 		std::string err;
+		for (const auto& [key, i] : keys)
+		{
+			bool isBusy = false;
+			auto lock = platform::lockService(key, waitMs, isBusy, &err);
+			if (lock) locks.push_back(std::move(lock));
+			else if (isBusy) onBusy(i, err);
+			else LOG(WARNING) << "running without service lock: " << err;
+			err.clear();
+		}
+		return locks;
+	}
+	//------------------------------------------------------------
+	//	Групповой запуск/остановка с учётом зависимостей.
+	//	Граф строится по IServiceBackend::dependencies (зависимости вне
+	//	группы не учитываются) и обходится волнами (алгоритм Кана):
+	//	в волне - все службы, чьи зависимости уже запущены; волна уходит
+	//	в бэкенд одним startMany (Linux: один systemctl start a b c,
+	//	systemd выполняет задания параллельно). stop - те же волны в
+	//	обратном порядке. Время запуска стека - длина критического пути,
+	//	а не сумма времён. Служба, зависимость которой не запустилась
+	//	(или зависимая от которой не остановилась), не трогается.
+	//------------------------------------------------------------
+	static void runWaves(IServiceBackend& backend, bool start, const std::vector<std::string>& names, std::vector<BatchResult>& results)
+	{
+		const std::size_t n = names.size();
+		results.assign(n, {});
 
-		//---Если команда — установка службы 
-		if (opt.cmd == Command::Install)
+		//---Рёбра: before[i] - службы группы, которые запускаются раньше i
+		std::vector<std::vector<std::size_t>> before(n), after(n);
+		std::vector<bool> done(n, false);
+		std::vector<std::string> deps;
+		for (std::size_t i = 0; i < n; ++i)
 		{
-			//---Если путь к исполняемому файлу службы не задан → ошибка
-			if (opt.exe.empty()) return fail("Missing required option for --install: --exe=<path_to_service_executable>");
+			if (!backend.dependencies(names[i], deps, &results[i].error))
+			{
+				done[i] = true;
+				continue;
+			}
+			for (const std::string& d : deps)
+			{
+				const auto it = std::find(names.begin(), names.end(), d);
+				if (it == names.end()) continue;
+				const std::size_t j = (std::size_t)(it - names.begin());
+				before[i].push_back(j);
+				after[j].push_back(i);
+			}
+		}
 
-			//---Формирование спецификации службы
-			ServiceSpec spec;
-			spec.name = opt.name;
-			spec.description = opt.description;
+		//---Волны: для stop "зависимости" - это службы, зависящие от данной
+		const auto& waitFor = start ? before : after;
+		std::vector<std::vector<std::size_t>> waves;
+		std::vector<std::size_t> left(n);
+		for (std::size_t i = 0; i < n; ++i) left[i] = waitFor[i].size();
+		std::vector<bool> placed(n, false);
+		for (;;)
+		{
+			std::vector<std::size_t> wave;
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				if (!placed[i] && left[i] == 0) wave.push_back(i);
+			}
+			if (wave.empty()) break;
+			for (std::size_t i : wave)
+			{
+				placed[i] = true;
+				for (std::size_t k : (start ? after : before)[i]) --left[k];
+			}
+			waves.push_back(std::move(wave));
+		}
+
+		//---Цикл зависимостей: такие службы не трогаем
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			if (placed[i] || done[i]) continue;
+			done[i] = true;
+			results[i].error = "dependency cycle involving '" + names[i] + "'";
+		}
 
-			//---Если описание службы пустое → использование имени службы
-			if (spec.description.empty() || isEmptyOrWhitespace(spec.description))
+		std::vector<std::string> waveNames;
+		std::vector<BatchResult> part;
+		for (std::size_t w = 0; w < waves.size(); ++w)
+		{
+			waveNames.clear();
+			std::vector<std::size_t> run;
+			for (std::size_t i : waves[w])
 			{
-				spec.description = spec.name;
+				if (done[i]) continue;
+				//---Предшественник по волнам не справился - эту службу не трогаем
+				for (std::size_t j : waitFor[i])
+				{
+					if (results[j].ok) continue;
+					results[i].error = std::string(start ? "dependency '" : "dependent '") + names[j] +
+						(start ? "' failed to start" : "' failed to stop");
+					break;
+				}
+				if (!results[i].error.empty()) { done[i] = true; continue; }
+				run.push_back(i);
+				waveNames.push_back(names[i]);
 			}
-			//---Парсим путь к исполняемому файлу службы
-			spec.exeAbs = resolveServiceExePath(opt.exe);
+			if (run.empty()) continue;
+
+			VLOG(1) << (start ? "start" : "stop") << " wave " << w + 1 << "/" << waves.size() << ": " << waveNames.size() << " service(s)";
+			if (start) backend.startMany(waveNames, part);
+			else backend.stopMany(waveNames, part);
+			for (std::size_t k = 0; k < run.size(); ++k)
+			{
+				results[run[k]] = std::move(part[k]);
+				done[run[k]] = true;
+			}
+		}
+	}
+	//------------------------------------------------------------
+	//	--start/--stop --group=a,b,c: блокировки всей группы и волны
+	//------------------------------------------------------------
+	static int execGroup(const CliOptions& opt, IServiceBackend& backend, std::string& err) {
+
+		const std::vector<std::string> names = splitList(opt.group);
+		if (names.empty()) { err = "--group is empty"; return 1; }
+
+		std::vector<std::pair<std::string, std::size_t>> keys;
+		for (std::size_t i = 0; i < names.size(); ++i) keys.emplace_back(serviceLockKey(names[i], opt.root), i);
+		std::string busyErr;
+		const auto locks = lockServices(std::move(keys), opt, [&](std::size_t, const std::string& why) {
+			if (busyErr.empty()) busyErr = why;
+		});
+		if (!busyErr.empty()) { err = busyErr; return kExitBusy; }
+
+		std::vector<BatchResult> results;
+		runWaves(backend, opt.cmd == Command::Start, names, results);
 
-			//---Если путь к службе не задан → ошибка
-			if (spec.exeAbs.empty()) return fail("Failed to resolve --exe path.");
+		//---Итог: ошибки всех служб группы в одном сообщении
+		for (std::size_t i = 0; i < names.size(); ++i)
+		{
+			if (results[i].ok) continue;
+			if (!err.empty()) err += "; ";
+			err += names[i] + ": " + (results[i].error.empty() ? "failed" : results[i].error);
+		}
+		return err.empty() ? 0 : 1;
+	}
+	//------------------------------------------------------------
+	//	Выполнение одной команды на готовом бэкенде
+	//	(код выхода; при ошибке её текст - в r.error, без логирования;
+	//	untilExit - см. cleanupAfterUninstall)
+	//------------------------------------------------------------
+	static int execCommand(const CliOptions& opt, IServiceBackend& backend, const BackendOptions& bo, bool untilExit, CommandResult& r) {
 
-			std::error_code ec;
-			if (!fs::exists(spec.exeAbs, ec)) return fail("Service executable does not exist: " + spec.exeAbs.string());
+		std::string& err = r.error;
+		const bool offline = !opt.root.empty();
+		auto failWith = [&err](const std::string& msg) { err = msg; return 1; };
 
-			spec.args = opt.args;		//	Аргументы командной строки для exe
-			spec.autostart = true;		//	Включать при загрузке(включать systemd / автозапуск Windows)
-			spec.runNow = opt.runNow;	//	Запустить службу сразу после установки
+		//---Группа служб: запуск/остановка волнами по зависимостям
+		if (!opt.group.empty()) return execGroup(opt, backend, err);
+
+		//---Валидация опций
+		if (opt.name.empty()) return failWith("Missing required option: --name=<service_name>");
+
+		//---Состояние только читается - блокировка не нужна
+		if (opt.cmd == Command::Status)
+		{
+			ServiceStatus st;
+			if (!backend.status(opt.name, st, &err)) return failWith(err.empty() ? "status failed." : err);
+			r.status = st;
+			return 0;
+		}
+
+		//---Операции над одной службой выполняются строго по очереди, над разными - параллельно
+		std::string busyErr;
+		const auto locks = lockServices({ { serviceLockKey(opt), 0 } }, opt, [&](std::size_t, const std::string& why) {
+			busyErr = why;
+		});
+		if (!busyErr.empty()) { err = busyErr; return kExitBusy; }
+
+		//---Если команда — установка службы 
+		if (opt.cmd == Command::Install)
+		{
+			//---Формирование спецификации службы
+			ServiceSpec spec;
+			if (!buildInstallSpec(opt, bo.root, spec, err)) return 1;
 
 			//---Установка или обновление службы c заданной спецификацией
-			if (!backend->installOrUpdate(spec, &err))
+			InstallReport report;
+			if (!backend.installOrUpdate(spec, &err, &report))
 			{
-				return fail(err.empty() ? "installOrUpdate failed." : err);
+				return failWith(err.empty() ? "installOrUpdate failed." : err);
 			}
+			logInstallReport(spec, report, offline);
+			r.report = report;
 
-			if (spec.runNow)
+			//---Запуск, если бэкенд не сделал его сам
+			if (spec.runNow && !report.started)
 			{
-				if (!backend->start(spec.name, &err)) return fail(err.empty() ? "start failed." : err);
+				if (!backend.start(spec.name, &err)) return failWith(err.empty() ? "start failed." : err);
 			}
+			if (!backend.flush(&err)) return 1;
 			return 0;
 		}
 		//---Если команда — удаление службы
 		if (opt.cmd == Command::Uninstall)
 		{
-			if (!backend->uninstall(opt.name, opt.stopFirst, &err))
+			if (!backend.uninstall(opt.name, opt.stopFirst, &err))
 			{
-				return fail(err.empty() ? "uninstall failed." : err);
+				return failWith(err.empty() ? "uninstall failed." : err);
 			}
+			if (!backend.flush(&err)) return 1;
 
-			cleanupAfterUninstall(opt);
+			r.warning = cleanupAfterUninstall(opt, bo.plan, untilExit);
 			return 0;
 		}
 		//---Если команда — запуск службы
 		if (opt.cmd == Command::Start)
 		{
-			if (!backend->start(opt.name, &err))
+			if (!backend.start(opt.name, &err))
 			{
-				return fail(err.empty() ? "start failed." : err);
+				return failWith(err.empty() ? "start failed." : err);
 			}
 			return 0;
 		}
 		//---Если команда — остановка службы
 		if (opt.cmd == Command::Stop)
 		{
-			if (!backend->stop(opt.name, &err))
+			if (!backend.stop(opt.name, &err))
 			{
-				return fail(err.empty() ? "stop failed." : err);
+				return failWith(err.empty() ? "stop failed." : err);
 			}
 			return 0;
 		}
 		return 2;
 	}
+	//------------------------------------------------------------
+	//	Одна команда на готовом бэкенде: результат - значением
+	//	(untilExit: разовый запуск, см. cleanupAfterUninstall)
+	//------------------------------------------------------------
+	static CommandResult executeCommand(const CliOptions& command, IServiceBackend& backend, Plan* plan, bool untilExit) {
+
+		CommandResult r;
+		switch (command.cmd)
+		{
+		case Command::Install: case Command::Uninstall: case Command::Start: case Command::Stop: case Command::Status: break;
+		default:
+			r.code = 2;
+			r.error = "execute: not a single-service command (--install|--uninstall|--start|--stop|--status)";
+			return r;
+		}
+
+		BackendOptions bo;
+		bo.plan = plan;
+		if (!command.root.empty()) bo.root = fs::absolute(command.root);
+		r.code = execCommand(command, backend, bo, untilExit, r);
+		if (r.code != 0 && r.error.empty()) r.error = "failed";
+		return r;
+	}
+	//------------------------------------------------------------
+	//	Выполнение одной команды установщика
+	//------------------------------------------------------------
+	static int runCommand(const CliOptions& opt) {
+
+		std::string err;
+
+		//---Проверка прав и создание бэкенда (--plan: бэкенд только записывает шаги)
+		Plan plan;
+		BackendOptions bo;
+		if (opt.plan) bo.plan = &plan;
+		auto backend = openBackend(opt, bo, err);
+		if (!backend) return fail(err);
+
+		const CommandResult r = executeCommand(opt, *backend, bo.plan, true);
+		backend.reset();	//	Отложенный syncfs (Durability::Batch) - тоже шаг плана
+		if (!r.ok() && !r.error.empty()) LOG(ERROR) << r.error;
+		if (r.ok() && opt.cmd == Command::Status) std::cout << opt.name << ": " << formatStatus(r.status) << "\n";
+		if (opt.plan) plan.print(std::cout);
+		return r.code;
+	}
+	//------------------------------------------------------------
+	//	Название команды для строки результата пакетного режима
+	//------------------------------------------------------------
+	static const char* commandName(Command c)
+	{
+		switch (c)
+		{
+		case Command::Install: return "install";
+		case Command::Uninstall: return "uninstall";
+		case Command::Start: return "start";
+		case Command::Stop: return "stop";
+		case Command::Status: return "status";
+		default: return "-";
+		}
+	}
+	//------------------------------------------------------------
+	//	Общие для всего запуска опции (--root, --backend, ...) из
+	//	командной строки → команде из манифеста/потока
+	//------------------------------------------------------------
+	static void applyRunOptions(const CliOptions& run, CliOptions& o)
+	{
+		o.root = run.root;
+		o.backend = run.backend;
+		o.enableMode = run.enableMode;
+		o.durability = run.durability;
+		o.lockWaitMs = run.lockWaitMs;
+		o.plan = run.plan;
+	}
+	//------------------------------------------------------------
+	//	Пакетный режим (--manifest=<file>): все команды файла в одном
+	//	процессе. Однотипные команды уходят в бэкенд одним пакетом
+	//	(*Many): unit'ы пишутся все сразу, затем один daemon-reload,
+	//	один enable и один start на всех. Порядок групп: stop,
+	//	uninstall, install, start. На каждую строку - строка итога в stdout.
+	//------------------------------------------------------------
+	static int runManifest(const CliOptions& opt) {
+
+		std::string err;
+		std::vector<ManifestEntry> entries;
+		if (!loadManifest(opt.manifest, entries, &err)) return fail(err);
+		if (entries.empty()) return fail("Manifest is empty: " + opt.manifest);
+
+		//---Общие для всего запуска опции
+		Plan plan;
+		BackendOptions bo;
+		if (opt.plan) bo.plan = &plan;
+		auto backend = openBackend(opt, bo, err);
+		if (!backend) return fail(err);
+
+		const std::size_t n = entries.size();
+		std::vector<BatchResult> results(n);
+		std::vector<bool> busy(n, false);
+		std::vector<ServiceSpec> specs(n);
+		std::vector<bool> pending(n, false);	//	Строка корректна и ждёт выполнения
+
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			ManifestEntry& e = entries[i];
+			CliOptions& o = e.opt;
+			applyRunOptions(opt, o);
+
+			if (!e.error.empty()) { results[i].error = e.error; continue; }
+			if (!o.group.empty()) { results[i].error = "--group is not supported in a manifest: list services as separate lines"; continue; }
+			if (o.cmd == Command::Status) { results[i].error = "--status is not supported in a manifest"; continue; }
+
+			//---Одна служба - одна строка: иначе порядок операций над ней неочевиден
+			bool dup = false;
+			for (std::size_t j = 0; j < i && !dup; ++j)
+				dup = entries[j].error.empty() && entries[j].opt.name == o.name;
+			if (dup) { results[i].error = "duplicate entry for service '" + o.name + "'"; continue; }
+
+			if (o.cmd == Command::Install && !buildInstallSpec(o, bo.root, specs[i], results[i].error)) continue;
+			pending[i] = true;
+		}
+
+		//---Блокировки служб
+		std::vector<std::pair<std::string, std::size_t>> keys;
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			if (pending[i]) keys.emplace_back(serviceLockKey(entries[i].opt), i);
+		}
+		const auto locks = lockServices(std::move(keys), opt, [&](std::size_t i, const std::string& why) {
+			busy[i] = true;
+			pending[i] = false;
+			results[i].error = why;
+		});
+
+		//---Выполнение группы однотипных команд одним вызовом бэкенда
+		auto runGroup = [&](auto pick, auto call) {
+			std::vector<std::size_t> idx;
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				if (pending[i] && pick(entries[i].opt)) idx.push_back(i);
+			}
+			if (idx.empty()) return;
+
+			std::vector<BatchResult> part;
+			call(idx, part);
+			for (std::size_t k = 0; k < idx.size(); ++k) results[idx[k]] = std::move(part[k]);
+		};
+		auto namesOf = [&](const std::vector<std::size_t>& idx) {
+			std::vector<std::string> names;
+			names.reserve(idx.size());
+			for (std::size_t i : idx) names.push_back(entries[i].opt.name);
+			return names;
+		};
+
+		runGroup([](const CliOptions& o) { return o.cmd == Command::Stop; },
+			[&](const std::vector<std::size_t>& idx, std::vector<BatchResult>& r) { runWaves(*backend, false, namesOf(idx), r); });
+		for (bool stopFirst : { true, false })
+		{
+			runGroup([stopFirst](const CliOptions& o) { return o.cmd == Command::Uninstall && o.stopFirst == stopFirst; },
+				[&](const std::vector<std::size_t>& idx, std::vector<BatchResult>& r) { backend->uninstallMany(namesOf(idx), stopFirst, r); });
+		}
+		runGroup([](const CliOptions& o) { return o.cmd == Command::Install; },
+			[&](const std::vector<std::size_t>& idx, std::vector<BatchResult>& r) {
+				std::vector<ServiceSpec> part;
+				part.reserve(idx.size());
+				for (std::size_t i : idx) part.push_back(specs[i]);
+				backend->installMany(part, r);
+			});
+		runGroup([](const CliOptions& o) { return o.cmd == Command::Start; },
+			[&](const std::vector<std::size_t>& idx, std::vector<BatchResult>& r) { runWaves(*backend, true, namesOf(idx), r); });
+
+		//---Очистка после удаления и сброс отложенных записей на диск
+		std::vector<std::string> warnings(n);
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			if (pending[i] && results[i].ok && entries[i].opt.cmd == Command::Uninstall) warnings[i] = cleanupAfterUninstall(entries[i].opt, bo.plan, true);
+		}
+		const bool flushed = backend->flush(&err);
+		if (!flushed) LOG(ERROR) << err;
+
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			if (results[i].ok && entries[i].opt.cmd == Command::Install) logInstallReport(specs[i], results[i].report, !bo.root.empty());
+		}
+
+		//---Итог по строкам
+		std::size_t failed = 0, busyCount = 0;
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			const ManifestEntry& e = entries[i];
+			const BatchResult& r = results[i];
+			std::cout << "line " << e.line << ": " << commandName(e.opt.cmd);
+			if (!e.opt.name.empty()) std::cout << " " << e.opt.name;
+			std::cout << ": ";
+			if (r.ok)
+			{
+				const bool noChange = (e.opt.cmd == Command::Install) && r.report.noChange();
+				if (!warnings[i].empty()) std::cout << "ok (" << oneLine(warnings[i]) << ")\n";
+				else std::cout << (noChange ? "ok (no change)\n" : "ok\n");
+				continue;
+			}
+			++failed;
+			if (busy[i]) ++busyCount;
+			std::cout << (busy[i] ? "BUSY: " : "FAILED: ") << (r.error.empty() ? "failed" : r.error) << "\n";
+		}
+		if (opt.plan) plan.print(std::cout);
+		std::cout.flush();
+
+		LOG(INFO) << "manifest " << opt.manifest << ": " << (n - failed) << " ok, " << failed << " failed";
+		if (!flushed) return 1;
+		if (failed == 0) return 0;
+		return (failed == busyCount) ? kExitBusy : 1;
+	}
+	//------------------------------------------------------------
+	//	Приведение к желаемому состоянию (--reconcile=<file>).
+	//	Файл - строки --install в синтаксисе манифеста. Каждая служба
+	//	сравнивается с установленной (IServiceBackend::inspect):
+	//	create / update / unchanged; службы установщика, которых нет в
+	//	файле, - orphan (stop + uninstall). Применяется только разница:
+	//	unchanged не трогаются вовсе (и не запускаются повторно), так
+	//	что время прохода зависит от числа изменений, а не от размера парка.
+	//------------------------------------------------------------
+	static int runReconcile(const CliOptions& opt) {
+
+		std::string err;
+		std::vector<ManifestEntry> entries;
+		if (!loadManifest(opt.reconcile, entries, &err)) return fail(err);
+
+		Plan plan;
+		BackendOptions bo;
+		if (opt.plan) bo.plan = &plan;
+		auto backend = openBackend(opt, bo, err);
+		if (!backend) return fail(err);
+
+		enum class Action { Create, Update, Unchanged, Remove };
+		struct Item {
+			std::size_t line = 0;		//	0 - orphan (нет строки в файле)
+			std::string name;
+			Action action = Action::Unchanged;
+			ServiceSpec spec;
+			BatchResult result;
+			bool busy = false;
+		};
+		std::vector<Item> items;
+		items.reserve(entries.size());
+
+		//---Желаемое состояние. Любая ошибка в файле - отказ до изменений:
+		//   служба с испорченной строкой иначе выглядела бы осиротевшей и была бы удалена
+		bool invalid = false;
+		for (ManifestEntry& e : entries)
+		{
+			applyRunOptions(opt, e.opt);
+			std::string why = e.error;
+			if (why.empty() && e.opt.cmd != Command::Install) why = "only --install entries are allowed in a desired-state file";
+			for (const Item& it : items)
+			{
+				if (why.empty() && it.name == e.opt.name) why = "duplicate entry for service '" + e.opt.name + "'";
+			}
+
+			Item it;
+			it.line = e.line;
+			it.name = e.opt.name;
+			if (why.empty()) buildInstallSpec(e.opt, bo.root, it.spec, why);
+			if (!why.empty())
+			{
+				LOG(ERROR) << opt.reconcile << ":" << e.line << ": " << why;
+				invalid = true;
+			}
+			items.push_back(std::move(it));
+		}
+		if (invalid) return fail("Desired state has errors, nothing changed: " + opt.reconcile);
+
+		//---Что есть сейчас: сравнение с установленными и поиск осиротевших служб установщика
+		for (Item& it : items)
+		{
+			const SpecState st = backend->inspect(it.spec);
+			it.action = (st == SpecState::Missing) ? Action::Create : (st == SpecState::Differs) ? Action::Update : Action::Unchanged;
+		}
+		std::vector<std::string> managed;
+		if (backend->listManaged(managed, &err))
+		{
+			for (const std::string& name : managed)
+			{
+				const bool wanted = std::any_of(items.begin(), items.end(), [&](const Item& it) { return it.name == name; });
+				if (wanted) continue;
+				Item orphan;
+				orphan.name = name;
+				orphan.action = Action::Remove;
+				items.push_back(std::move(orphan));
+			}
+		}
+		else
+		{
+			LOG(WARNING) << "orphaned services are not removed: " << err;
+		}
+		err.clear();
+
+		std::size_t counts[4] = {};
+		for (const Item& it : items) ++counts[(int)it.action];
+		LOG(INFO) << "reconcile " << opt.reconcile << ": " << counts[(int)Action::Create] << " create, "
+			<< counts[(int)Action::Update] << " update, " << counts[(int)Action::Unchanged] << " unchanged, "
+			<< counts[(int)Action::Remove] << " remove";
+
+		//---Блокировки только для того, что будет меняться
+		std::vector<std::pair<std::string, std::size_t>> keys;
+		for (std::size_t i = 0; i < items.size(); ++i)
+		{
+			if (items[i].action != Action::Unchanged) keys.emplace_back(serviceLockKey(items[i].name, opt.root), i);
+		}
+		const auto locks = lockServices(std::move(keys), opt, [&](std::size_t i, const std::string& why) {
+			items[i].busy = true;
+			items[i].result.error = why;
+		});
+
+		//---Применение разницы: сначала удаление осиротевших, затем установка одним пакетом
+		std::vector<std::size_t> toRemove, toInstall;
+		for (std::size_t i = 0; i < items.size(); ++i)
+		{
+			if (items[i].busy) continue;
+			if (items[i].action == Action::Remove) toRemove.push_back(i);
+			else if (items[i].action != Action::Unchanged) toInstall.push_back(i);
+			else items[i].result.ok = true;
+		}
+		std::vector<BatchResult> part;
+		if (!toRemove.empty())
+		{
+			std::vector<std::string> names;
+			for (std::size_t i : toRemove) names.push_back(items[i].name);
+			backend->uninstallMany(names, true, part);
+			for (std::size_t k = 0; k < toRemove.size(); ++k) items[toRemove[k]].result = std::move(part[k]);
+		}
+		if (!toInstall.empty())
+		{
+			std::vector<ServiceSpec> specs;
+			for (std::size_t i : toInstall) specs.push_back(items[i].spec);
+			backend->installMany(specs, part);
+			for (std::size_t k = 0; k < toInstall.size(); ++k) items[toInstall[k]].result = std::move(part[k]);
+		}
+		const bool flushed = backend->flush(&err);
+		if (!flushed) LOG(ERROR) << err;
+
+		//---Итог по службам
+		static const char* const kActionNames[] = { "create", "update", "unchanged", "remove" };
+		std::size_t failed = 0, busyCount = 0;
+		for (const Item& it : items)
+		{
+			std::cout << kActionNames[(int)it.action] << " " << it.name << ": ";
+			if (it.result.ok)
+			{
+				std::cout << "ok\n";
+				continue;
+			}
+			++failed;
+			if (it.busy) ++busyCount;
+			std::cout << (it.busy ? "BUSY: " : "FAILED: ") << (it.result.error.empty() ? "failed" : it.result.error) << "\n";
+		}
+		if (opt.plan) plan.print(std::cout);
+		std::cout.flush();
+
+		if (!flushed) return 1;
+		if (failed == 0) return 0;
+		return (failed == busyCount) ? kExitBusy : 1;
+	}
+	//------------------------------------------------------------
+	//	Строка ответа на команду потока/агента (без перевода строки):
+	//	"<line> <code> ok|ok (no change)|ok (<warning>)|ok <status>|<error>" или JSON
+	//------------------------------------------------------------
+	static std::string formatReply(const ManifestEntry& e, const CommandResult& r)
+	{
+		const bool isInstall = r.ok() && e.opt.cmd == Command::Install;
+		const bool isStatus = r.ok() && e.opt.cmd == Command::Status;
+		const std::string err = r.error.empty() ? "failed" : r.error;
+		std::string out;
+
+		if (e.json)
+		{
+			out = "{";
+			if (!e.id.empty()) out += "\"id\":" + e.id + ",";
+			out += "\"line\":" + std::to_string(e.line) + ",\"ok\":" + (r.ok() ? "true" : "false") + ",\"code\":" + std::to_string(r.code);
+			if (isInstall) out += std::string(",\"changed\":") + (r.report.noChange() ? "false" : "true");
+			if (isStatus)
+			{
+				const ServiceStatus& st = r.status;
+				out += std::string(",\"status\":{\"installed\":") + (st.installed ? "true" : "false")
+					+ ",\"managed\":" + (st.managed ? "true" : "false")
+					+ ",\"autostart\":" + (st.autostart ? "true" : "false")
+					+ ",\"state\":\"" + jsonEscape(st.activeState) + "\"}";
+			}
+			if (r.ok() && !r.warning.empty()) out += ",\"warning\":\"" + jsonEscape(r.warning) + "\"";
+			if (!r.ok()) out += ",\"error\":\"" + jsonEscape(err) + "\"";
+			return out + "}";
+		}
+
+		out = std::to_string(e.line) + " " + std::to_string(r.code) + " ";
+		if (!r.ok()) return out + oneLine(err);
+		if (isStatus) return out + "ok " + formatStatus(r.status);
+		if (!r.warning.empty()) return out + "ok (" + oneLine(r.warning) + ")";
+		return out + (isInstall && r.report.noChange() ? "ok (no change)" : "ok");
+	}
+	//------------------------------------------------------------
+	//	Строка потока/агента: команда с общими ключами запуска.
+	//	Каталог установки запросом не удаляется: в нём работающий
+	//	установщик, его удаляет отдельный --uninstall
+	//------------------------------------------------------------
+	static ManifestEntry parseRequest(const CliOptions& run, const std::string& line, std::size_t lineNo)
+	{
+		ManifestEntry e;
+		e.line = lineNo;
+		parseCommand(line, e);
+		applyRunOptions(run, e.opt);
+		if (e.error.empty() && wantDeleteInstallDir(e.opt.del))
+			e.error = "--delete=install|all is not allowed in a request: the install directory holds the running installer";
+		return e;
+	}
+	//------------------------------------------------------------
+	//	Ответ на строку, не дошедшую до выполнения
+	//------------------------------------------------------------
+	static CommandResult rejected(int code, const std::string& error)
+	{
+		CommandResult r;
+		r.code = code;
+		r.error = error;
+		return r;
+	}
+	//------------------------------------------------------------
+	//	Потоковый режим (--stdin): команды построчно из stdin до EOF.
+	//	Бэкенд и проверка прав - один раз на весь поток; на каждую
+	//	команду - строка ответа в stdout (сразу, с flush), чтобы
+	//	вызывающий мог держать процесс открытым и слать команды по одной.
+	//	Ответ: "<line> <code> ok|ok (no change)|ok (<warning>)|<error>", для JSON-команды -
+	//	{"id":..,"line":..,"ok":..,"code":..,"changed":..,"warning":..,"error":..}
+	//------------------------------------------------------------
+	static int runStream(const CliOptions& opt) {
+
+		std::string err;
+		BackendOptions bo;
+		auto backend = openBackend(opt, bo, err);
+		if (!backend) return fail(err);
+
+		std::string line;
+		std::size_t lineNo = 0, total = 0, failed = 0, busyCount = 0;
+		while (std::getline(std::cin, line))
+		{
+			++lineNo;
+			const std::size_t first = line.find_first_not_of(" \t\r");
+			if (first == std::string::npos || line[first] == '#') continue;
+
+			const ManifestEntry e = parseRequest(opt, line, lineNo);
+
+			//---Выполнение (некорректная строка - код 2, как у неверной командной строки)
+			const CommandResult r = e.error.empty() ? execute(e.opt, *backend) : rejected(2, e.error);
+
+			++total;
+			if (!r.ok())
+			{
+				++failed;
+				if (r.busy()) ++busyCount;
+				LOG(ERROR) << "line " << lineNo << ": " << r.error;
+			}
+			std::cout << formatReply(e, r) << "\n";
+			std::cout.flush();
+		}
+
+		LOG(INFO) << "stdin: " << total << " commands, " << failed << " failed";
+
+		//---Код выхода - как у --manifest
+		if (failed == 0) return 0;
+		return (failed == busyCount) ? kExitBusy : 1;
+	}
+	//------------------------------------------------------------
+	//	Агент (--serve=<socket>): один долгоживущий процесс, команды
+	//	от локальных клиентов через Unix-сокет в синтаксисе --stdin.
+	//	У каждого рабочего потока свой бэкенд, созданный один раз;
+	//	операции над одной службой из разных потоков упорядочивает
+	//	та же блокировка службы, что и между процессами (--lock-wait).
+	//	Права проверяются по клиенту (SO_PEERCRED), а не по агенту.
+	//------------------------------------------------------------
+	static int runServe(const CliOptions& opt) {
+
+		std::string err;
+		std::vector<std::unique_ptr<IServiceBackend>> backends;
+		for (std::uint32_t i = 0; i < opt.workers; ++i)
+		{
+			BackendOptions bo;
+			auto backend = openBackend(opt, bo, err);
+			if (!backend) return fail(err);
+			backends.push_back(std::move(backend));
+		}
+
+		std::atomic<std::size_t> total{ 0 }, failed{ 0 };
+		const bool ok = platform::serveLocal(opt.serve, backends.size(), [&](const platform::ServeRequest& rq) -> std::string {
+			const std::size_t first = rq.line.find_first_not_of(" \t");
+			if (first == std::string::npos || rq.line[first] == '#') return {};
+
+			const ManifestEntry e = parseRequest(opt, rq.line, rq.lineNo);
+
+			const CommandResult r = !rq.privileged ? rejected(1, "Administrator/root privileges required.")
+				: !e.error.empty() ? rejected(2, e.error)
+				: execute(e.opt, *backends[rq.worker]);
+
+			++total;
+			if (!r.ok())
+			{
+				++failed;
+				LOG(ERROR) << "serve: uid " << rq.uid << " pid " << rq.pid << " line " << rq.lineNo << ": " << r.error;
+			}
+			else
+			{
+				VLOG(1) << "serve: uid " << rq.uid << " pid " << rq.pid << ": " << commandName(e.opt.cmd) << " " << e.opt.name << " ok";
+			}
+			return formatReply(e, r);
+		}, &err);
+		if (!ok) return fail(err);
+
+		LOG(INFO) << "serve: " << total.load() << " commands, " << failed.load() << " failed";
+		return 0;
+	}
+	//------------------------------------------------------------
+	//	Фоновый уборщик (--reclaim=/--reclaim-dir=: из trashDir и
+	//	для отложенного удаления недоудалённых каталогов). Только
+	//	внутренний: задание без билета startReclaimer отклоняется
+	//------------------------------------------------------------
+	static int runReclaim(const CliOptions& opt) {
+
+		if (!requireAdminRoot()) return fail("Administrator/root privileges required.");
+
+		platform::ReclaimJob job;
+		job.target = opt.reclaim;
+		job.wholeDir = opt.reclaimDir;
+		job.throttle = deleteThrottle(opt);
+
+		std::string err;
+		if (!job.filter.compile(opt.dataInclude, opt.dataExclude, &err)) return fail("reclaim: invalid --data-include/--data-exclude " + err);
+		if (!platform::reclaim(job, opt.reclaimWait, &err)) return fail(err);
+		return 0;
+	}
+	//------------------------------------------------------------
+	//	Для встраивания, потока и агента: процесс живёт долго, его
+	//	выхода отложенное удаление не ждёт
+	//------------------------------------------------------------
+	CommandResult execute(const CliOptions& command, IServiceBackend& backend, Plan* plan) {
+		return executeCommand(command, backend, plan, false);
+	}
+	//------------------------------------------------------------
+	//	Оркестратор: запуск установщика службы с заданными опциями
+	//------------------------------------------------------------
+	int runInstaller(const CliOptions& opt) {
+
+		const auto started = std::chrono::steady_clock::now();
+		const process::RunTotals before = process::totals();
+		int rc;
+		if (opt.cmd == Command::Manifest) rc = runManifest(opt);
+		else if (opt.cmd == Command::Stream) rc = runStream(opt);
+		else if (opt.cmd == Command::Reconcile) rc = runReconcile(opt);
+		else if (opt.cmd == Command::Serve) rc = runServe(opt);
+		else if (opt.cmd == Command::Reclaim) rc = runReclaim(opt);
+		else rc = runCommand(opt);
+		logSpawnSummary(started, before);
+		return rc;
+	}
 }; //---namespace svcinst
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "Log.hpp"
+
+#if !defined(SVCINST_HAVE_GLOG)
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace svcinst::log {
+
+	//------------------------------------------------------------
+	//	Запись: "<I|W|E> <файл>:<строка>] <текст>"
+	//------------------------------------------------------------
+	Message::Message(Severity severity, const char* file, int line)
+		: severity_(severity)
+	{
+		const char* base = std::strrchr(file, '/');
+		const char* baseWin = std::strrchr(file, '\\');
+		if (baseWin && (!base || baseWin > base)) base = baseWin;
+		base = base ? base + 1 : file;
+
+		static const char kLetters[] = { 'I', 'W', 'E' };
+		os_ << kLetters[(int)severity_] << " " << base << ":" << line << "] ";
+	}
+	//------------------------------------------------------------
+	//	Вывод одной строкой (записи из разных потоков не перемешиваются)
+	//------------------------------------------------------------
+	Message::~Message()
+	{
+		os_ << "\n";
+		const std::string s = os_.str();
+		std::cerr.write(s.data(), (std::streamsize)s.size());
+		if (severity_ != Severity::Info) std::cerr.flush();
+	}
+	//------------------------------------------------------------
+	//	Уровень VLOG: читается из окружения один раз
+	//------------------------------------------------------------
+	int verbosity()
+	{
+		static const int v = [] {
+			const char* s = std::getenv("GLOG_v");
+			return s ? std::atoi(s) : 0;
+		}();
+		return v;
+	}
+
+};//---namespace svcinst::log
+
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+//---Журнал: glog, если библиотека собрана с ним (SVCINST_HAVE_GLOG), иначе - встроенный
+//	минимальный журнал в stderr с тем же синтаксисом LOG(INFO|WARNING|ERROR) << ... и VLOG(n) << ...
+//	Уровень VLOG в обоих случаях задаёт переменная окружения GLOG_v.
+#if defined(SVCINST_HAVE_GLOG)
+
+#include <glog/logging.h>
+
+#else
+
+#include <sstream>
+
+namespace svcinst::log {
+
+	enum class Severity { Info, Warning, Error };
+
+	//---Одна запись журнала: накапливается в потоке, выводится одной строкой в деструкторе
+	class Message final {
+	public:
+		Message(Severity severity, const char* file, int line);
+		~Message();
+		Message(const Message&) = delete;
+		Message& operator=(const Message&) = delete;
+
+		std::ostream& stream() { return os_; }
+
+	private:
+		Severity severity_;
+		std::ostringstream os_;
+	};
+
+	//---Уровень подробности VLOG (GLOG_v, по умолчанию 0)
+	int verbosity();
+
+	//---Приведение выражения с потоком к void (для VLOG в тернарном операторе)
+	struct Voidify {
+		void operator&(std::ostream&) {}
+	};
+
+};//---namespace svcinst::log
+
+#define SVCINST_LOG_SEVERITY_INFO ::svcinst::log::Severity::Info
+#define SVCINST_LOG_SEVERITY_WARNING ::svcinst::log::Severity::Warning
+#define SVCINST_LOG_SEVERITY_ERROR ::svcinst::log::Severity::Error
+
+#define LOG(severity) ::svcinst::log::Message(SVCINST_LOG_SEVERITY_##severity, __FILE__, __LINE__).stream()
+#define VLOG_IS_ON(level) (::svcinst::log::verbosity() >= (level))
+#define VLOG(level) !VLOG_IS_ON(level) ? (void)0 : ::svcinst::log::Voidify() & LOG(INFO)
+
+#endif
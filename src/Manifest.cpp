@@ -0,0 +1,341 @@
+#include "service_installer/Manifest.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <string_view>
+
+namespace svcinst {
+
+	namespace {
+		//---Ключи, действующие на весь запуск: в строке манифеста не допускаются
+		constexpr std::string_view kGlobalKeys[] = {
+			"--manifest", "--stdin", "--reconcile", "--serve", "--workers", "--reclaim", "--reclaim-dir", "--wait-for", "--root", "--backend", "--enable-via", "--durability", "--lock-wait", "--plan"
+		};
+		//------------------------------------------------------------
+		//	Ключ аргумента: часть до '='
+		//------------------------------------------------------------
+		static std::string_view keyOf(std::string_view arg)
+		{
+			const std::size_t eq = arg.find('=');
+			return (eq == std::string_view::npos) ? arg : arg.substr(0, eq);
+		}
+		//------------------------------------------------------------
+		//	Аргументы → CliOptions (общая часть обеих форм команды)
+		//------------------------------------------------------------
+		static void parseArgs(const std::vector<std::string>& args, ManifestEntry& e)
+		{
+			for (const std::string& a : args)
+			{
+				//---@файл мог бы пронести глобальные ключи мимо проверки ниже
+				if (!a.empty() && a.front() == '@')
+				{
+					e.error = "response files (" + a + ") are accepted on the command line only";
+					return;
+				}
+				for (std::string_view g : kGlobalKeys)
+				{
+					if (keyOf(a) != g) continue;
+					e.error = std::string(g) + " applies to the whole run; pass it on the command line";
+					return;
+				}
+			}
+
+			e.opt = parceCli(args);
+
+			if (e.opt.cmd == Command::Help) e.error = "no command (--install|--uninstall|--start|--stop|--status)";
+			else if (e.opt.cmd == Command::Invalid) e.error = e.opt.error.empty() ? "invalid options" : e.opt.error;
+			else if (e.opt.name.empty() && e.opt.group.empty()) e.error = "missing required option: --name=<service_name>";
+		}
+		//------------------------------------------------------------
+		//	Минимальный разбор плоского JSON-объекта команды:
+		//	значения - строки, true/false/null и числа
+		//------------------------------------------------------------
+		class JsonCommandReader {
+		public:
+			explicit JsonCommandReader(const std::string& s) : s_(s) {}
+
+			bool read(std::vector<std::string>& args, std::string& id, std::string& error)
+			{
+				ws();
+				if (!eat('{')) return fail(error, "expected '{'");
+				ws();
+				if (eat('}')) return tail(error);
+				for (;;)
+				{
+					std::string key;
+					ws();
+					if (!string(key)) return fail(error, "expected \"key\"");
+					ws();
+					if (!eat(':')) return fail(error, "expected ':'");
+					ws();
+
+					const std::size_t from = i_;
+					std::string value;
+					bool present = true, isTrue = false;
+					if (peek() == '"')
+					{
+						if (!string(value)) return fail(error, "bad string value for \"" + key + "\"");
+					}
+					else if (word("true")) isTrue = true;
+					else if (word("false") || word("null")) present = false;
+					else if (!number(value)) return fail(error, "unsupported value for \"" + key + "\" (only strings, numbers, true/false/null)");
+
+					if (key == "id") id = s_.substr(from, i_ - from);
+					else if (key == "cmd")
+					{
+						if (!present || value.empty()) return fail(error, "\"cmd\" must be a non-empty string");
+						args.push_back("--" + value);
+					}
+					else if (present)
+					{
+						args.push_back(isTrue ? "--" + key : "--" + key + "=" + value);
+					}
+
+					ws();
+					if (eat(',')) continue;
+					if (eat('}')) return tail(error);
+					return fail(error, "expected ',' or '}'");
+				}
+			}
+
+		private:
+			char peek() const { return i_ < s_.size() ? s_[i_] : '\0'; }
+			bool eat(char c) { if (peek() != c) return false; ++i_; return true; }
+			void ws() { while (i_ < s_.size() && (s_[i_] == ' ' || s_[i_] == '\t' || s_[i_] == '\r' || s_[i_] == '\n')) ++i_; }
+			bool word(std::string_view w)
+			{
+				if (s_.compare(i_, w.size(), w) != 0) return false;
+				i_ += w.size();
+				return true;
+			}
+			bool fail(std::string& error, const std::string& what)
+			{
+				error = "json: " + what + " at offset " + std::to_string(i_);
+				return false;
+			}
+			bool tail(std::string& error)
+			{
+				ws();
+				return (i_ == s_.size()) || fail(error, "trailing characters after '}'");
+			}
+			bool number(std::string& out)
+			{
+				const std::size_t from = i_;
+				if (peek() == '-') ++i_;
+				while (i_ < s_.size() && ((s_[i_] >= '0' && s_[i_] <= '9') || s_[i_] == '.' || s_[i_] == 'e' || s_[i_] == 'E' || s_[i_] == '+' || s_[i_] == '-')) ++i_;
+				out = s_.substr(from, i_ - from);
+				return i_ > from && out != "-";
+			}
+			static void utf8(std::string& out, std::uint32_t cp)
+			{
+				if (cp < 0x80) out.push_back(char(cp));
+				else if (cp < 0x800) { out.push_back(char(0xC0 | (cp >> 6))); out.push_back(char(0x80 | (cp & 0x3F))); }
+				else if (cp < 0x10000) { out.push_back(char(0xE0 | (cp >> 12))); out.push_back(char(0x80 | ((cp >> 6) & 0x3F))); out.push_back(char(0x80 | (cp & 0x3F))); }
+				else { out.push_back(char(0xF0 | (cp >> 18))); out.push_back(char(0x80 | ((cp >> 12) & 0x3F))); out.push_back(char(0x80 | ((cp >> 6) & 0x3F))); out.push_back(char(0x80 | (cp & 0x3F))); }
+			}
+			bool hex4(std::uint32_t& v)
+			{
+				if (i_ + 4 > s_.size()) return false;
+				v = 0;
+				for (int k = 0; k < 4; ++k)
+				{
+					const char c = s_[i_++];
+					v <<= 4;
+					if (c >= '0' && c <= '9') v |= std::uint32_t(c - '0');
+					else if (c >= 'a' && c <= 'f') v |= std::uint32_t(c - 'a' + 10);
+					else if (c >= 'A' && c <= 'F') v |= std::uint32_t(c - 'A' + 10);
+					else return false;
+				}
+				return true;
+			}
+			bool string(std::string& out)
+			{
+				if (!eat('"')) return false;
+				out.clear();
+				while (i_ < s_.size())
+				{
+					const char c = s_[i_++];
+					if (c == '"') return true;
+					if ((unsigned char)c < 0x20) return false;
+					if (c != '\\') { out.push_back(c); continue; }
+					if (i_ >= s_.size()) return false;
+					switch (s_[i_++])
+					{
+					case '"': out.push_back('"'); break;
+					case '\\': out.push_back('\\'); break;
+					case '/': out.push_back('/'); break;
+					case 'b': out.push_back('\b'); break;
+					case 'f': out.push_back('\f'); break;
+					case 'n': out.push_back('\n'); break;
+					case 'r': out.push_back('\r'); break;
+					case 't': out.push_back('\t'); break;
+					case 'u':
+					{
+						std::uint32_t cp = 0;
+						if (!hex4(cp)) return false;
+						//---Суррогатная пара UTF-16
+						if (cp >= 0xD800 && cp <= 0xDBFF)
+						{
+							std::uint32_t lo = 0;
+							if (!word("\\u") || !hex4(lo) || lo < 0xDC00 || lo > 0xDFFF) return false;
+							cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+						}
+						else if (cp >= 0xDC00 && cp <= 0xDFFF) return false;
+						utf8(out, cp);
+						break;
+					}
+					default: return false;
+					}
+				}
+				return false;
+			}
+
+		private:
+			const std::string& s_;
+			std::size_t i_ = 0;
+		};
+	} // namespace
+
+	//------------------------------------------------------------
+	//	Разбор одной команды (CLI-синтаксис или JSON-объект)
+	//------------------------------------------------------------
+	void parseCommand(const std::string& line, ManifestEntry& e)
+	{
+		std::vector<std::string> args;
+		const std::size_t first = line.find_first_not_of(" \t");
+		e.json = (first != std::string::npos && line[first] == '{');
+
+		if (e.json)
+		{
+			if (!JsonCommandReader(line).read(args, e.id, e.error)) return;
+		}
+		else if (!splitCommandLine(line, args, &e.error)) return;
+
+		parseArgs(args, e);
+	}
+	//------------------------------------------------------------
+	//	Экранирование строки для JSON
+	//------------------------------------------------------------
+	std::string jsonEscape(const std::string& s)
+	{
+		std::string out;
+		out.reserve(s.size() + 8);
+		for (char c : s)
+		{
+			switch (c)
+			{
+			case '"': out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\n': out += "\\n"; break;
+			case '\r': out += "\\r"; break;
+			case '\t': out += "\\t"; break;
+			default:
+				if ((unsigned char)c < 0x20)
+				{
+					static const char* hex = "0123456789abcdef";
+					out += "\\u00";
+					out.push_back(hex[(c >> 4) & 0xF]);
+					out.push_back(hex[c & 0xF]);
+				}
+				else out.push_back(c);
+			}
+		}
+		return out;
+	}
+	//------------------------------------------------------------
+	//	Разбиение строки на аргументы
+	//------------------------------------------------------------
+	bool splitCommandLine(const std::string& line, std::vector<std::string>& out, std::string* error)
+	{
+		out.clear();
+		std::string cur;
+		bool inArg = false;
+		char quote = 0;
+
+		for (std::size_t i = 0; i < line.size(); ++i)
+		{
+			const char c = line[i];
+
+			//---\ перед кавычкой или пробелом - буквальный символ, иначе сам '\' буквальный
+			if (c == '\\' && i + 1 < line.size())
+			{
+				const char n = line[i + 1];
+				const bool escapable = (n == '"' || n == '\'' || (!quote && (n == ' ' || n == '\t')));
+				if (escapable && (quote != '\'' || n == '\''))
+				{
+					cur.push_back(n);
+					inArg = true;
+					++i;
+					continue;
+				}
+			}
+			if (quote)
+			{
+				if (c == quote) quote = 0;
+				else cur.push_back(c);
+				continue;
+			}
+			if (c == '"' || c == '\'')
+			{
+				quote = c;
+				inArg = true;
+				continue;
+			}
+			if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+			{
+				if (inArg) out.push_back(std::move(cur));
+				cur.clear();
+				inArg = false;
+				continue;
+			}
+			cur.push_back(c);
+			inArg = true;
+		}
+
+		if (quote)
+		{
+			if (error) *error = std::string("unterminated ") + quote + " quote";
+			return false;
+		}
+		if (inArg) out.push_back(std::move(cur));
+		return true;
+	}
+	//------------------------------------------------------------
+	//	Чтение манифеста
+	//------------------------------------------------------------
+	bool loadManifest(const fs::path& file, std::vector<ManifestEntry>& out, std::string* error)
+	{
+		out.clear();
+		std::ifstream in(file, std::ios::binary);
+		if (!in)
+		{
+			if (error) *error = "cannot open manifest: " + file.string();
+			return false;
+		}
+
+		std::string line;
+		std::size_t lineNo = 0;
+		while (std::getline(in, line))
+		{
+			++lineNo;
+
+			//---UTF-8 BOM в начале файла (манифесты из Windows-редакторов)
+			if (lineNo == 1 && line.compare(0, 3, "\xEF\xBB\xBF") == 0) line.erase(0, 3);
+
+			//---Пустые строки и комментарии
+			const std::size_t first = line.find_first_not_of(" \t\r");
+			if (first == std::string::npos || line[first] == '#') continue;
+
+			ManifestEntry e;
+			e.line = lineNo;
+			parseCommand(line, e);
+			out.push_back(std::move(e));
+		}
+		if (in.bad())
+		{
+			if (error) *error = "error reading manifest: " + file.string();
+			return false;
+		}
+		return true;
+	}
+};//---namespace svcinst
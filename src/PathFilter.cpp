@@ -0,0 +1,359 @@
+#include "PathFilter.hpp"
+
+#include <bit>
+#include <cstddef>
+
+namespace svcinst {
+
+	namespace {
+		constexpr std::size_t kMaxSegments = 63;	//	Позиции 0..63 - биты одного слова
+
+		//------------------------------------------------------------
+		//	Сравнение символов имени (Windows: без учёта регистра ASCII,
+		//	как и сама файловая система)
+		//------------------------------------------------------------
+		static bool sameChar(char a, char b)
+		{
+#ifdef _WIN32
+			if (a >= 'A' && a <= 'Z') a = char(a - 'A' + 'a');
+			if (b >= 'A' && b <= 'Z') b = char(b - 'A' + 'a');
+#endif
+			return a == b;
+		}
+		//------------------------------------------------------------
+		//	Имя против литерального сегмента
+		//------------------------------------------------------------
+		static bool sameName(std::string_view a, std::string_view b)
+		{
+			if (a.size() != b.size()) return false;
+			for (std::size_t i = 0; i < a.size(); ++i)
+			{
+				if (!sameChar(a[i], b[i])) return false;
+			}
+			return true;
+		}
+		//------------------------------------------------------------
+		//	Класс символов [..] с позиции i (p[i] == '['); i - за ']'
+		//------------------------------------------------------------
+		static bool matchClass(std::string_view p, std::size_t& i, char c)
+		{
+			++i;
+			bool negate = false;
+			if (i < p.size() && (p[i] == '!' || p[i] == '^'))
+			{
+				negate = true;
+				++i;
+			}
+			bool hit = false;
+			for (bool first = true; i < p.size() && (p[i] != ']' || first); first = false)
+			{
+				char lo = p[i++];
+				if (lo == '\\' && i < p.size()) lo = p[i++];
+				if (i + 1 < p.size() && p[i] == '-' && p[i + 1] != ']')
+				{
+					char hi = p[i + 1];
+					i += 2;
+					if (hi == '\\' && i < p.size()) hi = p[i++];
+					if (std::uint8_t(c) >= std::uint8_t(lo) && std::uint8_t(c) <= std::uint8_t(hi)) hit = true;
+				}
+				else if (sameChar(lo, c))
+				{
+					hit = true;
+				}
+			}
+			++i;
+			return hit != negate;
+		}
+		//------------------------------------------------------------
+		//	Имя против glob-сегмента: '*' с возвратом к последней
+		//	звёздочке (линейно для типичных шаблонов, без рекурсии)
+		//------------------------------------------------------------
+		static bool matchGlob(std::string_view p, std::string_view s)
+		{
+			std::size_t pi = 0, si = 0;
+			std::size_t starP = std::string_view::npos, starS = 0;
+			while (si < s.size())
+			{
+				if (pi < p.size())
+				{
+					const char c = p[pi];
+					if (c == '*')
+					{
+						starP = ++pi;
+						starS = si;
+						continue;
+					}
+					if (c == '?')
+					{
+						++pi;
+						++si;
+						continue;
+					}
+					std::size_t next = pi;
+					const bool hit = (c == '[') ? matchClass(p, next, s[si])
+						: (c == '\\') ? (next += 2, sameChar(p[pi + 1], s[si]))
+						: (next += 1, sameChar(c, s[si]));
+					if (hit)
+					{
+						pi = next;
+						++si;
+						continue;
+					}
+				}
+				if (starP == std::string_view::npos) return false;
+				pi = starP;
+				si = ++starS;
+			}
+			while (pi < p.size() && p[pi] == '*') ++pi;
+			return pi == p.size();
+		}
+		//------------------------------------------------------------
+		//	Сегмент шаблона: проверка синтаксиса и вид (без '*?[' -
+		//	литерал, сравнивается целиком)
+		//------------------------------------------------------------
+		static bool parseSegment(std::string_view text, std::string& literal, bool& glob, std::string* why)
+		{
+			literal.clear();
+			glob = false;
+			for (std::size_t i = 0; i < text.size(); ++i)
+			{
+				const char c = text[i];
+				if (c == '\\')
+				{
+					if (++i == text.size())
+					{
+						if (why) *why = "trailing '\\'";
+						return false;
+					}
+					literal += text[i];
+				}
+				else if (c == '*' || c == '?')
+				{
+					glob = true;
+				}
+				else if (c == '[')
+				{
+					std::size_t j = i + 1;
+					if (j < text.size() && (text[j] == '!' || text[j] == '^')) ++j;
+					if (j < text.size() && text[j] == ']') ++j;
+					while (j < text.size() && text[j] != ']') j += (text[j] == '\\') ? 2 : 1;
+					if (j >= text.size())
+					{
+						if (why) *why = "unterminated '['";
+						return false;
+					}
+					glob = true;
+					i = j;
+				}
+				else
+				{
+					literal += c;
+				}
+			}
+			return true;
+		}
+		//------------------------------------------------------------
+		//	Замыкание по '**': позиция перед '**' даёт и позицию за
+		//	ним (ноль уровней)
+		//------------------------------------------------------------
+		static std::uint64_t closeAnyDirs(std::uint64_t bits, std::uint64_t anyDirs)
+		{
+			for (;;)
+			{
+				const std::uint64_t next = bits | ((bits & anyDirs) << 1);
+				if (next == bits) return bits;
+				bits = next;
+			}
+		}
+	} // namespace
+
+	//------------------------------------------------------------
+	//	Разбор шаблона в сегменты
+	//------------------------------------------------------------
+	bool PathFilter::Set::add(const std::string& text, std::string* error)
+	{
+		const auto fail = [&](const std::string& why) {
+			if (error) *error = "pattern '" + text + "': " + why;
+			return false;
+		};
+
+		std::string_view s = text;
+		bool anchored = false;
+		while (!s.empty() && s.front() == '/')
+		{
+			s.remove_prefix(1);
+			anchored = true;
+		}
+		Pattern p;
+		while (!s.empty() && s.back() == '/')
+		{
+			s.remove_suffix(1);
+			p.dirOnly = true;
+		}
+
+		//---Сегменты; "." и пустые пропускаются, ".." вывел бы за пределы каталога
+		std::vector<std::string_view> parts;
+		for (std::size_t pos = 0; pos <= s.size();)
+		{
+			std::size_t slash = s.find('/', pos);
+			if (slash == std::string_view::npos) slash = s.size();
+			const std::string_view part = s.substr(pos, slash - pos);
+			pos = slash + 1;
+			if (part.empty() || part == ".") continue;
+			if (part == "..") return fail("'..' is not allowed");
+			parts.push_back(part);
+		}
+		if (parts.empty()) return fail("matches no entry (empty pattern)");
+		if (parts.size() > 1) anchored = true;
+		if (!anchored) parts.insert(parts.begin(), "**");
+
+		for (std::string_view part : parts)
+		{
+			Segment seg;
+			if (part == "**")
+			{
+				if (!p.segs.empty() && p.segs.back().kind == Segment::Kind::AnyDirs) continue;
+				seg.kind = Segment::Kind::AnyDirs;
+			}
+			else
+			{
+				bool glob = false;
+				std::string why;
+				if (!parseSegment(part, seg.text, glob, &why)) return fail(why);
+				if (glob)
+				{
+					seg.kind = Segment::Kind::Glob;
+					seg.text = std::string(part);
+				}
+			}
+			p.segs.push_back(std::move(seg));
+		}
+		if (p.segs.size() > kMaxSegments) return fail("more than " + std::to_string(kMaxSegments) + " path segments");
+		for (std::size_t i = 0; i < p.segs.size(); ++i)
+		{
+			if (p.segs[i].kind == Segment::Kind::AnyDirs) p.anyDirs |= std::uint64_t(1) << i;
+		}
+
+		patterns.push_back(std::move(p));
+		source.push_back(text);
+		return true;
+	}
+	//------------------------------------------------------------
+	//	Начальные позиции: ничего не пройдено
+	//------------------------------------------------------------
+	std::vector<std::uint64_t> PathFilter::Set::start() const
+	{
+		std::vector<std::uint64_t> bits;
+		bits.reserve(patterns.size());
+		for (const Pattern& p : patterns) bits.push_back(closeAnyDirs(1, p.anyDirs));
+		return bits;
+	}
+	//------------------------------------------------------------
+	//	Шаг по одному имени для всех шаблонов набора
+	//------------------------------------------------------------
+	bool PathFilter::Set::step(const std::vector<std::uint64_t>& from, std::string_view name, bool isDir, std::vector<std::uint64_t>* to) const
+	{
+		if (to) to->assign(patterns.size(), 0);
+		bool matched = false;
+		bool alive = false;
+		for (std::size_t i = 0; i < patterns.size(); ++i)
+		{
+			const Pattern& p = patterns[i];
+			const std::size_t end = p.segs.size();
+			std::uint64_t next = 0;
+			for (std::uint64_t bits = from[i]; bits != 0; bits &= bits - 1)
+			{
+				const std::size_t pos = std::size_t(std::countr_zero(bits));
+				if (pos >= end) continue;
+				const Segment& seg = p.segs[pos];
+				switch (seg.kind)
+				{
+				case Segment::Kind::AnyDirs:
+					next |= std::uint64_t(1) << pos;		//	'**' поглощает имя и остаётся
+					break;
+				case Segment::Kind::Literal:
+					if (sameName(seg.text, name)) next |= std::uint64_t(1) << (pos + 1);
+					break;
+				case Segment::Kind::Glob:
+					if (matchGlob(seg.text, name)) next |= std::uint64_t(1) << (pos + 1);
+					break;
+				}
+			}
+			next = closeAnyDirs(next, p.anyDirs);
+
+			const std::uint64_t endBit = std::uint64_t(1) << end;
+			if ((next & endBit) && (isDir || !p.dirOnly))
+			{
+				matched = true;
+				if (!to) return true;
+			}
+			next &= endBit - 1;
+			if (to && isDir && next)
+			{
+				(*to)[i] = next;
+				alive = true;
+			}
+		}
+		if (to && !alive) to->clear();
+		return matched;
+	}
+	//------------------------------------------------------------
+	//	Компиляция шаблонов
+	//------------------------------------------------------------
+	bool PathFilter::compile(const std::vector<std::string>& include, const std::vector<std::string>& exclude, std::string* error)
+	{
+		include_ = {};
+		exclude_ = {};
+		for (const std::string& s : include)
+		{
+			if (!include_.add(s, error)) return false;
+		}
+		for (const std::string& s : exclude)
+		{
+			if (!exclude_.add(s, error)) return false;
+		}
+		return true;
+	}
+	//------------------------------------------------------------
+	//	Курсор корня
+	//------------------------------------------------------------
+	PathFilter::Cursor PathFilter::root() const
+	{
+		Cursor c;
+		c.selected = include_.patterns.empty();
+		if (!c.selected) c.include = include_.start();
+		if (!exclude_.patterns.empty()) c.exclude = exclude_.start();
+		return c;
+	}
+	//------------------------------------------------------------
+	//	Решение по записи каталога
+	//------------------------------------------------------------
+	PathFilter::Action PathFilter::visit(const Cursor& dir, std::string_view name, bool isDir, Cursor& child) const
+	{
+		//---Исключённое не удаляется вместе со всем, что под ним
+		child.exclude.clear();
+		if (!dir.exclude.empty() && exclude_.step(dir.exclude, name, isDir, isDir ? &child.exclude : nullptr)) return Action::Keep;
+
+		//---Не выбранный каталог: запись выбирается совпадением include; каталог, под которым
+		//   include уже не совпадёт, не читается
+		bool selected = dir.selected;
+		child.include.clear();
+		if (!selected)
+		{
+			if (include_.step(dir.include, name, isDir, isDir ? &child.include : nullptr))
+			{
+				selected = true;
+				child.include.clear();
+			}
+			else if (!isDir || child.include.empty())
+			{
+				return Action::Keep;
+			}
+		}
+
+		if (!isDir || (selected && child.exclude.empty())) return Action::Remove;
+		child.selected = selected;
+		return Action::Descend;
+	}
+
+};//---namespace svcinst
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace svcinst {
+
+	//---Выборочное удаление каталога (--data-include/--data-exclude): glob-шаблоны путей
+	//	относительно его корня. Синтаксис: '*' и '?' - внутри имени, [abc], [a-z], [!x],
+	//	'\' экранирует, '**' - любое число уровней; шаблон без '/' - имя на любой глубине,
+	//	с '/' - путь от корня; '/' в конце - только каталоги.
+	//	Шаблоны компилируются один раз; обход передаёт каждому каталогу курсор - позиции
+	//	шаблонов, ещё способных совпасть ниже. Каталог, под которым не совпадёт ни один
+	//	include и который целиком исключён, пропускается без чтения.
+	class PathFilter final {
+	public:
+		//---Что делать с записью каталога
+		enum class Action : std::uint8_t {
+			Keep,		//	Оставить (исключена или не выбрана); в каталог не заходить
+			Remove,		//	Удалить целиком: файл или поддерево, где фильтр уже ничего не оставит
+			Descend		//	Каталог: зайти с курсором потомка
+		};
+
+		//---Состояние обхода в каталоге: по слову на шаблон, бит - пройденные сегменты
+		struct Cursor {
+			bool selected = true;					//	Каталог выбран: удаляется, если внутри ничего не оставлено
+			std::vector<std::uint64_t> include;		//	Пусто - include уже не нужен (выбран или шаблонов нет)
+			std::vector<std::uint64_t> exclude;		//	Пусто - ниже ничего не исключается
+		};
+
+		//---Компиляция шаблонов; false + error - неверный шаблон
+		bool compile(const std::vector<std::string>& include, const std::vector<std::string>& exclude, std::string* error);
+
+		//---Есть шаблоны: без них каталог удаляется целиком
+		bool active() const { return !include_.patterns.empty() || !exclude_.patterns.empty(); }
+		const std::vector<std::string>& includePatterns() const { return include_.source; }
+		const std::vector<std::string>& excludePatterns() const { return exclude_.source; }
+
+		//---Курсор корня удаляемого каталога (сам корень выбран, только если include пуст)
+		Cursor root() const;
+		//---Решение по записи name каталога с курсором dir; Descend - курсор потомка в child
+		Action visit(const Cursor& dir, std::string_view name, bool isDir, Cursor& child) const;
+
+	private:
+		struct Segment {
+			enum class Kind : std::uint8_t { Literal, Glob, AnyDirs } kind = Kind::Literal;
+			std::string text;				//	Literal - имя без экранирования, Glob - шаблон
+		};
+		struct Pattern {
+			std::vector<Segment> segs;		//	Не больше 63: позиции 0..size() - биты слова
+			std::uint64_t anyDirs = 0;		//	Биты позиций сегментов '**'
+			bool dirOnly = false;
+		};
+		struct Set {
+			std::vector<Pattern> patterns;
+			std::vector<std::string> source;
+
+			bool add(const std::string& text, std::string* error);
+			std::vector<std::uint64_t> start() const;
+			//---Шаг по имени: true - какой-то шаблон совпал целиком; to - позиции для потомков
+			//	(пусто, если ни один шаблон ниже уже не совпадёт); to == nullptr - только совпадение
+			bool step(const std::vector<std::uint64_t>& from, std::string_view name, bool isDir, std::vector<std::uint64_t>* to) const;
+		};
+
+		Set include_;
+		Set exclude_;
+	};
+
+};//---namespace svcinst
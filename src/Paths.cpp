@@ -40,4 +40,16 @@ namespace svcinst {
 		}
 		return p;
 	}
+	//------------------------------------------------------------
+	//	Определение пути к исполняемому файлу службы внутри 
+	//	альтернативного корня (offline-режим --root)
+	//------------------------------------------------------------
+	fs::path resolveServiceExePath(const std::string& exeArg, const fs::path& root) {
+
+		if (root.empty()) return resolveServiceExePath(exeArg);
+		if (exeArg.empty()) return {};
+
+		//---selfDir установщика к образу отношения не имеет: относительный путь - от корня образа
+		return (fs::path("/") / fs::path(exeArg).relative_path()).lexically_normal();
+	}
 } // namespace svcinst
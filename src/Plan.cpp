@@ -0,0 +1,61 @@
+#include "service_installer/Plan.hpp"
+
+#include <cstdio>
+#include <iomanip>
+
+namespace svcinst {
+
+	namespace {
+		//------------------------------------------------------------
+		//	Объём в человекочитаемом виде (B, KiB, MiB, GiB, TiB)
+		//------------------------------------------------------------
+		static std::string humanBytes(std::uint64_t n)
+		{
+			static const char* const units[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+			double v = (double)n;
+			int u = 0;
+			while (v >= 1024.0 && u < 4) { v /= 1024.0; ++u; }
+
+			char buf[32];
+			if (u == 0) std::snprintf(buf, sizeof(buf), "%llu B", (unsigned long long)n);
+			else std::snprintf(buf, sizeof(buf), "%.1f %s", v, units[u]);
+			return buf;
+		}
+	} // namespace
+
+	//------------------------------------------------------------
+	//	Вывод плана
+	//------------------------------------------------------------
+	void Plan::print(std::ostream& os) const
+	{
+		std::uint64_t written = 0, calls = 0, dirs = 0, dirFiles = 0, dirBytes = 0;
+		for (const PlanStep& s : steps_)
+		{
+			if (s.action == "write") written += s.bytes;
+			else if (s.action == "systemctl" || s.action == "sc") ++calls;
+			else if (s.action == "remove-dir")
+			{
+				++dirs;
+				dirFiles += s.files;
+				dirBytes += s.bytes;
+			}
+		}
+
+		os << "plan: " << steps_.size() << " step(s), " << humanBytes(written) << " to write, "
+			<< calls << " service manager call(s)";
+		if (dirs) os << ", " << dirs << " dir(s) to remove (" << dirFiles << " files, " << humanBytes(dirBytes) << ")";
+		os << "\n";
+
+		std::size_t no = 0;
+		for (const PlanStep& s : steps_)
+		{
+			os << "  " << std::right << std::setw(3) << ++no << ". " << std::left << std::setw(10) << s.action << " " << s.target;
+			if (s.action == "remove-dir") os << "  (" << s.files << " files, " << humanBytes(s.bytes) << ")";
+			else if (s.bytes) os << "  (" << humanBytes(s.bytes) << ")";
+			if (!s.note.empty()) os << "  [" << s.note << "]";
+			os << "\n";
+		}
+		if (steps_.empty()) os << "  nothing to do\n";
+	}
+
+};//---namespace svcinst
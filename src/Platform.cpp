@@ -12,7 +12,7 @@ namespace svcinst {
 	//------------------------------------------------------------
 	//	Создание бэкенда для текущей платформы
 	//------------------------------------------------------------
-	std::unique_ptr<IServiceBackend> makeBackend() {
-		return platform::makeBackend();
+	std::unique_ptr<IServiceBackend> makeBackend(const BackendOptions& opt) {
+		return platform::makeBackend(opt);
 	}
 }; //---namespace svcinst
\ No newline at end of file
@@ -1,7 +1,31 @@
 #include "service_installer/Process.hpp"
 #include "platform/ProcessImpl.hpp"
 
+#include <algorithm>
+#include <mutex>
+
 namespace svcinst::process {
+
+    namespace {
+        //---Накопитель статистики по всем запущенным потомкам
+        std::mutex g_totalsMutex;
+        RunTotals g_totals;
+
+        void account(const RunResult& r)
+        {
+            if (!r.started) return;
+
+            std::lock_guard<std::mutex> lock(g_totalsMutex);
+            g_totals.count++;
+            g_totals.sum.wallUs += r.stats.wallUs;
+            g_totals.sum.userCpuUs += r.stats.userCpuUs;
+            g_totals.sum.sysCpuUs += r.stats.sysCpuUs;
+            g_totals.sum.maxRssKb = std::max(g_totals.sum.maxRssKb, r.stats.maxRssKb);
+            g_totals.sum.volCtxSwitches += r.stats.volCtxSwitches;
+            g_totals.sum.involCtxSwitches += r.stats.involCtxSwitches;
+        }
+    } // namespace
+
 //------------------------------------------------------------
 // Реализация публичной функции запуска процесса
 // Выступает в качестве оболочки для платформенно-специфичной реализации
@@ -20,6 +44,59 @@ namespace svcinst::process {
     bool run(const fs::path& exe, const std::vector<std::string>& args,
         RunResult& out, const RunOptions& opt)
     {
-        return detail::runPlatform(exe, args, out, opt);
+        const bool ok = detail::runPlatform(exe, args, out, opt);
+        account(out);
+        return ok;
+    }
+//------------------------------------------------------------
+// Снимок суммарной статистики потомков
+//------------------------------------------------------------
+    RunTotals totals()
+    {
+        std::lock_guard<std::mutex> lock(g_totalsMutex);
+        return g_totals;
+    }
+//------------------------------------------------------------
+// AsyncRunner - тонкая оболочка над платформенным detail::AsyncEngine
+//------------------------------------------------------------
+    AsyncRunner::AsyncRunner()
+        : engine_(detail::makeAsyncEngine())
+    {
+    }
+
+    AsyncRunner::~AsyncRunner() = default;
+
+    bool AsyncRunner::spawn(const fs::path& exe, const std::vector<std::string>& args,
+        const RunOptions& opt, RunCallback cb)
+    {
+        return engine_->spawn(exe, args, opt, [cb = std::move(cb)](RunResult& r) {
+            account(r);
+            if (cb) cb(r);
+        });
+    }
+
+    RunAwaitable AsyncRunner::runAsync(fs::path exe, std::vector<std::string> args, RunOptions opt)
+    {
+        return RunAwaitable(*this, std::move(exe), std::move(args), std::move(opt));
+    }
+
+    RunAwaitable AsyncRunner::runAsync(fs::path exe, std::vector<std::string> args)
+    {
+        return runAsync(std::move(exe), std::move(args), RunOptions{});
+    }
+
+    void AsyncRunner::run()
+    {
+        while (engine_->poll(-1)) {}
+    }
+
+    bool AsyncRunner::runOnce(int timeoutMs)
+    {
+        return engine_->poll(timeoutMs);
+    }
+
+    std::size_t AsyncRunner::pending() const
+    {
+        return engine_->pending();
     }
 } // namespace svcinst::process
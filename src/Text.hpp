@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+
+namespace svcinst {
+
+	//---Многострочный текст (stderr systemctl, текст ошибки) в одну строку для сообщения или
+	//	построчного ответа: строки через "; ", '\r' выбрасывается; truncated - вывод был обрезан
+	inline std::string oneLine(const std::string& s, bool truncated = false)
+	{
+		std::string out;
+		out.reserve(s.size());
+		for (char c : s)
+		{
+			if (c == '\r') continue;
+			if (c == '\n')
+			{
+				if (!out.empty() && out.back() != ' ') out += "; ";
+				continue;
+			}
+			out.push_back(c);
+		}
+		while (!out.empty() && (out.back() == ' ' || out.back() == ';')) out.pop_back();
+		if (truncated) out += " ...";
+		return out;
+	}
+
+};//---namespace svcinst
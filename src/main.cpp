@@ -10,6 +10,7 @@ int main(int argc, char** argv) {
 	//---Если запрошена справка или команда некорректна → вывод справки и выход
 	if (opt.cmd == svcinst::Command::Help || opt.cmd == svcinst::Command::Invalid) 
 	{
+		if (!opt.error.empty()) std::cerr << "error: " << opt.error << "\n\n";
 		svcinst::printHelp(std::cout);
 		return (opt.cmd == svcinst::Command::Invalid) ? 2 : 0;
 	}
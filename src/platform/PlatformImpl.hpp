@@ -1,11 +1,15 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <memory>
+#include <string>
 
-namespace svcinst {
+#include "service_installer/Platform.hpp"
+#include "PathFilter.hpp"
 
-	//---Интерфейс бэкэнда установки службы
-	class IServiceBackend;
+namespace svcinst {
 
 	//---Платформенно-зависимые реализации
 	namespace platform {
@@ -17,11 +21,82 @@ namespace svcinst {
 		//---Проверка, что процесс запущен с правами администратора / root
 		bool isElevated();
 		//---Cоздание бэкенда для текущей платформы
-		std::unique_ptr<IServiceBackend> makeBackend();
+		std::unique_ptr<IServiceBackend> makeBackend(const BackendOptions& opt);
+		//---Щадящее удаление (--throttle, Linux): idle-класс I/O и nice 19, лимиты скорости,
+		//   пауза при давлении на диск (PSI /proc/pressure/io)
+		struct DeleteThrottle final {
+			bool enabled = false;
+			std::uint32_t unlinksPerSec = 0;	//	Лимит unlink/rmdir в секунду, 0 - нет
+			std::uint64_t bytesPerSec = 0;		//	Лимит объёма удаляемых файлов в секунду, 0 - нет
+		};
+		//---Отложенное удаление: на месте удалить не удалось (занятые файлы), остаток дочищается в фоне
+		struct DeferredRemove final {
+			bool untilExit = true;		//	Вход: ждать выхода нашего процесса (разовый запуск); false - начать
+										//	через kDeferDelayMs (агент/поток: их выхода можно ждать сутками)
+			bool deferred = false;		//	Выход: удаление отложено (true вместе с успехом removeXxx)
+			fs::path statusFile;		//	Выход: файл состояния уборщика (Linux)
+		};
+		constexpr std::uint32_t kDeferDelayMs = 5000;
 		//---Удалить папку установки (fromInno: Windows-only смысл (если true — installDir не трогаем))
-		bool removeInstallDir(const fs::path& installDir, std::string* error, bool fromInno = false);
-		//---Удалить DataRoot (данные/кэш/сигналы и т.п.)
-		bool removeDataRoot(const fs::path& dataRoot, std::string* error);
+		bool removeInstallDir(const fs::path& installDir, std::string* error, bool fromInno = false, const DeleteThrottle& throttle = {},
+			DeferredRemove* defer = nullptr);
+		//---Удалить DataRoot (данные/кэш/сигналы и т.п.); filter - только выбранное шаблонами
+		//   (--data-include/--data-exclude), сам DataRoot остаётся, если в нём что-то оставлено
+		bool removeDataRoot(const fs::path& dataRoot, std::string* error, const DeleteThrottle& throttle = {}, const PathFilter* filter = nullptr,
+			DeferredRemove* defer = nullptr);
+		//---Оценка удаления каталога для --plan (ничего не удаляет): число файлов и байт под dir
+		//   (с filter - только выбранных); false + error - удалять каталог отказались бы (опасный путь);
+		//   нет каталога - 0 файлов
+		bool estimateRemoveDir(const fs::path& dir, std::uint64_t& files, std::uint64_t& bytes, std::string* error, const PathFilter* filter = nullptr);
+		//---Мгновенное удаление (--trash): dir переносится rename'ом в корзину своей файловой системы
+		//   (<корень ФС>/.svcinst-trash, 0700), trash - эта корзина; нет dir - true и пустой trash.
+		//   false + error - перенос невозможен (точка монтирования, другая ФС, Windows): удалять на месте
+		bool moveToTrash(const fs::path& dir, fs::path& trash, std::string* error);
+		//---Задание фонового уборщика
+		struct ReclaimJob final {
+			fs::path target;			//	Корзина (очищается содержимое) или каталог (wholeDir)
+			bool wholeDir = false;		//	Удалить сам target: отложенное удаление недоудалённого каталога
+			bool afterExit = false;		//	Начать сразу после выхода запустившего процесса (ожидание по pidfd)
+			std::uint32_t delayMs = 0;	//	Без afterExit: начать через delayMs
+			DeleteThrottle throttle;
+			PathFilter filter;			//	wholeDir: выборочное удаление (шаблоны передаются уборщику)
+		};
+		//---Запуск уборщика: отдельный процесс-демон (setsid, двойной fork; --reclaim=/--reclaim-dir=),
+		//   не ждём его. statusFile - файл состояния, который он ведёт (/run/svcinst/reclaim/<путь>.status:
+		//   state=waiting|running|done|failed, files, dirs, bytes, kept, error)
+		bool startReclaimer(const ReclaimJob& job, fs::path* statusFile, std::string* error);
+		//---Сам уборщик: waitFor ("<token>[,pidfd:<fd>|,pid:<pid>|,delay:<ms>]": билет от startReclaimer - без него
+		//   задание отклоняется, - и чей выход или сколько ждать), затем удаление; уборщики одной корзины работают по очереди
+		bool reclaim(const ReclaimJob& job, const std::string& waitFor, std::string* error);
+
+		//---Межпроцессная блокировка операций над одной службой (снимается деструктором)
+		//   Linux: flock на /run/svcinst/locks/<key>.lock, Windows: именованный mutex Global\svcinst-<key>
+		class ServiceLock {
+		public:
+			virtual ~ServiceLock() = default;
+		};
+		//---Захват блокировки службы с ожиданием не дольше waitMs
+		//   key - имя службы (в offline-режиме дополнительно привязано к корню образа).
+		//   nullptr + busy=true  - блокировку держит другой процесс дольше waitMs;
+		//   nullptr + busy=false - ошибка (error)
+		std::unique_ptr<ServiceLock> lockService(const std::string& key, std::uint32_t waitMs, bool& busy, std::string* error);
+
+		//---Запрос к агенту (--serve) от локального клиента
+		struct ServeRequest final {
+			std::string line;			//	Строка запроса (без перевода строки)
+			std::size_t lineNo = 0;		//	Номер строки в соединении (с 1)
+			std::size_t worker = 0;		//	Рабочий поток, выполняющий запрос (0..workers-1)
+			std::uint32_t uid = 0;		//	Пользователь клиента (Linux: SO_PEERCRED)
+			std::uint32_t pid = 0;		//	Процесс клиента
+			bool privileged = false;	//	Клиенту можно выполнять команды (вместо requireAdminRoot)
+		};
+		//---Обработчик запроса: строка ответа (пусто - ответа нет)
+		using ServeHandler = std::function<std::string(const ServeRequest&)>;
+		//---Локальный сервер команд (--serve). Linux: Unix-сокет (права 0600), клиенты - в пуле
+		//   из workers потоков, запросы одного соединения - по очереди. Клиент privileged, если его
+		//   uid - 0 или uid самого агента. Возврат по SIGINT/SIGTERM: приём прекращается,
+		//   начатые запросы завершаются, сокет удаляется. false + error - сервер не запущен.
+		bool serveLocal(const fs::path& socket, std::size_t workers, const ServeHandler& handle, std::string* error);
 	}
 
 } // namespace svcinst
\ No newline at end of file
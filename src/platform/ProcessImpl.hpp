@@ -1,5 +1,6 @@
 #pragma once
 #include "service_installer/Process.hpp"
+#include <memory>
 
 namespace svcinst::process::detail {
 
@@ -22,4 +23,25 @@ namespace svcinst::process::detail {
     bool runPlatform(const fs::path& exe, const std::vector<std::string>& args,
         RunResult& out, const RunOptions& opt);
 
+// Платформенная часть AsyncRunner: запуск потомков и один шаг цикла событий
+// Реализации:
+//   - ProcessLinux.cpp: epoll по pidfd и pipe'ам захвата всех потомков
+//   - ProcessWin.cpp: пока синхронный запуск с отложенной доставкой результата
+    class AsyncEngine {
+    public:
+        virtual ~AsyncEngine() = default;
+
+        //---Запуск потомка. cb вызывается из poll() после его завершения
+        //   (и при ошибке запуска - тогда spawn возвращает false)
+        virtual bool spawn(const fs::path& exe, const std::vector<std::string>& args,
+            const RunOptions& opt, RunCallback cb) = 0;
+        //---Одна итерация цикла: ожидание событий не дольше timeoutMs (-1 - без ограничения)
+        //   и доставка завершений. Возвращает false, если ждать больше нечего
+        virtual bool poll(int timeoutMs) = 0;
+        //---Количество ещё не доставленных потомков
+        virtual std::size_t pending() const = 0;
+    };
+
+    std::unique_ptr<AsyncEngine> makeAsyncEngine();
+
 } // namespace svcinst::process::detail
@@ -0,0 +1,601 @@
+#if defined(__linux__) && defined(SVCINST_HAVE_DBUS)
+
+#include "service_installer/IServiceBackend.hpp"
+#include "platform/linux/SystemdCommon.hpp"
+#include "platform/linux/RuntimeLocks.hpp"
+#include "Log.hpp"
+
+#include <dbus/dbus.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace svcinst {
+
+    namespace fs = std::filesystem;
+    using systemd::isValidUnitName;
+    using systemd::unitName;
+    using systemd::writeUnitFile;
+    using systemd::unitFileExists;
+
+    namespace {
+
+        //---Адрес менеджера systemd на системной шине
+        constexpr const char* kSystemdDest = "org.freedesktop.systemd1";
+        constexpr const char* kSystemdPath = "/org/freedesktop/systemd1";
+        constexpr const char* kManagerIface = "org.freedesktop.systemd1.Manager";
+        constexpr const char* kUnitIface = "org.freedesktop.systemd1.Unit";
+        constexpr const char* kPropertiesIface = "org.freedesktop.DBus.Properties";
+
+        //---Подписка на сигнал завершения job'а
+        constexpr const char* kJobRemovedMatch =
+            "type='signal',sender='org.freedesktop.systemd1',"
+            "interface='org.freedesktop.systemd1.Manager',member='JobRemoved',"
+            "path='/org/freedesktop/systemd1'";
+
+        using Clock = std::chrono::steady_clock;
+
+        //---RAII-обёртка над DBusError
+        struct DbusError final {
+            DBusError e;
+            DbusError() { dbus_error_init(&e); }
+            ~DbusError() { dbus_error_free(&e); }
+            DbusError(const DbusError&) = delete;
+            DbusError& operator=(const DbusError&) = delete;
+
+            bool isSet() const { return dbus_error_is_set(&e); }
+        };
+
+        //---Владеющий указатель на DBusMessage
+        struct MessageUnref {
+            void operator()(DBusMessage* m) const { if (m) dbus_message_unref(m); }
+        };
+        using MessagePtr = std::unique_ptr<DBusMessage, MessageUnref>;
+
+        //---Формирование структурированной ошибки: "<what>: <имя D-Bus ошибки>: <сообщение>"
+        static void setError(std::string* error, const char* what, const DbusError& err)
+        {
+            if (!error) return;
+            std::ostringstream os;
+            os << what << ": " << (err.e.name ? err.e.name : "dbus error");
+            if (err.e.message && *err.e.message) os << ": " << err.e.message;
+            *error = os.str();
+        }
+
+        static void setError(std::string* error, const char* what, const std::string& msg)
+        {
+            if (!error) return;
+            *error = std::string(what) + ": " + msg;
+        }
+
+        //---Оставшееся до дедлайна время в мс (0 - дедлайн прошёл)
+        static int remainingMs(Clock::time_point deadline)
+        {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            return left > 0 ? (int)left : 0;
+        }
+
+        //---Добавление массива строк (сигнатура "as") в сообщение
+        static bool appendStringArray(DBusMessage* m, const std::string& s)
+        {
+            DBusMessageIter it, arr;
+            dbus_message_iter_init_append(m, &it);
+            if (!dbus_message_iter_open_container(&it, DBUS_TYPE_ARRAY, DBUS_TYPE_STRING_AS_STRING, &arr))
+                return false;
+            const char* p = s.c_str();
+            if (!dbus_message_iter_append_basic(&arr, DBUS_TYPE_STRING, &p))
+            {
+                dbus_message_iter_abandon_container(&it, &arr);
+                return false;
+            }
+            return dbus_message_iter_close_container(&it, &arr);
+        }
+
+        static bool appendBool(DBusMessage* m, bool v)
+        {
+            const dbus_bool_t b = v ? TRUE : FALSE;
+            return dbus_message_append_args(m, DBUS_TYPE_BOOLEAN, &b, DBUS_TYPE_INVALID);
+        }
+
+    } // namespace
+
+    //---BackendLinuxDbus - реализация сервисного бэкенда для Linux/systemd через D-Bus
+    //   Вместо запуска /bin/systemctl на каждый шаг вызывает методы org.freedesktop.systemd1.Manager
+    //   напрямую. Подключается к системной шине (адрес можно переопределить через
+    //   DBUS_SYSTEM_BUS_ADDRESS - так бэкенд проверяется на локальной подменной шине).
+    class BackendLinuxDbus final : public IServiceBackend {
+    public:
+        explicit BackendLinuxDbus(const BackendOptions& opt) : opt_(opt) {}
+        BackendLinuxDbus(const BackendLinuxDbus&) = delete;
+        BackendLinuxDbus& operator=(const BackendLinuxDbus&) = delete;
+
+        ~BackendLinuxDbus() override
+        {
+            std::string err;
+            if (!flush(&err)) LOG(WARNING) << err;
+
+            if (conn_)
+            {
+                dbus_connection_close(conn_);
+                dbus_connection_unref(conn_);
+            }
+        }
+
+        //---Установка или обновление сервиса
+        bool installOrUpdate(const ServiceSpec& spec, std::string* error, InstallReport* report = nullptr) override
+        {
+            //---Валидация имени сервиса
+            if (!isValidUnitName(spec.name))
+            {
+                if (error) *error = "installOrUpdate: invalid service name (allowed: A-Za-z0-9_.-)";
+                return false;
+            }
+            //---Валидация пути к исполняемому файлу
+            if (spec.exeAbs.empty() || !spec.exeAbs.is_absolute())
+            {
+                if (error) *error = "installOrUpdate: spec.exeAbs must be an absolute path";
+                return false;
+            }
+            //---Валидация зависимостей
+            if (!systemd::validateDependencies(spec, error))
+                return false;
+            //---Offline-режим обслуживает только бэкенд systemctl: живой шины в образе нет
+            if (!opt_.root.empty() || !spec.root.empty())
+            {
+                if (error) *error = "installOrUpdate: --root is not supported by the D-Bus backend";
+                return false;
+            }
+            //---Сравниваем желаемый unit с тем, что уже лежит на диске
+            std::string onDisk;
+            const bool exists = systemd::readUnitFile(spec.name, opt_.root, onDisk);
+            const std::string content = systemd::renderUnit(spec);
+            const std::string u = unitName(spec.name);
+
+            InstallReport rep;
+
+            //--- 1) Создание и запись файла unit в /etc/systemd/system/<name>.service (если изменился)
+            if (!exists || !systemd::unitMatches(onDisk, content))
+            {
+                if (!writeUnitFile(spec, content, opt_.durability, error))
+                    return false;
+                pendingSync_ = pendingSync_ || opt_.durability == Durability::Batch;
+                rep.unitWritten = true;
+            }
+
+            //---Ничего не поменялось и запускать не нужно - к шине даже не подключаемся
+            const bool autostartOk = systemd::autostartMatches(spec.name, opt_.root, spec.autostart);
+            if (!rep.unitWritten && autostartOk && !spec.runNow)
+            {
+                if (report) *report = rep;
+                return true;
+            }
+            if (!connect(error)) return false;
+
+            //--- 2) Перезагрузка конфигурации systemd
+            if (rep.unitWritten)
+            {
+                if (!reload(error))
+                    return false;
+                rep.reloaded = true;
+            }
+
+            //--- 3) Включение/отключение автозапуска
+            if (!autostartOk)
+            {
+                if (!(spec.autostart ? enableUnit(u, error) : disableUnit(u, error)))
+                    return false;
+                rep.autostartChanged = true;
+            }
+
+            //--- 4) Немедленный запуск: работающий unit перезапускаем, только если он изменился
+            if (spec.runNow)
+            {
+                //---Состояние неизвестно - не угадываем: StartUnit оставил бы работать старый бинарник
+                bool restart = false;
+                if (rep.unitWritten && !isUnitActive(u, restart, error))
+                    return false;
+                if (!runJob(restart ? "RestartUnit" : "StartUnit", u, error))
+                    return false;
+                rep.restarted = restart;
+                rep.started = true;
+            }
+
+            if (report) *report = rep;
+            return true;
+        }
+
+        //---Удаление сервиса
+        bool uninstall(const std::string& name, bool stopFirst, std::string* error) override
+        {
+            if (!isValidUnitName(name))
+            {
+                if (error) *error = "uninstall: invalid service name (allowed: A-Za-z0-9_.-)";
+                return false;
+            }
+            if (!opt_.root.empty())
+            {
+                if (error) *error = "uninstall: --root is not supported by the D-Bus backend";
+                return false;
+            }
+            if (!connect(error)) return false;
+
+            const bool exists = unitFileExists(name);
+            const std::string u = unitName(name);
+
+            //---Остановка сервиса (best-effort: unit может быть не загружен/не запущен)
+            if (stopFirst)
+            {
+                std::string tmp;
+                if (!runJob("StopUnit", u, &tmp)) { VLOG(1) << tmp; }
+            }
+
+            //---Отключение автозапуска (best-effort)
+            {
+                std::string tmp;
+                if (!disableUnit(u, &tmp)) { VLOG(1) << tmp; }
+            }
+
+            //---Удаление файла unit (если он существует)
+            if (exists)
+            {
+                if (!systemd::removeUnitFile(name, {}, opt_.durability, error))
+                    return false;
+                pendingSync_ = pendingSync_ || opt_.durability == Durability::Batch;
+            }
+
+            //---Перезагрузка конфигурации systemd (важно после удаления файла)
+            return reload(error);
+        }
+
+        //---Запуск сервиса
+        bool start(const std::string& name, std::string* error) override
+        {
+            if (!isValidUnitName(name))
+            {
+                if (error) *error = "start: invalid service name (allowed: A-Za-z0-9_.-)";
+                return false;
+            }
+            if (!connect(error)) return false;
+            return runJob("StartUnit", unitName(name), error);
+        }
+
+        //---Остановка сервиса
+        bool stop(const std::string& name, std::string* error) override
+        {
+            if (!isValidUnitName(name))
+            {
+                if (error) *error = "stop: invalid service name (allowed: A-Za-z0-9_.-)";
+                return false;
+            }
+            if (!connect(error)) return false;
+            return runJob("StopUnit", unitName(name), error);
+        }
+
+        //---Состояние unit'а на диске относительно спецификации (без обращения к шине)
+        SpecState inspect(const ServiceSpec& spec) override
+        {
+            return systemd::inspectUnit(spec);
+        }
+
+        //---Состояние службы: unit-файл и симлинки - с диска, ActiveState - по шине
+        bool status(const std::string& name, ServiceStatus& out, std::string* error) override
+        {
+            out = {};
+            if (!isValidUnitName(name))
+            {
+                if (error) *error = "status: invalid service name (allowed: A-Za-z0-9_.-)";
+                return false;
+            }
+            std::string content;
+            out.installed = systemd::readUnitFile(name, opt_.root, content);
+            out.managed = out.installed && systemd::isManagedUnit(content);
+            out.autostart = out.installed && systemd::autostartMatches(name, opt_.root, true);
+            if (!opt_.root.empty()) return true;
+
+            if (!connect(error)) return false;
+            out.activeState = activeState(unitName(name), error);
+            return !out.activeState.empty();
+        }
+
+        //---Зависимости службы по её unit-файлу (After=*.service)
+        bool dependencies(const std::string& name, std::vector<std::string>& out, std::string* error) override
+        {
+            if (!isValidUnitName(name))
+            {
+                if (error) *error = "dependencies: invalid service name (allowed: A-Za-z0-9_.-)";
+                return false;
+            }
+            return systemd::readUnitDependencies(name, opt_.root, out, error);
+        }
+
+        //---Службы, созданные установщиком (unit'ы с маркером)
+        bool listManaged(std::vector<std::string>& names, std::string* error) override
+        {
+            return systemd::listManagedUnits(opt_.root, names, error);
+        }
+
+        //---Durability::Batch: один syncfs для всех записанных unit'ов
+        bool flush(std::string* error) override
+        {
+            if (!pendingSync_) return true;
+            pendingSync_ = false;
+            return systemd::syncUnitFs({}, error);
+        }
+
+    private:
+        //---Подключение к системной шине (лениво, один раз на бэкенд)
+        //   Соединение приватное: не делим его с другими пользователями libdbus в процессе
+        //   и закрываем в деструкторе.
+        bool connect(std::string* error)
+        {
+            if (conn_)
+            {
+                if (dbus_connection_get_is_connected(conn_)) return true;
+                dbus_connection_close(conn_);
+                dbus_connection_unref(conn_);
+                conn_ = nullptr;
+            }
+
+            DbusError err;
+            DBusConnection* c = dbus_bus_get_private(DBUS_BUS_SYSTEM, &err.e);
+            if (!c)
+            {
+                setError(error, "dbus connect", err);
+                return false;
+            }
+            //---Разрыв соединения не должен завершать процесс (по умолчанию libdbus вызывает _exit)
+            dbus_connection_set_exit_on_disconnect(c, FALSE);
+
+            //---Подписка на JobRemoved: по нему отслеживается завершение start/stop/restart
+            dbus_bus_add_match(c, kJobRemovedMatch, &err.e);
+            if (err.isSet())
+            {
+                setError(error, "dbus AddMatch JobRemoved", err);
+                dbus_connection_close(c);
+                dbus_connection_unref(c);
+                return false;
+            }
+            conn_ = c;
+
+            //---Без Subscribe systemd не рассылает сигналы о job'ах
+            MessagePtr reply = call(newManagerCall("Subscribe").release(), "dbus Subscribe", 30 * 1000, error);
+            return reply != nullptr;
+        }
+
+        //---Новый вызов метода org.freedesktop.systemd1.Manager
+        static MessagePtr newManagerCall(const char* method)
+        {
+            return MessagePtr(dbus_message_new_method_call(kSystemdDest, kSystemdPath, kManagerIface, method));
+        }
+
+        //---Синхронный вызов метода с таймаутом; возвращает ответ или nullptr + error
+        //   Время вызова логируется так же, как время запуска systemctl в BackendLinuxSystemd.
+        //   errorName - имя ошибки D-Bus (org.freedesktop.systemd1.NoSuchUnit и т.п.), если вызов не удался
+        MessagePtr call(DBusMessage* raw, const char* what, std::uint32_t timeoutMs, std::string* error, std::string* errorName = nullptr)
+        {
+            MessagePtr msg(raw);
+            if (!msg)
+            {
+                setError(error, what, "out of memory");
+                return nullptr;
+            }
+
+            DbusError err;
+            const auto started = Clock::now();
+            MessagePtr reply(dbus_connection_send_with_reply_and_block(conn_, msg.get(), (int)timeoutMs, &err.e));
+            logCall(what, started, timeoutMs);
+
+            if (!reply)
+            {
+                if (errorName && err.isSet() && err.e.name) *errorName = err.e.name;
+                setError(error, what, err);
+                return nullptr;
+            }
+            return reply;
+        }
+
+        //---Учёт времени вызова: подробности на VLOG(1), заметное замедление - предупреждение
+        static void logCall(const char* what, Clock::time_point started, std::uint32_t timeoutMs)
+        {
+            const auto wallMs = (std::uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+                Clock::now() - started).count();
+            VLOG(1) << what << ": wall=" << wallMs << "ms";
+            if (wallMs > timeoutMs / 4)
+            {
+                LOG(WARNING) << what << " is slow: " << wallMs << " ms (timeout " << timeoutMs << " ms)";
+            }
+        }
+
+        //---Manager.Reload - аналог systemctl daemon-reload (возвращается после завершения перезагрузки)
+        //   Объединяется с reload'ами параллельных экземпляров установщика (см. RuntimeLocks.hpp)
+        bool reload(std::string* error)
+        {
+            const std::uint32_t timeoutMs = systemd::operationTimeoutMs("daemon-reload");
+            bool coalesced = false;
+            const bool ok = systemd::coalescedReload(
+                [&](std::string* e) { return call(newManagerCall("Reload").release(), "dbus Reload", timeoutMs, e) != nullptr; },
+                timeoutMs, error, &coalesced);
+            if (ok && coalesced) { VLOG(1) << "dbus Reload: covered by a concurrent installer"; }
+            return ok;
+        }
+
+        //---Manager.EnableUnitFiles(as files, b runtime=false, b force=true)
+        bool enableUnit(const std::string& unit, std::string* error)
+        {
+            MessagePtr m = newManagerCall("EnableUnitFiles");
+            if (m && !(appendStringArray(m.get(), unit) && appendBool(m.get(), false) && appendBool(m.get(), true)))
+                m.reset();
+            return call(m.release(), "dbus EnableUnitFiles", systemd::operationTimeoutMs("enable"), error) != nullptr;
+        }
+
+        //---Manager.DisableUnitFiles(as files, b runtime=false)
+        bool disableUnit(const std::string& unit, std::string* error)
+        {
+            MessagePtr m = newManagerCall("DisableUnitFiles");
+            if (m && !(appendStringArray(m.get(), unit) && appendBool(m.get(), false)))
+                m.reset();
+            return call(m.release(), "dbus DisableUnitFiles", systemd::operationTimeoutMs("disable"), error) != nullptr;
+        }
+
+        //---Проверка по свойствам unit'а, что он сейчас работает (ActiveState)
+        //   false + error - состояние неизвестно (ошибка шины, таймаут, нет доступа)
+        bool isUnitActive(const std::string& unit, bool& active, std::string* error)
+        {
+            const std::string s = activeState(unit, error);
+            active = (s == "active" || s == "activating" || s == "reloading");
+            return !s.empty();
+        }
+
+        //---Свойство ActiveState unit'а
+        //   Не загруженный unit (только NoSuchUnit) - "inactive", любая другая ошибка - пустая строка и error.
+        std::string activeState(const std::string& unit, std::string* error)
+        {
+            MessagePtr m = newManagerCall("GetUnit");
+            const char* u = unit.c_str();
+            if (m && !dbus_message_append_args(m.get(), DBUS_TYPE_STRING, &u, DBUS_TYPE_INVALID))
+                m.reset();
+
+            std::string getUnitError, errorName;
+            MessagePtr reply = call(m.release(), "dbus GetUnit", 30 * 1000, &getUnitError, &errorName);
+            if (!reply)
+            {
+                if (errorName == "org.freedesktop.systemd1.NoSuchUnit") return "inactive";
+                if (error) *error = getUnitError;
+                return {};
+            }
+
+            DbusError err;
+            const char* unitObj = nullptr;
+            if (!dbus_message_get_args(reply.get(), &err.e, DBUS_TYPE_OBJECT_PATH, &unitObj, DBUS_TYPE_INVALID))
+            {
+                setError(error, "dbus GetUnit", err);
+                return {};
+            }
+
+            MessagePtr get(dbus_message_new_method_call(kSystemdDest, unitObj, kPropertiesIface, "Get"));
+            const char* iface = kUnitIface;
+            const char* prop = "ActiveState";
+            if (get && !dbus_message_append_args(get.get(), DBUS_TYPE_STRING, &iface, DBUS_TYPE_STRING, &prop, DBUS_TYPE_INVALID))
+                get.reset();
+
+            MessagePtr val = call(get.release(), "dbus Get ActiveState", 30 * 1000, error);
+            if (!val) return {};
+
+            DBusMessageIter it, var;
+            const char* state = nullptr;
+            if (dbus_message_iter_init(val.get(), &it) && dbus_message_iter_get_arg_type(&it) == DBUS_TYPE_VARIANT)
+            {
+                dbus_message_iter_recurse(&it, &var);
+                if (dbus_message_iter_get_arg_type(&var) == DBUS_TYPE_STRING) dbus_message_iter_get_basic(&var, &state);
+            }
+            if (!state || !*state)
+            {
+                setError(error, "dbus Get ActiveState", "unexpected reply");
+                return {};
+            }
+            return state;
+        }
+
+        //---StartUnit/StopUnit/RestartUnit(s name, s mode="replace") с ожиданием завершения job'а
+        //   Метод возвращает путь job'а сразу; результат приходит сигналом JobRemoved
+        //   (id, job, unit, result). Успех - только result == "done".
+        bool runJob(const char* method, const std::string& unit, std::string* error)
+        {
+            const std::string what = std::string("dbus ") + method;
+            const char* verb =
+                (std::string_view(method) == "StopUnit") ? "stop" :
+                (std::string_view(method) == "RestartUnit") ? "restart" : "start";
+            const std::uint32_t timeoutMs = systemd::operationTimeoutMs(verb);
+            const auto started = Clock::now();
+            const auto deadline = started + std::chrono::milliseconds(timeoutMs);
+
+            MessagePtr m = newManagerCall(method);
+            const char* u = unit.c_str();
+            const char* mode = "replace";
+            if (m && !dbus_message_append_args(m.get(), DBUS_TYPE_STRING, &u, DBUS_TYPE_STRING, &mode, DBUS_TYPE_INVALID))
+                m.reset();
+
+            MessagePtr reply = call(m.release(), what.c_str(), timeoutMs, error);
+            if (!reply) return false;
+
+            DbusError err;
+            const char* jobPath = nullptr;
+            if (!dbus_message_get_args(reply.get(), &err.e, DBUS_TYPE_OBJECT_PATH, &jobPath, DBUS_TYPE_INVALID))
+            {
+                setError(error, what.c_str(), err);
+                return false;
+            }
+            const std::string job = jobPath;
+
+            //---Ожидание JobRemoved для нашего job'а. Сигналы, пришедшие пока мы ждали ответ
+            //   на вызов, уже лежат во входящей очереди соединения - сначала разбираем её.
+            std::string result;
+            while (result.empty())
+            {
+                while (MessagePtr sig{ dbus_connection_pop_message(conn_) })
+                {
+                    if (!dbus_message_is_signal(sig.get(), kManagerIface, "JobRemoved")) continue;
+
+                    dbus_uint32_t id = 0;
+                    const char* sigJob = nullptr;
+                    const char* sigUnit = nullptr;
+                    const char* sigResult = nullptr;
+                    DbusError sigErr;
+                    if (!dbus_message_get_args(sig.get(), &sigErr.e,
+                        DBUS_TYPE_UINT32, &id,
+                        DBUS_TYPE_OBJECT_PATH, &sigJob,
+                        DBUS_TYPE_STRING, &sigUnit,
+                        DBUS_TYPE_STRING, &sigResult,
+                        DBUS_TYPE_INVALID))
+                        continue;
+                    if (job == sigJob)
+                    {
+                        result = sigResult;
+                        break;
+                    }
+                }
+                if (!result.empty()) break;
+
+                const int waitMs = remainingMs(deadline);
+                if (waitMs == 0)
+                {
+                    setError(error, what.c_str(), "job " + job + " timed out after " + std::to_string(timeoutMs) + " ms");
+                    return false;
+                }
+                if (!dbus_connection_read_write(conn_, waitMs))
+                {
+                    setError(error, what.c_str(), "disconnected from system bus while waiting for job " + job);
+                    return false;
+                }
+            }
+            logCall((what + " job").c_str(), started, timeoutMs);
+
+            if (result != "done")
+            {
+                //---failed / timeout / canceled / dependency / skipped
+                setError(error, what.c_str(), unit + ": job " + result);
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        BackendOptions opt_;
+        DBusConnection* conn_ = nullptr;
+        bool pendingSync_ = false;      //	Есть несброшенные записи (Durability::Batch)
+    };
+
+    //---Создание D-Bus бэкенда (см. SystemdCommon.hpp)
+    std::unique_ptr<IServiceBackend> systemd::makeDbusBackend(const BackendOptions& opt)
+    {
+        return std::make_unique<BackendLinuxDbus>(opt);
+    }
+
+} // namespace svcinst
+
+#endif // __linux__ && SVCINST_HAVE_DBUS
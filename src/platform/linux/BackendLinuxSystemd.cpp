@@ -1,70 +1,56 @@
 #if defined(__linux__)
 
 #include "service_installer/IServiceBackend.hpp"
+#include "service_installer/Plan.hpp"
 #include "service_installer/Process.hpp"
-
+#include "platform/PlatformImpl.hpp"
+#include "platform/linux/SystemdCommon.hpp"
+#include "platform/linux/RuntimeLocks.hpp"
+#include "Log.hpp"
+#include "Text.hpp"
+
+#include <algorithm>
+#include <cstdint>
 #include <filesystem>
-#include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace svcinst {
 
     namespace fs = std::filesystem;
+    using systemd::isValidUnitName;
+    using systemd::unitName;
+    using systemd::writeUnitFile;
+    using systemd::unitFileExists;
 
     namespace {
 
-        //---Проверка корректности имени systemd unit
-        //   Имена должны состоять только из безопасных символов
-        //   разрешенные символы: A-Z, a-z, 0-9, '_', '.', '-'
-        static bool isValidUnitName(const std::string& name)
-        {
-            //---Минимально строгая валидация: systemd unit name обычно безопаснее
-            //   ограничить на [A-Za-z0-9_.-]. Без пробелов и слэшей.
-            if (name.empty()) return false;
-
-            for (char c : name)
-            {
-                const bool ok =
-                    (c >= 'a' && c <= 'z') ||
-                    (c >= 'A' && c <= 'Z') ||
-                    (c >= '0' && c <= '9') ||
-                    c == '_' || c == '.' || c == '-';
-                if (!ok) return false;
-            }
-            return true;
-        }
-        
-        //---Возвращает полный путь к файлу systemd unit
-        static fs::path unitPath(const std::string& name)
-        {
-            // системный unit - размещается в /etc/systemd/system/
-            return fs::path("/etc/systemd/system") / (name + ".service");
-        }
-
-        //---Возвращает полное имя unit с расширением .service
-        static std::string unitName(const std::string& name)
-        {
-            return name + ".service";
-        }
-
         //---Вспомогательная функция для запуска systemctl
         
         // Запускает systemctl с указанными аргументами и проверяет код возврата
         // Параметры:
         //   args - аргументы для systemctl (например {"start", "myservice.service"})
         //   okExitCodes - список допустимых кодов возврата (например {0})
-        //   error - строка для записи ошибки (если указана)
+        //   error - строка для записи ошибки (если указана), включает stderr systemctl
         //   what - описание операции для сообщений об ошибках
+        //   out - захваченный stdout (если указан)
         static bool runSystemctl(const std::vector<std::string>& args,
             std::initializer_list<int> okExitCodes,
             std::string* error,
-            const char* what)
+            const char* what,
+            std::string* out = nullptr)
         {
-            process::RunResult rr;
+            process::RunOptions ro;
+            ro.timeoutMs = systemd::operationTimeoutMs(args.empty() ? std::string() : args.front());
+            ro.captureOutput = true;
+            ro.maxCaptureBytes = 16 * 1024;
+
+            //---Один RunResult на поток: буферы stdout/stderr переиспользуются между вызовами
+            thread_local process::RunResult rr;
             //---Запускаем /bin/systemctl с указанными аргументами
-            const bool ok = process::run(fs::path("/bin/systemctl"), args, rr, process::RunOptions{});
+            const bool ok = process::run(fs::path("/bin/systemctl"), args, rr, ro);
             if (!ok || !rr.started)
             {
                 if (error)
@@ -76,201 +62,186 @@ namespace svcinst {
                 return false;
             }
 
+            //---Учёт времени systemctl: подробности на VLOG(1), заметное замедление - предупреждение
+            //   (например, daemon-reload дорожает по мере роста числа unit'ов)
+            const std::uint64_t wallMs = rr.stats.wallUs / 1000;
+            VLOG(1) << what << ": wall=" << wallMs << "ms"
+                << " user=" << rr.stats.userCpuUs / 1000 << "ms"
+                << " sys=" << rr.stats.sysCpuUs / 1000 << "ms"
+                << " maxRss=" << rr.stats.maxRssKb << "KiB"
+                << " ctxsw=" << rr.stats.volCtxSwitches << "/" << rr.stats.involCtxSwitches;
+            if (!rr.timedOut && wallMs > ro.timeoutMs / 4)
+            {
+                LOG(WARNING) << what << " is slow: " << wallMs << " ms (timeout " << ro.timeoutMs << " ms)";
+            }
+
+            //---Зависший systemctl был прерван по таймауту - это всегда ошибка
+            if (rr.timedOut)
+            {
+                if (error)
+                {
+                    std::ostringstream os;
+                    os << what << ": systemctl timed out after " << ro.timeoutMs << " ms (killed)";
+                    if (!rr.stdErr.empty()) os << ": " << oneLine(rr.stdErr, rr.stdErrTruncated);
+                    *error = os.str();
+                }
+                return false;
+            }
+
             //---Проверяем код возврата на соответствие допустимым значениям
             for (int code : okExitCodes)
             {
-                if (rr.exitCode == code) return true;
+                if (rr.exitCode != code) continue;
+                if (out) *out = rr.stdOut;
+                return true;
             }
 
-            //---Если код возврата недопустимый - записываем ошибку
+            //---Если код возврата недопустимый - записываем ошибку вместе с тем, что systemctl написал в stderr
             if (error)
             {
                 std::ostringstream os;
                 os << what << ": systemctl exitCode=" << rr.exitCode;
+                if (!rr.stdErr.empty()) os << ": " << oneLine(rr.stdErr, rr.stdErrTruncated);
                 *error = os.str();
             }
             return false;
         }
 
         
-        //---Генерация файла systemd unit
-        
-        //---Очищает описание от символов новой строки
-        static std::string sanitizeDescription(const std::string& s)
+    } // namespace
+
+    //---BackendLinuxSystemd - реализация сервисного бэкенда для Linux/systemd
+    class BackendLinuxSystemd final : public IServiceBackend {
+    public:
+        explicit BackendLinuxSystemd(const BackendOptions& opt) : opt_(opt) {}
+
+        ~BackendLinuxSystemd() override
         {
-            // В unit-файле нежелательны переводы строк
-            std::string out;
-            out.reserve(s.size());
-            for (char c : s)
-            {
-                if (c == '\r' || c == '\n') continue;
-                out.push_back(c);
-            }
-            if (out.empty()) out = "service";
-            return out;
+            //---Durability::Batch: если вызывающий не сделал flush - сбрасываем сами
+            std::string err;
+            if (!flush(&err)) LOG(WARNING) << err;
         }
 
-        //---Добавляет кавычки к строке, если она содержит пробелы или кавычки
-        static std::string quoteIfNeeded(const std::string& s)
+        //---Установка или обновление сервиса
+        bool installOrUpdate(const ServiceSpec& spec, std::string* error, InstallReport* report = nullptr) override
         {
-            //---Для ExecStart systemd поддерживает кавычки. Мы гарантируем кавычки для exe с пробелами.
-            //   Аргументы добавляем "как есть" (на следующем шаге можно сделать токенизацию).
-            if (s.empty()) return "\"\"";
+            //--- 1) Запись unit-файла и симлинков автозапуска (только то, что изменилось)
+            Staged st;
+            if (!stageUnit(spec, st, error))
+                return false;
+            InstallReport& rep = st.rep;
+            const std::string u = unitName(spec.name);
 
-            bool need = false;
-            for (char c : s)
+            //---Offline-режим: живого systemd нет - reload и запуск не выполняются
+            if (!opt_.root.empty())
             {
-                if (c == ' ' || c == '\t' || c == '"') { need = true; break; }
+                if (spec.runNow) { VLOG(1) << "installOrUpdate: --root mode, start of " << u << " skipped"; }
+                if (report) *report = rep;
+                return true;
             }
-            if (!need) return s;
 
-            std::string out;
-            out.reserve(s.size() + 2);
-            out.push_back('"');
-            for (char c : s)
+            //--- 3) Перезагрузка конфигурации systemd (только если что-то поменялось на диске)
+            if (rep.unitWritten || rep.autostartChanged)
             {
-                if (c == '"') out += "\\\"";  //---Экранируем кавычки внутри строки
-                else out.push_back(c);
+                if (!daemonReload(error))
+                    return false;
+                rep.reloaded = true;
             }
-            out.push_back('"');
-            return out;
-        }
-
-        //---Создает и записывает файл systemd unit на основе спецификации сервиса
-        static bool writeUnitFile(const ServiceSpec& spec, std::string* error)
-        {
-            const fs::path p = unitPath(spec.name);
-
-            std::error_code ec;
-            // ---Создаем директорию, если она не существует (обычно /etc/systemd/system уже существует)
-            fs::create_directories(p.parent_path(), ec);
-            //---если ec != 0 — не фатально, попробуем писать
 
-            std::ofstream f(p, std::ios::binary | std::ios::trunc);
-            if (!f)
+            if (!useLinks(opt_.root) && !st.autostartOk)
             {
-                if (error)
-                {
-                    std::ostringstream os;
-                    os << "Failed to open unit file for writing: " << p.string();
-                    *error = os.str();
-                }
-                return false;
+                if (!setAutostart(spec.name, spec.autostart, opt_.root, error))
+                    return false;
+                rep.autostartChanged = true;
             }
 
-            const std::string desc = sanitizeDescription(spec.description.empty() ? spec.name : spec.description);
-
-            //---exeAbs должен быть абсолютным путем
-            const std::string exe = spec.exeAbs.string();
-            const std::string execStart = quoteIfNeeded(exe) + (spec.args.empty() ? "" : (" " + spec.args));
-
-            //---Политика восстановления — аналог Windows recovery:
-            //   Restart=on-failure, RestartSec=2, StartLimitBurst=3, StartLimitIntervalSec=10
-            f <<
-                "[Unit]\n"
-                "Description=" << desc << "\n"
-                "After=network.target\n"           // Сервис запускается после настройки сети
-                "\n"
-                "[Service]\n"
-                "Type=simple\n"                    // Простой сервис без дополнительного контроля
-                "ExecStart=" << execStart << "\n"
-                "Restart=on-failure\n"             // Перезапускать при ошибках
-                "RestartSec=2\n"                   // Ждать 2 секунды перед перезапуском
-                "StartLimitBurst=3\n"              // Максимум 3 попытки запуска
-                "StartLimitIntervalSec=10\n"       // В течение 10 секунд
-                "\n"
-                "[Install]\n"
-                "WantedBy=multi-user.target\n";    // Запускать в multi-user режиме
-
-            f.flush();
-            if (!f)
+            //--- 4) Немедленный запуск (или перезапуск, если unit изменился)
+            if (spec.runNow)
             {
-                if (error)
+                if (st.exists && rep.unitWritten)
                 {
-                    std::ostringstream os;
-                    os << "Failed to write unit file: " << p.string();
-                    *error = os.str();
+                    //---Unit уже существовал и изменился: применяем новый ExecStart через restart
+                    if (!ctl({ "restart", u }, error, "systemctl restart"))
+                        return false;
+                    rep.restarted = true;
                 }
-                return false;
+                else
+                {
+                    //---Unit новый или не менялся: start (для работающей службы - no-op)
+                    if (!ctl({ "start", u }, error, "systemctl start"))
+                        return false;
+                }
+                rep.started = true;
             }
 
+            if (report) *report = rep;
             return true;
         }
 
-        //---Проверяет существование файла systemd unit
-        static bool unitFileExists(const std::string& name)
-        {
-            std::error_code ec;
-            return fs::exists(unitPath(name), ec);
-        }
-
-    } // namespace
-
-    //---BackendLinuxSystemd - реализация сервисного бэкенда для Linux/systemd
-    class BackendLinuxSystemd final : public IServiceBackend {
-    public:
-        //---Установка или обновление сервиса
-        bool installOrUpdate(const ServiceSpec& spec, std::string* error) override
+        //---Пакетная установка: те же шаги, что у installOrUpdate, но общие выполняются один раз
+        //   1) запись всех unit'ов (и симлинков в режиме Links), 2) один daemon-reload,
+        //   3) один systemctl enable a b c ..., 4) один restart для изменившихся и один start для остальных
+        void installMany(const std::vector<ServiceSpec>& specs, std::vector<BatchResult>& results) override
         {
-            //---Валидация имени сервиса
-            if (!isValidUnitName(spec.name))
+            const std::size_t n = specs.size();
+            results.assign(n, {});
+            std::vector<Staged> st(n);
+            std::vector<std::string> names(n);
+            for (std::size_t i = 0; i < n; ++i) names[i] = specs[i].name;
+
+            //--- 1) Запись
+            bool needReload = false;
+            for (std::size_t i = 0; i < n; ++i)
             {
-                if (error) *error = "installOrUpdate: invalid service name (allowed: A-Za-z0-9_.-)";
-                return false;
-            }
-            //---Валидация пути к исполняемому файлу
-            if (spec.exeAbs.empty() || !spec.exeAbs.is_absolute())
-            {
-                if (error) *error = "installOrUpdate: spec.exeAbs must be an absolute path";
-                return false;
+                results[i].ok = stageUnit(specs[i], st[i], &results[i].error);
+                if (results[i].ok && opt_.root.empty() && (st[i].rep.unitWritten || st[i].rep.autostartChanged))
+                    needReload = true;
             }
 
-            //---Проверяем, существовал ли unit-файл до установки/обновления
-            const bool exists = unitFileExists(spec.name);
-            const std::string u = unitName(spec.name);
-
-            //--- 1) Создание и запись файла unit в /etc/systemd/system/<name>.service
-            if (!writeUnitFile(spec, error))
-                return false;
-
-            //--- 2) Перезагрузка конфигурации systemd
-            if (!runSystemctl({ "daemon-reload" }, { 0 }, error, "systemctl daemon-reload"))
-                return false;
-
-            //--- 3) Включение/отключение автозапуска
-            if (spec.autostart)
+            //--- 2) Один daemon-reload на весь пакет
+            if (needReload)
             {
-                // Включаем автозапуск
-                if (!runSystemctl({ "enable", u }, { 0 }, error, "systemctl enable"))
-                    return false;
+                std::string err;
+                const bool ok = daemonReload(&err);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    InstallReport& rep = st[i].rep;
+                    if (!results[i].ok || !opt_.root.empty() || !(rep.unitWritten || rep.autostartChanged)) continue;
+                    if (ok) rep.reloaded = true;
+                    else fail(results[i], err);
+                }
             }
-            else
+
+            //--- 3) enable/disable одной командой (режим Systemctl)
+            std::vector<std::size_t> toEnable, toDisable;
+            for (std::size_t i = 0; i < n; ++i)
             {
-                // Отключаем автозапуск
-                // disable может вернуть ошибку если unit не был enabled — treat as ok?
-                // systemctl обычно возвращает 0, но оставим строго: если хотите, смягчим на следующем шаге.
-                if (!runSystemctl({ "disable", u }, { 0 }, error, "systemctl disable"))
-                    return false;
+                if (!results[i].ok || useLinks(opt_.root) || st[i].autostartOk) continue;
+                (specs[i].autostart ? toEnable : toDisable).push_back(i);
             }
-
-            //--- 4) Немедленный запуск (или перезапуск, если уже запущен)
-            if (spec.runNow)
+            bulkSystemctl("enable", toEnable, names, results);
+            bulkSystemctl("disable", toDisable, names, results);
+            for (std::size_t i : toEnable) if (results[i].ok) st[i].rep.autostartChanged = true;
+            for (std::size_t i : toDisable) if (results[i].ok) st[i].rep.autostartChanged = true;
+
+            //--- 4) Запуск: restart для существовавших и изменившихся unit'ов, start для остальных
+            std::vector<std::size_t> toRestart, toStart;
+            for (std::size_t i = 0; i < n; ++i)
             {
-                if (exists)
-                {
-                    //---Unit уже существовал: применяем новый ExecStart через restart
-                    if (!runSystemctl({ "restart", u }, { 0 }, error, "systemctl restart"))
-                        return false;
-                }
-                else
+                if (!results[i].ok || !specs[i].runNow) continue;
+                if (!opt_.root.empty())
                 {
-                    // Unit новый: просто запускаем
-                    if (!runSystemctl({ "start", u }, { 0 }, error, "systemctl start"))
-                        return false;
+                    VLOG(1) << "installMany: --root mode, start of " << unitName(specs[i].name) << " skipped";
+                    continue;
                 }
+                (st[i].exists && st[i].rep.unitWritten ? toRestart : toStart).push_back(i);
             }
+            bulkSystemctl("restart", toRestart, names, results);
+            bulkSystemctl("start", toStart, names, results);
+            for (std::size_t i : toRestart) if (results[i].ok) st[i].rep.restarted = st[i].rep.started = true;
+            for (std::size_t i : toStart) if (results[i].ok) st[i].rep.started = true;
 
-            return true;
+            for (std::size_t i = 0; i < n; ++i) results[i].report = st[i].rep;
         }
 
         //---Удаление сервиса
@@ -284,42 +255,34 @@ namespace svcinst {
             }
 
             // Идемпотентность: если unit-файла нет — считаем, что уже удалено
-            const bool exists = unitFileExists(name);
+            const fs::path& root = opt_.root;
+            const bool exists = unitFileExists(name, root);
             const std::string u = unitName(name);
 
-            //---Остановка сервиса (если требуется)
-            if (stopFirst)
+            //---Остановка сервиса (если требуется; в offline-режиме останавливать нечего)
+            if (stopFirst && root.empty())
             {
                 // stop best-effort: не делаем фатальным, если юнит не найден/не запущен
                 std::string tmp;
-                runSystemctl({ "stop", u }, { 0 }, &tmp, "systemctl stop");
+                ctl({ "stop", u }, &tmp, "systemctl stop");
             }
 
             //---Отключение автозапуска (best-effort)
             {
                 std::string tmp;
-                runSystemctl({ "disable", u }, { 0 }, &tmp, "systemctl disable");
+                if (!setAutostart(name, false, root, &tmp)) { VLOG(1) << tmp; }
             }
 
             //---Удаление файла unit (если он существует)
             if (exists)
             {
-                std::error_code ec;
-                fs::remove(unitPath(name), ec);
-                if (ec)
-                {
-                    if (error)
-                    {
-                        std::ostringstream os;
-                        os << "Failed to remove unit file: " << unitPath(name).string() << " : " << ec.message();
-                        *error = os.str();
-                    }
+                if (!removeUnit(name, root, error))
                     return false;
-                }
             }
+            if (!root.empty()) return true;
 
             //---Перезагрузка конфигурации systemd (важно после удаления файла)
-            if (!runSystemctl({ "daemon-reload" }, { 0 }, error, "systemctl daemon-reload"))
+            if (!daemonReload(error))
                 return false;
 
             return true;
@@ -333,7 +296,12 @@ namespace svcinst {
                 if (error) *error = "start: invalid service name (allowed: A-Za-z0-9_.-)";
                 return false;
             }
-            return runSystemctl({ "start", unitName(name) }, { 0 }, error, "systemctl start");
+            if (!opt_.root.empty())
+            {
+                if (error) *error = "start: not available in --root (offline) mode";
+                return false;
+            }
+            return ctl({ "start", unitName(name) }, error, "systemctl start");
         }
 
         //---Остановка сервиса
@@ -344,8 +312,353 @@ namespace svcinst {
                 if (error) *error = "stop: invalid service name (allowed: A-Za-z0-9_.-)";
                 return false;
             }
-            return runSystemctl({ "stop", unitName(name) }, { 0 }, error, "systemctl stop");
+            if (!opt_.root.empty())
+            {
+                if (error) *error = "stop: not available in --root (offline) mode";
+                return false;
+            }
+            return ctl({ "stop", unitName(name) }, error, "systemctl stop");
+        }
+
+        //---Пакетное удаление: stop и disable одной командой, затем удаление файлов и один daemon-reload
+        void uninstallMany(const std::vector<std::string>& names, bool stopFirst, std::vector<BatchResult>& results) override
+        {
+            const std::size_t n = names.size();
+            results.assign(n, {});
+            const fs::path& root = opt_.root;
+
+            std::vector<std::size_t> valid;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (isValidUnitName(names[i])) { results[i].ok = true; valid.push_back(i); }
+                else fail(results[i], "uninstall: invalid service name (allowed: A-Za-z0-9_.-)");
+            }
+
+            //---stop и disable - best-effort, как и в uninstall: их ошибки в итог не попадают
+            std::vector<BatchResult> scratch(results);
+            if (stopFirst && root.empty()) bulkSystemctl("stop", valid, names, scratch);
+            if (useLinks(root))
+            {
+                for (std::size_t i : valid)
+                {
+                    std::string tmp;
+                    if (!setAutostart(names[i], false, root, &tmp)) { VLOG(1) << tmp; }
+                }
+            }
+            else
+            {
+                bulkSystemctl("disable", valid, names, scratch);
+            }
+
+            //---Удаление unit-файлов
+            bool removed = false;
+            for (std::size_t i : valid)
+            {
+                if (!unitFileExists(names[i], root)) continue;
+                if (!removeUnit(names[i], root, &results[i].error))
+                {
+                    results[i].ok = false;
+                    continue;
+                }
+                removed = true;
+            }
+            if (!root.empty() || !removed) return;
+
+            //---Один daemon-reload на весь пакет
+            std::string err;
+            if (daemonReload(&err)) return;
+            for (std::size_t i : valid)
+            {
+                if (results[i].ok) fail(results[i], err);
+            }
+        }
+
+        //---Пакетный запуск/остановка: одна команда systemctl start|stop a b c ...
+        void startMany(const std::vector<std::string>& names, std::vector<BatchResult>& results) override
+        {
+            controlMany("start", names, results);
+        }
+        void stopMany(const std::vector<std::string>& names, std::vector<BatchResult>& results) override
+        {
+            controlMany("stop", names, results);
+        }
+
+        //---Состояние unit'а на диске относительно спецификации
+        SpecState inspect(const ServiceSpec& spec) override
+        {
+            return systemd::inspectUnit(spec);
+        }
+
+        //---Состояние службы: unit-файл и симлинки - с диска, ActiveState - у systemd (не в offline-режиме)
+        bool status(const std::string& name, ServiceStatus& out, std::string* error) override
+        {
+            out = {};
+            if (!isValidUnitName(name))
+            {
+                if (error) *error = "status: invalid service name (allowed: A-Za-z0-9_.-)";
+                return false;
+            }
+
+            std::string content;
+            out.installed = systemd::readUnitFile(name, opt_.root, content);
+            out.managed = out.installed && systemd::isManagedUnit(content);
+            out.autostart = out.installed && systemd::autostartMatches(name, opt_.root, true);
+            if (!opt_.root.empty()) return true;
+
+            //---Только чтение: и в режиме --plan выполняется по-настоящему
+            std::string state;
+            if (!runSystemctl({ "show", "--property=ActiveState", "--value", unitName(name) }, { 0 }, error, "systemctl show", &state))
+                return false;
+            while (!state.empty() && (state.back() == '\n' || state.back() == '\r' || state.back() == ' ')) state.pop_back();
+            out.activeState = state;
+            return true;
+        }
+
+        //---Зависимости службы по её unit-файлу (After=*.service)
+        bool dependencies(const std::string& name, std::vector<std::string>& out, std::string* error) override
+        {
+            if (!isValidUnitName(name))
+            {
+                if (error) *error = "dependencies: invalid service name (allowed: A-Za-z0-9_.-)";
+                return false;
+            }
+            return systemd::readUnitDependencies(name, opt_.root, out, error);
+        }
+
+        //---Службы, созданные установщиком (unit'ы с маркером)
+        bool listManaged(std::vector<std::string>& names, std::string* error) override
+        {
+            return systemd::listManagedUnits(opt_.root, names, error);
+        }
+
+        //---Durability::Batch: один syncfs на каждое дерево unit'ов, в которое что-то писали
+        bool flush(std::string* error) override
+        {
+            bool ok = true;
+            for (const fs::path& root : pendingSync_)
+            {
+                if (opt_.plan) opt_.plan->add({ "syncfs", systemd::unitDir(root).string(), 0, 0, {} });
+                else if (!systemd::syncUnitFs(root, error)) ok = false;
+            }
+            pendingSync_.clear();
+            return ok;
+        }
+
+    private:
+        //---Состояние службы после записи unit'а (общая часть installOrUpdate / installMany)
+        struct Staged {
+            bool exists = false;        //	Unit-файл существовал до установки
+            bool autostartOk = false;   //	Автозапуск уже был в нужном состоянии
+            InstallReport rep;
+        };
+
+        //---Валидация спецификации, запись unit'а и (в режиме Links) симлинков - только если изменились
+        //   Симлинки создаются до daemon-reload, чтобы он их и подхватил
+        bool stageUnit(const ServiceSpec& spec, Staged& st, std::string* error)
+        {
+            //---Валидация имени сервиса
+            if (!isValidUnitName(spec.name))
+            {
+                if (error) *error = "installOrUpdate: invalid service name (allowed: A-Za-z0-9_.-)";
+                return false;
+            }
+            //---Валидация пути к исполняемому файлу
+            if (spec.exeAbs.empty() || !spec.exeAbs.is_absolute())
+            {
+                if (error) *error = "installOrUpdate: spec.exeAbs must be an absolute path";
+                return false;
+            }
+            //---Валидация зависимостей
+            if (!systemd::validateDependencies(spec, error))
+                return false;
+
+            //---Offline-режим задаёт бэкенд (--root - общий ключ запуска): spec.root только повторяет его
+            if (spec.root != opt_.root)
+            {
+                if (error) *error = "installOrUpdate: spec.root does not match the backend root (BackendOptions::root)";
+                return false;
+            }
+
+            //---Сравниваем желаемый unit с тем, что уже лежит на диске
+            std::string onDisk;
+            st.exists = systemd::readUnitFile(spec.name, opt_.root, onDisk);
+            const std::string content = systemd::renderUnit(spec);
+
+            //---Создание и запись файла unit в <root>/etc/systemd/system/<name>.service (если изменился)
+            if (!st.exists || !systemd::unitMatches(onDisk, content))
+            {
+                if (opt_.plan)
+                {
+                    opt_.plan->add({ "write", systemd::unitPath(spec.name, opt_.root).string(), content.size(), 0,
+                        st.exists ? "changed" : "new" });
+                }
+                else if (!writeUnitFile(spec, content, opt_.durability, error))
+                    return false;
+                noteWrite(opt_.root);
+                st.rep.unitWritten = true;
+            }
+
+            //---Автозапуск трогаем, только если симлинки не в нужном состоянии
+            st.autostartOk = systemd::autostartMatches(spec.name, opt_.root, spec.autostart);
+            if (useLinks(opt_.root) && !st.autostartOk)
+            {
+                if (!setAutostart(spec.name, spec.autostart, opt_.root, error))
+                    return false;
+                st.rep.autostartChanged = true;
+            }
+            return true;
+        }
+
+        static void fail(BatchResult& r, const std::string& error)
+        {
+            r.ok = false;
+            r.error = error;
+        }
+
+        //---systemctl <verb> a b c ... для служб names[idx[...]], у которых results[i].ok
+        //   Группы режутся на порции по kMaxUnitsPerCall. Если команда не прошла, порция повторяется
+        //   поштучно - так ошибка достаётся только виноватым службам. Повтор идемпотентен:
+        //   вместо restart повторяется start (уже перезапущенные не перезапускаются второй раз).
+        void bulkSystemctl(const char* verb, const std::vector<std::size_t>& idx,
+            const std::vector<std::string>& names, std::vector<BatchResult>& results)
+        {
+            constexpr std::size_t kMaxUnitsPerCall = 128;
+            const std::string what = std::string("systemctl ") + verb;
+            const char* retryVerb = (std::string_view(verb) == "restart") ? "start" : verb;
+
+            std::vector<std::size_t> part;
+            std::vector<std::string> args;
+            for (std::size_t from = 0; from < idx.size(); from += kMaxUnitsPerCall)
+            {
+                part.clear();
+                args.assign(1, verb);
+                for (std::size_t k = from; k < idx.size() && k < from + kMaxUnitsPerCall; ++k)
+                {
+                    if (!results[idx[k]].ok) continue;
+                    part.push_back(idx[k]);
+                    args.push_back(unitName(names[idx[k]]));
+                }
+                if (part.empty()) continue;
+
+                std::string err;
+                if (ctl(args, &err, what.c_str())) continue;
+                if (part.size() == 1)
+                {
+                    fail(results[part[0]], err);
+                    continue;
+                }
+
+                VLOG(1) << what << " of " << part.size() << " units failed, retrying one by one: " << err;
+                for (std::size_t i : part)
+                {
+                    if (!ctl({ retryVerb, unitName(names[i]) }, &err, what.c_str()))
+                        fail(results[i], err);
+                }
+            }
+        }
+
+        //---Общая часть startMany / stopMany
+        void controlMany(const char* verb, const std::vector<std::string>& names, std::vector<BatchResult>& results)
+        {
+            results.assign(names.size(), {});
+            std::vector<std::size_t> idx;
+            for (std::size_t i = 0; i < names.size(); ++i)
+            {
+                if (!isValidUnitName(names[i]))
+                    fail(results[i], std::string(verb) + ": invalid service name (allowed: A-Za-z0-9_.-)");
+                else if (!opt_.root.empty())
+                    fail(results[i], std::string(verb) + ": not available in --root (offline) mode");
+                else
+                {
+                    results[i].ok = true;
+                    idx.push_back(i);
+                }
+            }
+            bulkSystemctl(verb, idx, names, results);
+        }
+
+        //---daemon-reload, объединённый с параллельными экземплярами установщика
+        bool daemonReload(std::string* error)
+        {
+            if (opt_.plan) return ctl({ "daemon-reload" }, error, "systemctl daemon-reload");
+
+            bool coalesced = false;
+            const bool ok = systemd::coalescedReload(
+                [this](std::string* e) { return ctl({ "daemon-reload" }, e, "systemctl daemon-reload"); },
+                systemd::operationTimeoutMs("daemon-reload"), error, &coalesced);
+            if (ok && coalesced) { VLOG(1) << "daemon-reload: covered by a concurrent installer"; }
+            return ok;
+        }
+
+        //---Симлинки вместо systemctl: по настройке, а в offline-режиме всегда
+        bool useLinks(const fs::path& root) const
+        {
+            return opt_.enableMode == EnableMode::Links || !root.empty();
+        }
+
+        //---Включение/отключение автозапуска выбранным способом
+        //   Links: симлинки по секции [Install] без запуска процесса (работает и без systemd)
+        //   Systemctl: systemctl enable/disable
+        bool setAutostart(const std::string& name, bool enable, const fs::path& root, std::string* error)
+        {
+            if (useLinks(root))
+            {
+                noteWrite(root);
+                if (opt_.plan)
+                {
+                    if (!systemd::autostartMatches(name, root, enable))
+                        opt_.plan->add({ enable ? "link" : "unlink", unitName(name), 0, 0, "WantedBy= links under " + systemd::unitDir(root).string() });
+                    return true;
+                }
+                return enable
+                    ? systemd::enableUnitLinks(name, root, opt_.durability, error)
+                    : systemd::disableUnitLinks(name, root, opt_.durability, error);
+            }
+
+            const std::string u = unitName(name);
+            if (enable)
+                return ctl({ "enable", u }, error, "systemctl enable");
+            return ctl({ "disable", u }, error, "systemctl disable");
+        }
+
+        //---Вызов systemctl; в режиме --plan - только запись шага
+        bool ctl(const std::vector<std::string>& args, std::string* error, const char* what)
+        {
+            if (!opt_.plan) return runSystemctl(args, { 0 }, error, what);
+
+            std::string cmd = "systemctl";
+            for (const std::string& a : args) cmd += " " + a;
+            opt_.plan->add({ "systemctl", cmd, 0, 0, {} });
+            return true;
+        }
+
+        //---Удаление unit-файла; в режиме --plan - только запись шага
+        bool removeUnit(const std::string& name, const fs::path& root, std::string* error)
+        {
+            if (opt_.plan)
+            {
+                const fs::path p = systemd::unitPath(name, root);
+                std::error_code ec;
+                const std::uintmax_t size = fs::file_size(p, ec);
+                opt_.plan->add({ "remove", p.string(), ec ? 0 : (std::uint64_t)size, 0, {} });
+            }
+            else if (!systemd::removeUnitFile(name, root, opt_.durability, error))
+                return false;
+            noteWrite(root);
+            return true;
+        }
+
+        //---Запоминаем дерево для отложенного syncfs (только Durability::Batch)
+        void noteWrite(const fs::path& root)
+        {
+            if (opt_.durability != Durability::Batch) return;
+            if (std::find(pendingSync_.begin(), pendingSync_.end(), root) == pendingSync_.end())
+                pendingSync_.push_back(root);
         }
+
+    private:
+        BackendOptions opt_;
+        std::vector<fs::path> pendingSync_;     //	Корни с несброшенными изменениями (Batch)
     };
 
 } // namespace svcinst
@@ -353,9 +666,20 @@ namespace svcinst {
 namespace svcinst::platform {
 
     //---Фабричная функция для создания экземпляра бэкенда Linux/systemd
-    std::unique_ptr<IServiceBackend> makeBackend()
+    //   Default - через /bin/systemctl, SystemdDbus - прямые вызовы systemd по D-Bus
+    //   --plan записывает шаги командами systemctl, поэтому строится только systemctl-бэкендом
+    std::unique_ptr<IServiceBackend> makeBackend(const BackendOptions& opt)
     {
-        return std::make_unique<svcinst::BackendLinuxSystemd>();
+        if (opt.kind == BackendKind::SystemdDbus)
+        {
+            if (opt.plan) return nullptr;
+#if defined(SVCINST_HAVE_DBUS)
+            return systemd::makeDbusBackend(opt);
+#else
+            return nullptr;
+#endif
+        }
+        return std::make_unique<svcinst::BackendLinuxSystemd>(opt);
     }
 
 } // namespace svcinst::platform
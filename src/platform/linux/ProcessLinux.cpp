@@ -1,66 +1,807 @@
 #if defined(__linux__)
 
 #include "platform/ProcessImpl.hpp"
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#ifndef CLONE_PIDFD
+#define CLONE_PIDFD 0x00001000
+#endif
+
+extern char** environ;
+
 namespace svcinst::process::detail {
 
-	//----     Linux
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        //---pidfd_open через syscall: обёртка в glibc появилась только в 2.36
+        static int pidfdOpen(pid_t pid)
+        {
+#if defined(SYS_pidfd_open)
+            return (int)::syscall(SYS_pidfd_open, pid, 0);
+#else
+            (void)pid;
+            errno = ENOSYS;
+            return -1;
+#endif
+        }
+
+        //---Закрыть дескриптор, если он открыт
+        static void closeFd(int& fd)
+        {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+
+        //---Таймаут RunOptions (uint32_t, 0 - без ограничения) для poll/waitChild: -1 - без ограничения,
+        //   значения больше INT_MAX ограничиваются, иначе приведение дало бы отрицательное "ждать вечно"
+        static int pollMs(std::uint32_t ms, bool zeroIsInfinite)
+        {
+            if (ms == 0 && zeroIsInfinite) return -1;
+            return ms > std::uint32_t(INT_MAX) ? INT_MAX : int(ms);
+        }
+
+        //---Сколько миллисекунд осталось до дедлайна (не меньше 0)
+        static int remainingMs(Clock::time_point deadline)
+        {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            return left > 0 ? (int)left : 0;
+        }
+
+        //---Блокирующий wait4 с повтором при EINTR (rusage - ресурсы завершившегося потомка)
+        static bool waitBlocking(pid_t pid, int& status, int& err, rusage& ru)
+        {
+            for (;;)
+            {
+                if (::wait4(pid, &status, 0, &ru) >= 0) return true;
+                if (errno == EINTR) continue;
+                err = errno;
+                return false;
+            }
+        }
+
+        //---Читающий конец pipe'а stdout/stderr дочернего процесса
+        struct OutputPipe {
+            int fd = -1;                // Читающий конец (-1 - закрыт / EOF)
+            std::string* buf = nullptr; // Куда складываем данные (RunResult::stdOut/stdErr)
+            bool* truncated = nullptr;  // Флаг обрезки по лимиту
+        };
+
+        //---Одно чтение из pipe'а в буфер с ограничением cap байт.
+        //   Всё, что выше лимита, вычитывается и отбрасывается, чтобы потомок не блокировался на записи.
+        //   Возвращает false, когда читать больше нечего (EAGAIN).
+        //   ep - epoll, из которого нужно снять pipe при EOF (-1 - не зарегистрирован)
+        static bool readChunk(OutputPipe& p, std::size_t cap, int ep = -1)
+        {
+            char chunk[16 * 1024];
+            for (;;)
+            {
+                const ssize_t n = ::read(p.fd, chunk, sizeof(chunk));
+                if (n > 0)
+                {
+                    const std::size_t room = p.buf->size() < cap ? cap - p.buf->size() : 0;
+                    const std::size_t take = (std::size_t)n < room ? (std::size_t)n : room;
+                    p.buf->append(chunk, take);
+                    if (take < (std::size_t)n) *p.truncated = true;
+                    return true;
+                }
+                if (n < 0 && errno == EINTR) continue;
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return false;
+
+                //---EOF или ошибка чтения - pipe больше не нужен
+                if (ep >= 0) (void)::epoll_ctl(ep, EPOLL_CTL_DEL, p.fd, nullptr);
+                closeFd(p.fd);
+                return false;
+            }
+        }
+
+        //---Ожидание завершения дочернего процесса с одновременным чтением его вывода
+        //   timeoutMs < 0 - без ограничения времени.
+        //   Возвращает true, если процесс завершён (status заполнен),
+        //   false - таймаут (err == 0) или ошибка ожидания (err = errno)
+        static bool waitChild(pid_t pid, int pidfd, int timeoutMs,
+            OutputPipe* pipes, std::size_t pipeCount, std::size_t cap,
+            int& status, int& err, rusage& ru)
+        {
+            err = 0;
+            const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs < 0 ? 0 : timeoutMs);
+
+            for (;;)
+            {
+                pollfd fds[3]{};
+                nfds_t n = 0;
+                if (pidfd >= 0) fds[n++] = pollfd{ pidfd, POLLIN, 0 };
+                const nfds_t firstPipe = n;
+                for (std::size_t i = 0; i < pipeCount; ++i)
+                {
+                    if (pipes[i].fd >= 0) fds[n++] = pollfd{ pipes[i].fd, POLLIN, 0 };
+                }
+
+                int waitMs = (timeoutMs < 0) ? -1 : remainingMs(deadline);
+                //---Без pidfd (старые ядра) о завершении узнаём только опросом waitpid(WNOHANG)
+                if (pidfd < 0 && (waitMs < 0 || waitMs > 10)) waitMs = 10;
+
+                const int rc = ::poll(fds, n, waitMs);
+                if (rc < 0)
+                {
+                    if (errno == EINTR) continue;
+                    err = errno;
+                    return false;
+                }
+
+                //---Вычитываем всё, что пришло в pipe'ы
+                for (nfds_t i = firstPipe; i < n; ++i)
+                {
+                    if (fds[i].revents == 0) continue;
+                    for (std::size_t k = 0; k < pipeCount; ++k)
+                    {
+                        if (pipes[k].fd == fds[i].fd) { (void)readChunk(pipes[k], cap); break; }
+                    }
+                }
+
+                //---Проверяем, завершился ли процесс
+                bool exited = false;
+                if (pidfd >= 0)
+                {
+                    if (rc > 0 && (fds[0].revents & POLLIN))
+                    {
+                        if (!waitBlocking(pid, status, err, ru)) return false;
+                        exited = true;
+                    }
+                }
+                else
+                {
+                    const pid_t r = ::wait4(pid, &status, WNOHANG, &ru);
+                    if (r < 0 && errno != EINTR)
+                    {
+                        err = errno;
+                        return false;
+                    }
+                    exited = (r == pid);
+                }
+
+                if (exited)
+                {
+                    //---Процесс завершён: забираем остаток из pipe'ов, не дожидаясь EOF
+                    //   (внуки могли унаследовать дескрипторы и держать их открытыми)
+                    for (std::size_t k = 0; k < pipeCount; ++k)
+                    {
+                        if (pipes[k].fd < 0) continue;
+                        (void)::fcntl(pipes[k].fd, F_SETFL, ::fcntl(pipes[k].fd, F_GETFL) | O_NONBLOCK);
+                        while (pipes[k].fd >= 0 && readChunk(pipes[k], cap)) {}
+                    }
+                    return true;
+                }
+
+                if (timeoutMs >= 0 && remainingMs(deadline) == 0) return false;
+            }
+        }
+
+        //---Всё, что нужно потомку, подготовлено в родителе до порождения:
+        //   после fork/vfork никаких аллокаций, только async-signal-safe вызовы
+        struct SpawnRequest {
+            const char* exe = nullptr;      // Путь к исполняемому файлу
+            char* const* argv = nullptr;    // argv, завершённый nullptr
+            const char* cwd = nullptr;      // Рабочий каталог (nullptr - не менять)
+            int outFd = -1;                 // Пишущий конец pipe'а stdout (-1 - наследовать)
+            int errFd = -1;                 // Пишущий конец pipe'а stderr (-1 - наследовать)
+        };
+
+        //---Выбор стратегии: явная из RunOptions или из SVCINST_SPAWN (читается один раз)
+        static SpawnStrategy resolveStrategy(SpawnStrategy s)
+        {
+            if (s != SpawnStrategy::Default) return s;
+
+            static const SpawnStrategy fromEnv = [] {
+                const char* v = std::getenv("SVCINST_SPAWN");
+                if (v && std::strcmp(v, "fork") == 0) return SpawnStrategy::Fork;
+                if (v && std::strcmp(v, "clone") == 0) return SpawnStrategy::CloneVfork;
+                return SpawnStrategy::PosixSpawn;
+            }();
+            return fromEnv;
+        }
+
+        //---Код потомка для fork/clone: группа процессов, перенаправления, chdir, exec.
+        //   Возвращает errno, если exec (или подготовка к нему) не удалась
+        static int execChild(const SpawnRequest& rq, const sigset_t* restoreMask)
+        {
+            //---Собственная группа процессов: при таймауте убиваем всё дерево потомков
+            (void)::setpgid(0, 0);
+
+            if (rq.outFd >= 0 && ::dup2(rq.outFd, STDOUT_FILENO) < 0) return errno;
+            if (rq.errFd >= 0 && ::dup2(rq.errFd, STDERR_FILENO) < 0) return errno;
+            if (rq.cwd && ::chdir(rq.cwd) != 0) return errno;
+
+            //---clone(CLONE_VM): до снятия блокировки обработчики родителя сбрасываются в SIG_DFL
+            //   (как в posix_spawn) - иначе сигнал в этом окне выполнил бы их в памяти родителя.
+            //   Игнорируемые сигналы остаются игнорируемыми: это наследуется через exec
+            if (restoreMask)
+            {
+                for (int sig = 1; sig < NSIG; ++sig)
+                {
+                    if (sig == SIGKILL || sig == SIGSTOP) continue;
+                    struct sigaction sa {};
+                    if (::sigaction(sig, nullptr, &sa) != 0) continue;
+                    const bool caught = (sa.sa_flags & SA_SIGINFO) ? true : (sa.sa_handler != SIG_DFL && sa.sa_handler != SIG_IGN);
+                    if (!caught) continue;
+                    struct sigaction dfl {};
+                    dfl.sa_handler = SIG_DFL;
+                    sigemptyset(&dfl.sa_mask);
+                    (void)::sigaction(sig, &dfl, nullptr);
+                }
+                (void)::sigprocmask(SIG_SETMASK, restoreMask, nullptr);
+            }
+
+            ::execve(rq.exe, rq.argv, environ);
+            return errno;
+        }
+
+        //---fork() + execve. Ошибка exec передаётся родителю через CLOEXEC-pipe:
+        //   при успешном exec pipe просто закрывается и родитель читает 0 байт
+        static int spawnFork(const SpawnRequest& rq, pid_t& pid)
+        {
+            int report[2];
+            if (::pipe2(report, O_CLOEXEC) != 0) return errno;
+
+            pid = ::fork();
+            if (pid < 0)
+            {
+                const int e = errno;
+                ::close(report[0]);
+                ::close(report[1]);
+                return e;
+            }
+
+            if (pid == 0)
+            {
+                ::close(report[0]);
+                const int e = execChild(rq, nullptr);
+                (void)!::write(report[1], &e, sizeof(e));
+                ::_exit(127);
+            }
+
+            ::close(report[1]);
+            int childErr = 0;
+            ssize_t n;
+            do { n = ::read(report[0], &childErr, sizeof(childErr)); } while (n < 0 && errno == EINTR);
+            ::close(report[0]);
+
+            //---Дублируем setpgid в родителе, чтобы kill(-pid) работал без гонки с потомком
+            (void)::setpgid(pid, pid);
+
+            if (n == (ssize_t)sizeof(childErr) && childErr != 0)
+            {
+                int st = 0;
+                while (::waitpid(pid, &st, 0) < 0 && errno == EINTR) {}
+                return childErr;
+            }
+            return 0;
+        }
+
+        //---posix_spawn: glibc порождает потомка через clone(CLONE_VM|CLONE_VFORK),
+        //   ошибки exec возвращаются кодом возврата
+        static int spawnPosix(const SpawnRequest& rq, pid_t& pid)
+        {
+            posix_spawn_file_actions_t fa;
+            posix_spawnattr_t attr;
+            (void)posix_spawn_file_actions_init(&fa);
+            (void)posix_spawnattr_init(&attr);
+
+            if (rq.outFd >= 0) (void)posix_spawn_file_actions_adddup2(&fa, rq.outFd, STDOUT_FILENO);
+            if (rq.errFd >= 0) (void)posix_spawn_file_actions_adddup2(&fa, rq.errFd, STDERR_FILENO);
+            if (rq.cwd) (void)posix_spawn_file_actions_addchdir_np(&fa, rq.cwd);
+
+            //---Собственная группа процессов (аналог setpgid(0, 0) в потомке)
+            (void)posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+            (void)posix_spawnattr_setpgroup(&attr, 0);
+
+            const int rc = ::posix_spawn(&pid, rq.exe, &fa, &attr, rq.argv, environ);
+
+            (void)posix_spawnattr_destroy(&attr);
+            (void)posix_spawn_file_actions_destroy(&fa);
+            return rc;
+        }
+
+        //---Контекст потомка clone(): память общая с родителем (CLONE_VM),
+        //   поэтому код ошибки exec записывается прямо сюда
+        struct CloneChild {
+            const SpawnRequest* rq = nullptr;
+            const sigset_t* restoreMask = nullptr;
+            int err = 0;
+        };
+
+        static int cloneChildMain(void* p)
+        {
+            auto* c = static_cast<CloneChild*>(p);
+            c->err = execChild(*c->rq, c->restoreMask);
+            ::_exit(127);
+        }
+
+        //---clone(CLONE_VM|CLONE_VFORK|CLONE_PIDFD): родитель приостановлен до exec/_exit потомка,
+        //   таблицы страниц не копируются, pidfd возвращается самим вызовом.
+        //   На время clone все сигналы заблокированы: обработчик в потомке работал бы в памяти родителя
+        static int spawnClone(const SpawnRequest& rq, pid_t& pid, int& pidfd)
+        {
+            constexpr std::size_t kStackSize = 64 * 1024;
+            void* stack = ::mmap(nullptr, kStackSize, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+            if (stack == MAP_FAILED) return errno;
+
+            sigset_t all, old;
+            sigfillset(&all);
+            (void)::pthread_sigmask(SIG_SETMASK, &all, &old);
+
+            CloneChild child{ &rq, &old, 0 };
+            pidfd = -1;
+            pid = ::clone(cloneChildMain, static_cast<char*>(stack) + kStackSize,
+                CLONE_VM | CLONE_VFORK | CLONE_PIDFD | SIGCHLD, &child, &pidfd);
+            const int cloneErr = (pid < 0) ? errno : 0;
+
+            (void)::pthread_sigmask(SIG_SETMASK, &old, nullptr);
+            ::munmap(stack, kStackSize);
+
+            if (cloneErr != 0)
+            {
+                pidfd = -1;
+                return cloneErr;
+            }
+
+            if (child.err != 0)
+            {
+                int st = 0;
+                while (::waitpid(pid, &st, 0) < 0 && errno == EINTR) {}
+                closeFd(pidfd);
+                return child.err;
+            }
+            return 0;
+        }
+
+
+        //---Запущенный потомок: pid, pidfd (если есть) и читающие концы pipe'ов захвата
+        struct SpawnedChild {
+            pid_t pid = -1;
+            int pidfd = -1;
+            int outFd = -1;
+            int errFd = -1;
+        };
+
+        //---Подготовка pipe'ов и argv, порождение выбранной стратегией.
+        //   Возвращает 0 или errno; при ошибке все дескрипторы закрыты
+        static int spawnChild(const fs::path& exe, const std::vector<std::string>& args,
+            const RunOptions& opt, SpawnedChild& child)
+        {
+            child = {};
+
+            //---Pipe'ы для захвата вывода (O_CLOEXEC: в потомке остаются только dup2-копии)
+            int outPipe[2] = { -1, -1 };
+            int errPipe[2] = { -1, -1 };
+            if (opt.captureOutput)
+            {
+                if (::pipe2(outPipe, O_CLOEXEC) != 0 || ::pipe2(errPipe, O_CLOEXEC) != 0)
+                {
+                    const int e = errno;
+                    closeFd(outPipe[0]); closeFd(outPipe[1]);
+                    closeFd(errPipe[0]); closeFd(errPipe[1]);
+                    return e;
+                }
+            }
+
+            //---argv собираем до порождения: указатели на строки exe/args живы до конца вызова
+            const std::string exeStr = exe.string();
+            std::vector<char*> argv;
+            argv.reserve(args.size() + 2);
+            argv.push_back(const_cast<char*>(exeStr.c_str()));
+            for (const auto& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+            argv.push_back(nullptr);
+
+            SpawnRequest rq;
+            rq.exe = exeStr.c_str();
+            rq.argv = argv.data();
+            rq.cwd = opt.workingDir.empty() ? nullptr : opt.workingDir.c_str();
+            rq.outFd = outPipe[1];
+            rq.errFd = errPipe[1];
+
+            int spawnErr = 0;
+            switch (resolveStrategy(opt.spawn))
+            {
+            case SpawnStrategy::Fork:       spawnErr = spawnFork(rq, child.pid); break;
+            case SpawnStrategy::CloneVfork: spawnErr = spawnClone(rq, child.pid, child.pidfd); break;
+            default:                        spawnErr = spawnPosix(rq, child.pid); break;
+            }
+
+            //---Пишущие концы нужны только потомку
+            closeFd(outPipe[1]);
+            closeFd(errPipe[1]);
+
+            if (spawnErr != 0)
+            {
+                closeFd(outPipe[0]);
+                closeFd(errPipe[0]);
+                child = {};
+                return spawnErr;
+            }
+
+            child.outFd = outPipe[0];
+            child.errFd = errPipe[0];
+            return 0;
+        }
+
+        //---Учёт ресурсов потомка: rusage из wait4 + время от запуска до завершения
+        static void fillStats(RunStats& st, const rusage& ru, Clock::time_point started)
+        {
+            const auto tvUs = [](const timeval& tv) {
+                return (std::uint64_t)tv.tv_sec * 1000000u + (std::uint64_t)tv.tv_usec;
+            };
+            st.wallUs = (std::uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count();
+            st.userCpuUs = tvUs(ru.ru_utime);
+            st.sysCpuUs = tvUs(ru.ru_stime);
+            st.maxRssKb = (std::uint64_t)ru.ru_maxrss;    // В Linux ru_maxrss уже в КиБ
+            st.volCtxSwitches = (std::uint64_t)ru.ru_nvcsw;
+            st.involCtxSwitches = (std::uint64_t)ru.ru_nivcsw;
+        }
+
+        //---Код завершения из статуса waitpid (сигнал -> 128 + номер)
+        static int exitCodeFromStatus(int status)
+        {
+            if (WIFEXITED(status)) return WEXITSTATUS(status);
+            if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+            return 1;
+        }
+
+    } // namespace
+
+    //---Платформенно-специфичная реализация запуска процесса для Linux
     bool runPlatform(const fs::path& exe, const std::vector<std::string>& args,
         RunResult& out, const RunOptions& opt)
     {
-        out = {};
+        out.reset();
 
-        pid_t pid = fork();
-        if (pid < 0)
+        const auto startedAt = Clock::now();
+        SpawnedChild child;
+        const int spawnErr = spawnChild(exe, args, opt, child);
+        if (spawnErr != 0)
         {
             out.started = false;
-            out.sysError = (std::uint32_t)errno;
+            out.sysError = (std::uint32_t)spawnErr;
             out.exitCode = (int)out.sysError;
             return false;
         }
 
-        if (pid == 0)
-        {
-            if (!opt.workingDir.empty())
-                (void)chdir(opt.workingDir.c_str());
+        out.started = true;
 
-            std::vector<std::string> argvStorage;
-            argvStorage.reserve(args.size() + 1);
-            argvStorage.push_back(exe.string());
-            argvStorage.insert(argvStorage.end(), args.begin(), args.end());
+        const pid_t pid = child.pid;
+        int pidfd = child.pidfd;
+        OutputPipe pipes[2] = {
+            { child.outFd, &out.stdOut, &out.stdOutTruncated },
+            { child.errFd, &out.stdErr, &out.stdErrTruncated },
+        };
+        const std::size_t pipeCount = opt.captureOutput ? 2 : 0;
 
-            std::vector<char*> argv;
-            argv.reserve(argvStorage.size() + 1);
-            for (auto& s : argvStorage) argv.push_back(s.data());
-            argv.push_back(nullptr);
+        int status = 0;
+        int err = 0;
+        rusage ru{};
+        bool exited = false;
+
+        if (opt.timeoutMs == 0 && pipeCount == 0)
+        {
+            //---Без таймаута и захвата: обычное блокирующее ожидание
+            exited = waitBlocking(pid, status, err, ru);
+        }
+        else
+        {
+            if (pidfd < 0) pidfd = pidfdOpen(pid);
+            const int timeoutMs = pollMs(opt.timeoutMs, true);
+            exited = waitChild(pid, pidfd, timeoutMs, pipes, pipeCount, opt.maxCaptureBytes, status, err, ru);
 
-            execv(exe.c_str(), argv.data());
-            _exit(127); // exec failed
+            //---Таймаут: SIGTERM всей группе, после паузы killGraceMs - SIGKILL
+            if (!exited && err == 0)
+            {
+                out.timedOut = true;
+                (void)::kill(-pid, SIGTERM);
+                exited = waitChild(pid, pidfd, pollMs(opt.killGraceMs, false), pipes, pipeCount, opt.maxCaptureBytes, status, err, ru);
+                if (!exited && err == 0)
+                {
+                    (void)::kill(-pid, SIGKILL);
+                    exited = waitChild(pid, pidfd, -1, pipes, pipeCount, opt.maxCaptureBytes, status, err, ru);
+                }
+            }
         }
 
-        out.started = true;
+        closeFd(pidfd);
+        closeFd(pipes[0].fd);
+        closeFd(pipes[1].fd);
 
-        int status = 0;
-        // timeoutMs     (    waitpid(WNOHANG))
-        if (waitpid(pid, &status, 0) < 0)
+        if (!exited)
         {
-            out.sysError = (std::uint32_t)errno;
+            out.sysError = (std::uint32_t)err;
             out.exitCode = (int)out.sysError;
             return false;
         }
 
-        if (WIFEXITED(status))
-            out.exitCode = WEXITSTATUS(status);
-        else if (WIFSIGNALED(status))
-            out.exitCode = 128 + WTERMSIG(status);
-        else
-            out.exitCode = 1;
-
+        out.exitCode = exitCodeFromStatus(status);
+        fillStats(out.stats, ru, startedAt);
         return true;
     }
 
+    namespace {
+
+        //---Асинхронный движок для Linux: один epoll на pidfd'ы и pipe'ы всех потомков
+        class LinuxAsyncEngine final : public AsyncEngine {
+        public:
+            LinuxAsyncEngine()
+                : ep_(::epoll_create1(EPOLL_CLOEXEC))
+            {
+            }
+
+            ~LinuxAsyncEngine() override
+            {
+                //---Незавершённых потомков не бросаем зомби: убиваем группу и дожидаемся
+                for (auto& c : children_)
+                {
+                    (void)::kill(-c->pid, SIGKILL);
+                    int st = 0;
+                    while (::waitpid(c->pid, &st, 0) < 0 && errno == EINTR) {}
+                    closeChildFds(*c);
+                }
+                closeFd(ep_);
+            }
+
+            bool spawn(const fs::path& exe, const std::vector<std::string>& args,
+                const RunOptions& opt, RunCallback cb) override
+            {
+                auto c = std::make_unique<Child>();
+                c->startedAt = Clock::now();
+                c->cb = std::move(cb);
+                c->cap = opt.maxCaptureBytes;
+                c->killGraceMs = opt.killGraceMs;
+
+                SpawnedChild sp;
+                const int spawnErr = (ep_ < 0) ? errno : spawnChild(exe, args, opt, sp);
+                if (spawnErr != 0)
+                {
+                    //---Ошибка запуска доставляется тем же колбэком на следующей итерации цикла
+                    c->result.sysError = (std::uint32_t)spawnErr;
+                    c->result.exitCode = (int)c->result.sysError;
+                    ready_.push_back(std::move(c));
+                    return false;
+                }
+
+                c->pid = sp.pid;
+                c->pidfd = (sp.pidfd >= 0) ? sp.pidfd : pidfdOpen(sp.pid);
+                c->result.started = true;
+                c->pipes[0] = { sp.outFd, &c->result.stdOut, &c->result.stdOutTruncated };
+                c->pipes[1] = { sp.errFd, &c->result.stdErr, &c->result.stdErrTruncated };
+                if (opt.timeoutMs != 0)
+                    c->deadline = Clock::now() + std::chrono::milliseconds(opt.timeoutMs);
+
+                //---Без pidfd (старое ядро) ждём синхронно: поведение как у process::run
+                if (c->pidfd < 0)
+                {
+                    finishBlocking(*c, opt);
+                    ready_.push_back(std::move(c));
+                    return true;
+                }
+
+                watch(c->pidfd, c.get(), kPidTag);
+                for (std::size_t k = 0; k < 2; ++k)
+                {
+                    if (c->pipes[k].fd < 0) continue;
+                    (void)::fcntl(c->pipes[k].fd, F_SETFL, ::fcntl(c->pipes[k].fd, F_GETFL) | O_NONBLOCK);
+                    watch(c->pipes[k].fd, c.get(), k);
+                }
+                children_.push_back(std::move(c));
+                return true;
+            }
+
+            bool poll(int timeoutMs) override
+            {
+                if (!ready_.empty())
+                {
+                    deliverReady();
+                    return pending() != 0;
+                }
+                if (children_.empty()) return false;
+
+                //---Ждём не дольше ближайшего дедлайна таймаута
+                int waitMs = timeoutMs;
+                for (const auto& c : children_)
+                {
+                    if (c->deadline == Clock::time_point{}) continue;
+                    const int left = remainingMs(c->deadline);
+                    if (waitMs < 0 || left < waitMs) waitMs = left;
+                }
+
+                epoll_event evs[64];
+                const int n = ::epoll_wait(ep_, evs, 64, waitMs);
+                for (int i = 0; i < n; ++i)
+                {
+                    const std::uint64_t tag = evs[i].data.u64;
+                    Child* c = reinterpret_cast<Child*>(tag & ~kTagMask);
+                    const std::uint64_t kind = tag & kTagMask;
+                    if (kind == kPidTag) c->exited = true;
+                    else (void)readChunk(c->pipes[kind], c->cap, ep_);
+                }
+
+                enforceDeadlines();
+                collectExited();
+                deliverReady();
+                return pending() != 0;
+            }
+
+            std::size_t pending() const override
+            {
+                return children_.size() + ready_.size();
+            }
+
+        private:
+            //---Метки в epoll_event.data: указатель на Child + младшие биты - источник события
+            static constexpr std::uint64_t kTagMask = 0x3;
+            static constexpr std::uint64_t kPidTag = 2;
+
+            struct Child {
+                pid_t pid = -1;
+                int pidfd = -1;
+                OutputPipe pipes[2];
+                RunResult result;
+                RunCallback cb;
+                std::size_t cap = 0;
+                std::uint32_t killGraceMs = 0;
+                Clock::time_point startedAt{};  // Момент запуска (для RunStats::wallUs)
+                Clock::time_point deadline{};   // {} - без таймаута
+                int killStage = 0;              // 0 - работает, 1 - отправлен SIGTERM, 2 - SIGKILL
+                bool exited = false;
+            };
+            static_assert(alignof(Child) > kTagMask, "Child pointer must leave room for tag bits");
+
+            void watch(int fd, Child* c, std::uint64_t kind)
+            {
+                epoll_event ev{};
+                ev.events = EPOLLIN;
+                ev.data.u64 = reinterpret_cast<std::uint64_t>(c) | kind;
+                (void)::epoll_ctl(ep_, EPOLL_CTL_ADD, fd, &ev);
+            }
+
+            //---Явный EPOLL_CTL_DEL перед close(): если описание файла ещё где-то живо,
+            //   close() не снимает регистрацию и epoll продолжит отдавать события с висячим указателем
+            void closeChildFds(Child& c)
+            {
+                for (int* fd : { &c.pidfd, &c.pipes[0].fd, &c.pipes[1].fd })
+                {
+                    if (*fd >= 0 && ep_ >= 0) (void)::epoll_ctl(ep_, EPOLL_CTL_DEL, *fd, nullptr);
+                    closeFd(*fd);
+                }
+            }
+
+            //---Синхронное ожидание (запасной путь без pidfd)
+            void finishBlocking(Child& c, const RunOptions& opt)
+            {
+                int status = 0;
+                int err = 0;
+                rusage ru{};
+                const std::size_t pipeCount = opt.captureOutput ? 2 : 0;
+                const int timeoutMs = pollMs(opt.timeoutMs, true);
+                bool exited = waitChild(c.pid, -1, timeoutMs, c.pipes, pipeCount, c.cap, status, err, ru);
+                if (!exited && err == 0)
+                {
+                    c.result.timedOut = true;
+                    (void)::kill(-c.pid, SIGTERM);
+                    exited = waitChild(c.pid, -1, pollMs(c.killGraceMs, false), c.pipes, pipeCount, c.cap, status, err, ru);
+                    if (!exited && err == 0)
+                    {
+                        (void)::kill(-c.pid, SIGKILL);
+                        exited = waitChild(c.pid, -1, -1, c.pipes, pipeCount, c.cap, status, err, ru);
+                    }
+                }
+                closeChildFds(c);
+                if (exited)
+                {
+                    c.result.exitCode = exitCodeFromStatus(status);
+                    fillStats(c.result.stats, ru, c.startedAt);
+                }
+                else
+                {
+                    c.result.sysError = (std::uint32_t)err;
+                    c.result.exitCode = (int)err;
+                }
+            }
+
+            //---Истёкшие таймауты: SIGTERM группе, после killGraceMs - SIGKILL
+            void enforceDeadlines()
+            {
+                const auto now = Clock::now();
+                for (auto& c : children_)
+                {
+                    if (c->exited || c->deadline == Clock::time_point{} || now < c->deadline) continue;
+                    if (c->killStage == 0)
+                    {
+                        c->result.timedOut = true;
+                        (void)::kill(-c->pid, SIGTERM);
+                        c->killStage = 1;
+                        c->deadline = now + std::chrono::milliseconds(c->killGraceMs);
+                    }
+                    else
+                    {
+                        (void)::kill(-c->pid, SIGKILL);
+                        c->killStage = 2;
+                        c->deadline = {};
+                    }
+                }
+            }
+
+            //---Завершившиеся потомки: waitpid, остаток вывода, перенос в очередь доставки
+            void collectExited()
+            {
+                for (std::size_t i = 0; i < children_.size();)
+                {
+                    Child& c = *children_[i];
+                    if (!c.exited) { ++i; continue; }
+
+                    int status = 0;
+                    int err = 0;
+                    rusage ru{};
+                    if (waitBlocking(c.pid, status, err, ru))
+                    {
+                        c.result.exitCode = exitCodeFromStatus(status);
+                        fillStats(c.result.stats, ru, c.startedAt);
+                    }
+                    else
+                    {
+                        c.result.sysError = (std::uint32_t)err;
+                        c.result.exitCode = (int)err;
+                    }
+                    for (auto& p : c.pipes)
+                    {
+                        while (p.fd >= 0 && readChunk(p, c.cap, ep_)) {}
+                    }
+                    closeChildFds(c);
+
+                    ready_.push_back(std::move(children_[i]));
+                    children_[i] = std::move(children_.back());
+                    children_.pop_back();
+                }
+            }
+
+            //---Вызов колбэков. Колбэк может запускать новых потомков, поэтому очередь забирается целиком
+            void deliverReady()
+            {
+                std::vector<std::unique_ptr<Child>> batch;
+                batch.swap(ready_);
+                for (auto& c : batch)
+                {
+                    if (c->cb) c->cb(c->result);
+                }
+            }
+
+            int ep_ = -1;
+            std::vector<std::unique_ptr<Child>> children_;
+            std::vector<std::unique_ptr<Child>> ready_;
+        };
+
+    } // namespace
+
+    //---Фабрика асинхронного движка для Linux
+    std::unique_ptr<AsyncEngine> makeAsyncEngine()
+    {
+        return std::make_unique<LinuxAsyncEngine>();
+    }
+
 } // namespace svcinst::process::detail
 #endif
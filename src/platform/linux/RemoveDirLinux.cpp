@@ -1,11 +1,38 @@
 #if defined(__linux__)
 
 #include "service_installer/Platform.hpp"
+#include "platform/PlatformImpl.hpp"
+#include "platform/linux/RemoveTree.hpp"
+#include "platform/linux/RuntimeLocks.hpp"
+#include "Log.hpp"
 
-#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <ctime>
 #include <filesystem>
+#include <set>
 #include <string>
 #include <system_error>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/random.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef RENAME_NOREPLACE
+#define RENAME_NOREPLACE (1 << 0)
+#endif
 
 namespace svcinst::platform {
     namespace fs = std::filesystem;
@@ -24,7 +51,7 @@ namespace svcinst::platform {
         return false;
     }
 
-    static bool removeTreeNow(const fs::path& dir, std::string* error)
+    static bool removeTreeNow(const fs::path& dir, const DeleteThrottle& throttle, const PathFilter* filter, std::string* error)
     {
         if (dir.empty()) return true;
 
@@ -34,75 +61,638 @@ namespace svcinst::platform {
             return false;
         }
 
+        const auto t0 = std::chrono::steady_clock::now();
+        RemoveTreeOptions opt;
+        opt.throttle = throttle;
+        opt.filter = filter;
+        RemoveTreeStats st;
+        const bool ok = removeTree(dir, opt, st, error);
+        if (st.files || st.dirs || st.kept)
+        {
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+            LOG(INFO) << "removed " << dir.string() << ": " << st.files << " file(s), " << st.dirs << " dir(s), "
+                << st.bytes << " bytes in " << ms << " ms" << (st.kept ? ", " + std::to_string(st.kept) + " entr" + (st.kept == 1 ? "y" : "ies") + " kept" : std::string());
+        }
+        return ok;
+    }
+
+    //---Удаление на месте не удалось (занятые файлы и т.п.): остаток дочистит уборщик
+    //   после выхода нашего процесса (разовый запуск) или через kDeferDelayMs (агент/поток)
+    static bool deferRemove(const fs::path& dir, const DeleteThrottle& throttle, const PathFilter* filter, const std::string& why,
+        DeferredRemove* defer, std::string* error)
+    {
+        const bool untilExit = !defer || defer->untilExit;
+        ReclaimJob job;
+        job.target = dir;
+        job.wholeDir = true;
+        job.afterExit = untilExit;
+        job.delayMs = untilExit ? 0 : kDeferDelayMs;
+        job.throttle = throttle;
+        if (filter) job.filter = *filter;
+
+        fs::path status;
+        std::string err;
+        if (!startReclaimer(job, &status, &err))
+        {
+            if (error) *error = why + "; defer failed: " + err;
+            return false;
+        }
+        LOG(WARNING) << why << "; removal deferred " << (untilExit ? "until exit" : "to a background reclaimer") << ", status: " << status.string();
+        if (defer)
+        {
+            defer->deferred = true;
+            defer->statusFile = status;
+        }
+        return true;
+    }
+
+    bool removeInstallDir(const fs::path& installDir, std::string* error, bool /*fromInno*/, const DeleteThrottle& throttle, DeferredRemove* defer)
+    {
+        std::string err;
+        if (removeTreeNow(installDir, throttle, nullptr, &err))
+            return true;
+
+        return deferRemove(installDir, throttle, nullptr, err, defer, error);
+    }
+
+    bool removeDataRoot(const fs::path& dataRoot, std::string* error, const DeleteThrottle& throttle, const PathFilter* filter, DeferredRemove* defer)
+    {
+        std::string err;
+        if (removeTreeNow(dataRoot, throttle, filter, &err))
+            return true;
+
+        return deferRemove(dataRoot, throttle, filter, err, defer, error);
+    }
+
+    bool estimateRemoveDir(const fs::path& dir, std::uint64_t& files, std::uint64_t& bytes, std::string* error, const PathFilter* filter)
+    {
+        files = bytes = 0;
+        if (dir.empty()) return true;
+
+        if (isDangerousPath(dir))
+        {
+            if (error) *error = "Refuse to delete dangerous path: " + dir.string();
+            return false;
+        }
+
         std::error_code ec;
         if (!fs::exists(dir, ec)) return true;
 
-        ec.clear();
-        (void)fs::remove_all(dir, ec);
-        if (!ec) return true;
+        //---Обход без перехода по симлинкам (remove_all их тоже не раскрывает); с фильтром -
+        //   курсор на каждый уровень, оставленные каталоги не читаются
+        const bool filtered = filter && filter->active();
+        std::vector<PathFilter::Cursor> cursors;
+        if (filtered) cursors.push_back(filter->root());
+        fs::recursive_directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec))
+        {
+            std::error_code sec;
+            const fs::file_status st = it->symlink_status(sec);
+            if (sec)
+            {
+                if (filtered) it.disable_recursion_pending();
+                continue;
+            }
+            if (filtered)
+            {
+                cursors.resize(std::size_t(it.depth()) + 1);
+                PathFilter::Cursor child;
+                const PathFilter::Action action = filter->visit(cursors.back(), it->path().filename().string(), fs::is_directory(st), child);
+                if (action == PathFilter::Action::Keep)
+                {
+                    if (fs::is_directory(st)) it.disable_recursion_pending();
+                    continue;
+                }
+                //---Remove: ниже фильтр ничего не оставит - курсор "выбрано всё"
+                if (fs::is_directory(st)) cursors.push_back(action == PathFilter::Action::Descend ? std::move(child) : PathFilter::Cursor{});
+            }
+            if (fs::is_directory(st)) continue;
+            ++files;
+            if (!fs::is_regular_file(st)) continue;
+            const std::uintmax_t n = it->file_size(sec);
+            if (!sec) bytes += n;
+        }
+        return true;
+    }
 
-        if (error) *error = "remove_all failed for '" + dir.string() + "': " + ec.message();
-        return false;
+
+    //---Корзина: <корень файловой системы>/.svcinst-trash
+    static constexpr const char* kTrashName = ".svcinst-trash";
+
+    static std::string sysError(const std::string& what)
+    {
+        return what + ": " + std::error_code(errno, std::generic_category()).message();
     }
 
-    static bool deferRemoveWithSh(const fs::path& installDir,
-        const fs::path& dataRoot,
-        std::string* error)
+    //---Корзина пригодна: каталог (не симлинк) нашего пользователя, запись - только владельцу
+    static bool checkTrashDir(const fs::path& trash, std::string* error)
     {
-        pid_t pid = fork();
-        if (pid < 0)
+        struct stat st {};
+        if (::lstat(trash.c_str(), &st) != 0)
+        {
+            if (error) *error = sysError("trash: stat " + trash.string());
+            return false;
+        }
+        if (!S_ISDIR(st.st_mode) || st.st_uid != ::geteuid() || (st.st_mode & 022) != 0)
         {
-            if (error) *error = "fork() failed";
+            if (error) *error = "trash: " + trash.string() + " is not a directory owned by us with mode 0700";
             return false;
         }
+        return true;
+    }
 
-        if (pid == 0)
+    //---Корень файловой системы, в которой лежит dir: подъём, пока st_dev не меняется
+    //   (rename возможен только внутри одной ФС)
+    static bool filesystemRoot(const fs::path& dir, fs::path& root, std::string* error)
+    {
+        struct stat self {}, up {};
+        fs::path cur = dir.parent_path();
+        if (::lstat(dir.c_str(), &self) != 0 || ::stat(cur.c_str(), &up) != 0)
+        {
+            if (error) *error = sysError("trash: stat " + dir.string());
+            return false;
+        }
+        if (up.st_dev != self.st_dev)
+        {
+            if (error) *error = "trash: " + dir.string() + " is a mount point";
+            return false;
+        }
+        while (cur != cur.root_path())
+        {
+            const fs::path next = cur.parent_path();
+            if (::stat(next.c_str(), &up) != 0 || up.st_dev != self.st_dev) break;
+            cur = next;
+        }
+        root = cur;
+        return true;
+    }
+
+    bool moveToTrash(const fs::path& dir, fs::path& trash, std::string* error)
+    {
+        trash.clear();
+        if (dir.empty()) return true;
+
+        if (isDangerousPath(dir))
+        {
+            if (error) *error = "Refuse to delete dangerous path: " + dir.string();
+            return false;
+        }
+
+        std::error_code ec;
+        fs::path abs = fs::absolute(dir, ec);
+        if (ec) abs = dir;
+        abs = abs.lexically_normal();
+        if (!abs.has_filename()) abs = abs.parent_path();
+
+        struct stat st {};
+        if (::lstat(abs.c_str(), &st) != 0 && errno == ENOENT) return true;
+
+        fs::path root;
+        if (!filesystemRoot(abs, root, error)) return false;
+
+        const fs::path bin = root / kTrashName;
+        if (::mkdir(bin.c_str(), 0700) != 0 && errno != EEXIST)
         {
-            (void)chdir("/");
+            if (error) *error = sysError("trash: mkdir " + bin.string());
+            return false;
+        }
+        if (!checkTrashDir(bin, error)) return false;
 
-            execl("/bin/sh", "sh", "-c",
-                "sleep 2; "
-                "[ -n \"$1\" ] && rm -rf -- \"$1\" >/dev/null 2>&1; "
-                "[ -n \"$2\" ] && rm -rf -- \"$2\" >/dev/null 2>&1",
-                "sh",
-                installDir.c_str(),
-                dataRoot.c_str(),
-                (char*)nullptr);
+        //---Уникальное имя: <имя>.<время>.<pid>.<счётчик>; RENAME_NOREPLACE - не затереть чужое
+        static std::atomic<std::uint32_t> counter{ 0 };
+        const fs::path target = bin / (abs.filename().string() + "." + std::to_string(::time(nullptr)) + "." +
+            std::to_string(::getpid()) + "." + std::to_string(++counter));
 
-            _exit(127);
+        long rc = ::syscall(SYS_renameat2, AT_FDCWD, abs.c_str(), AT_FDCWD, target.c_str(), RENAME_NOREPLACE);
+        if (rc != 0 && (errno == ENOSYS || errno == EINVAL))
+        {
+            //---Без RENAME_NOREPLACE (старое ядро, ФС без поддержки): имя сначала занимается mkdir
+            //   (EEXIST - чужое), затем rename заменяет только этот собственный пустой каталог
+            rc = ::mkdir(target.c_str(), 0700);
+            if (rc == 0 && (rc = ::rename(abs.c_str(), target.c_str())) != 0)
+            {
+                const int saved = errno;
+                ::rmdir(target.c_str());
+                errno = saved;
+            }
+        }
+        if (rc != 0)
+        {
+            if (error) *error = sysError("trash: rename " + abs.string() + " -> " + target.string());
+            return false;
         }
 
+        LOG(INFO) << "moved " << abs.string() << " to " << target.string();
+        trash = bin;
         return true;
     }
 
-    bool removeInstallDir(const fs::path& installDir, std::string* error, bool /*fromInno*/)
+    //---Файл состояния уборщика: /run/svcinst/reclaim/<путь в стиле systemd-escape --path>.status
+    static fs::path reclaimStatusPath(const fs::path& target)
     {
-        std::string err;
-        if (removeTreeNow(installDir, &err))
-            return true;
+        std::string p = target.lexically_normal().string();
+        while (p.size() > 1 && p.back() == '/') p.pop_back();
+        std::size_t from = p.find_first_not_of('/');
+        if (from == std::string::npos) from = p.size();
 
-        std::string err2;
-        if (deferRemoveWithSh(installDir, fs::path{}, &err2))
-            return true;
+        static const char* hex = "0123456789abcdef";
+        std::string name;
+        for (std::size_t i = from; i < p.size(); ++i)
+        {
+            const unsigned char c = (unsigned char)p[i];
+            if (c == '/') name.push_back('-');
+            else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || (c == '.' && i != from)) name.push_back(char(c));
+            else
+            {
+                name += "\\x";
+                name.push_back(hex[c >> 4]);
+                name.push_back(hex[c & 0xF]);
+            }
+        }
+        if (name.empty()) name = "-";
+        return systemd::runtimeDir() / "reclaim" / (name + ".status");
+    }
 
-        if (error) *error = err + "; defer failed: " + err2;
-        return false;
+    //---Запись состояния: key=value построчно, атомарно (временный файл + rename)
+    class ReclaimStatus final {
+    public:
+        explicit ReclaimStatus(const fs::path& target)
+            : target_(target), path_(reclaimStatusPath(target))
+        {
+            std::error_code ec;
+            fs::create_directories(path_.parent_path(), ec);
+        }
+
+        void write(const char* state, const RemoveTreeStats* st = nullptr, const std::string& error = {})
+        {
+            std::string s;
+            s += std::string("state=") + state + "\n";
+            s += "target=" + target_.string() + "\n";
+            s += "pid=" + std::to_string(::getpid()) + "\n";
+            s += "updated=" + std::to_string(::time(nullptr)) + "\n";
+            if (st)
+            {
+                s += "files=" + std::to_string(st->files) + "\n";
+                s += "dirs=" + std::to_string(st->dirs) + "\n";
+                s += "bytes=" + std::to_string(st->bytes) + "\n";
+                if (st->kept) s += "kept=" + std::to_string(st->kept) + "\n";
+            }
+            if (!error.empty()) s += "error=" + error + "\n";
+
+            const fs::path tmp = path_.string() + "." + std::to_string(::getpid()) + ".tmp";
+            const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) return;
+            const bool ok = ::write(fd, s.data(), s.size()) == ssize_t(s.size());
+            ::close(fd);
+            if (!ok || ::rename(tmp.c_str(), path_.c_str()) != 0) ::unlink(tmp.c_str());
+        }
+
+    private:
+        fs::path target_;
+        fs::path path_;
+    };
+
+    //---Допуск уборщика: одноразовый билет /run/svcinst/reclaim/tickets/<token> (каталог 0700, файл 0600)
+    //   с видом и целью задания. Билеты выписывает только startReclaimer, поэтому --reclaim/--reclaim-dir,
+    //   запущенные вручную, ничего не удаляют: токен передаётся уборщику в --wait-for
+    constexpr std::size_t kTicketBytes = 16;
+
+    static fs::path ticketDir()
+    {
+        return systemd::runtimeDir() / "reclaim" / "tickets";
     }
 
-    bool removeDataRoot(const fs::path& dataRoot, std::string* error)
+    static std::string ticketBody(const ReclaimJob& job)
     {
-        std::string err;
-        if (removeTreeNow(dataRoot, &err))
+        return std::string(job.wholeDir ? "dir" : "trash") + "\n" + job.target.string() + "\n";
+    }
+
+    //---Каталог билетов: наш и закрыт для остальных (иначе билет мог бы подложить кто угодно)
+    static bool checkTicketDir(const fs::path& dir, std::string* error)
+    {
+        struct stat st {};
+        if (::lstat(dir.c_str(), &st) != 0)
+        {
+            if (error) *error = sysError("reclaim: stat " + dir.string());
+            return false;
+        }
+        if (!S_ISDIR(st.st_mode) || st.st_uid != ::geteuid() || (st.st_mode & 077) != 0)
+        {
+            if (error) *error = "reclaim: " + dir.string() + " is not a directory owned by us with mode 0700";
+            return false;
+        }
+        return true;
+    }
+
+    static bool issueTicket(const ReclaimJob& job, std::string& token, std::string* error)
+    {
+        unsigned char raw[kTicketBytes];
+        if (::getrandom(raw, sizeof(raw), 0) != ssize_t(sizeof(raw)))
+        {
+            if (error) *error = sysError("reclaim: getrandom");
+            return false;
+        }
+        static const char* hex = "0123456789abcdef";
+        token.clear();
+        for (unsigned char c : raw)
+        {
+            token.push_back(hex[c >> 4]);
+            token.push_back(hex[c & 0xF]);
+        }
+
+        const fs::path dir = ticketDir();
+        std::error_code ec;
+        fs::create_directories(dir.parent_path(), ec);
+        if (::mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST)
+        {
+            if (error) *error = sysError("reclaim: mkdir " + dir.string());
+            return false;
+        }
+        if (!checkTicketDir(dir, error)) return false;
+
+        const fs::path p = dir / token;
+        const std::string body = ticketBody(job);
+        const int fd = ::open(p.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+        if (fd < 0)
+        {
+            if (error) *error = sysError("reclaim: create " + p.string());
+            return false;
+        }
+        const bool ok = ::write(fd, body.data(), body.size()) == ssize_t(body.size());
+        ::close(fd);
+        if (!ok)
+        {
+            ::unlink(p.c_str());
+            if (error) *error = "reclaim: failed to write " + p.string();
+            return false;
+        }
+        return true;
+    }
+
+    static void dropTicket(const std::string& token)
+    {
+        ::unlink((ticketDir() / token).c_str());
+    }
+
+    //---Погашение билета: есть, наш, 0600 и выписан ровно на это задание; удаляется в любом случае
+    static bool redeemTicket(const ReclaimJob& job, const std::string& token, std::string* error)
+    {
+        const auto refuse = [&](const std::string& why) {
+            if (error) *error = "reclaim: refused (internal mode, started by the installer itself): " + why;
+            return false;
+        };
+        if (token.size() != kTicketBytes * 2 || token.find_first_not_of("0123456789abcdef") != std::string::npos)
+            return refuse("no valid ticket in --wait-for");
+
+        const fs::path dir = ticketDir();
+        std::string why;
+        if (!checkTicketDir(dir, &why)) return refuse(why);
+
+        const fs::path p = dir / token;
+        const int fd = ::open(p.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd < 0) return refuse(sysError("ticket " + p.string()));
+        ::unlink(p.c_str());
+
+        struct stat st {};
+        std::string body;
+        char buf[4096];
+        bool ok = ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_uid == ::geteuid() && (st.st_mode & 077) == 0;
+        for (ssize_t n; ok && (n = ::read(fd, buf, sizeof(buf))) != 0;)
+        {
+            if (n < 0) ok = (errno == EINTR);
+            else body.append(buf, std::size_t(n));
+        }
+        ::close(fd);
+        if (!ok) return refuse("bad ticket " + p.string());
+        if (body != ticketBody(job)) return refuse("ticket " + p.string() + " was issued for another target");
+        return true;
+    }
+
+    //---Ожидание выхода запустившего процесса: "pidfd:<fd>" (унаследованный pidfd - без гонки
+    //   с переиспользованием pid) или "pid:<pid>" (ядра без pidfd_open - опрос раз в 100 мс);
+    //   "delay:<ms>" - просто пауза (запустивший - долгоживущий агент, не больше kMaxDelayMs)
+    static bool waitForExit(const std::string& waitFor, std::string* error)
+    {
+        constexpr long kMaxDelayMs = 10 * 60 * 1000;
+        const std::size_t colon = waitFor.find(':');
+        const std::string kind = waitFor.substr(0, colon);
+        char* end = nullptr;
+        const long n = (colon == std::string::npos) ? -1 : std::strtol(waitFor.c_str() + colon + 1, &end, 10);
+        if (n < 0 || !end || *end != '\0' || (kind != "pidfd" && kind != "pid" && kind != "delay") || (kind == "delay" && n > kMaxDelayMs))
+        {
+            if (error) *error = "reclaim: bad --wait-for value '" + waitFor + "' (pidfd:<fd>|pid:<pid>|delay:<ms>)";
+            return false;
+        }
+
+        if (kind == "delay")
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(n));
             return true;
+        }
 
-        std::string err2;
-        if (deferRemoveWithSh(fs::path{}, dataRoot, &err2))
+        if (kind == "pidfd")
+        {
+            pollfd pfd{ int(n), POLLIN, 0 };
+            while (::poll(&pfd, 1, -1) < 0 && errno == EINTR) {}
+            ::close(int(n));
             return true;
+        }
+        while (::kill(pid_t(n), 0) == 0 || errno == EPERM) ::poll(nullptr, 0, 100);
+        return true;
+    }
+
+    //---Очистка корзины: всё содержимое, пока не опустеет (уборщики одной корзины - по очереди)
+    static bool emptyTrash(const fs::path& trash, const RemoveTreeOptions& opt, RemoveTreeStats& total, std::string* error)
+    {
+        //---Удаляется всё содержимое каталога: только настоящая корзина
+        if (trash.filename() != kTrashName)
+        {
+            if (error) *error = "reclaim: " + trash.string() + " is not a " + kTrashName + " directory";
+            return false;
+        }
+        if (!checkTrashDir(trash, error)) return false;
+
+        //---Следующий уборщик подберёт то, что появилось позже
+        const int lockFd = ::open(trash.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (lockFd < 0 || ::flock(lockFd, LOCK_EX) != 0)
+        {
+            if (error) *error = sysError("reclaim: lock " + trash.string());
+            if (lockFd >= 0) ::close(lockFd);
+            return false;
+        }
 
-        if (error) *error = err + "; defer failed: " + err2;
+        std::set<std::string> failed;
+        std::string firstError;
+        for (bool more = true; more;)
+        {
+            more = false;
+            std::error_code ec;
+            for (fs::directory_iterator it(trash, ec), end; !ec && it != end; it.increment(ec))
+            {
+                const std::string name = it->path().filename().string();
+                if (failed.count(name)) continue;
+
+                RemoveTreeStats st;
+                std::string err;
+                if (!removeTree(it->path(), opt, st, &err))
+                {
+                    failed.insert(name);
+                    if (firstError.empty()) firstError = err;
+                }
+                total.files += st.files;
+                total.dirs += st.dirs;
+                total.bytes += st.bytes;
+                more = true;
+            }
+        }
+        ::close(lockFd);
+
+        if (failed.empty()) return true;
+        if (error) *error = "reclaim: " + std::to_string(failed.size()) + " item(s) left in " + trash.string() + ", first: " + firstError;
         return false;
     }
 
+    bool startReclaimer(const ReclaimJob& job, fs::path* statusFile, std::string* error)
+    {
+        //---Всё для exec готовится до fork: в потомке многопоточного процесса (--serve) - только
+        //   async-signal-safe вызовы. /proc/self/exe - на случай, если папку установщика уже унесли в корзину
+        std::vector<std::string> args{ "svcinst-reclaim", (job.wholeDir ? "--reclaim-dir=" : "--reclaim=") + job.target.string() };
+        if (job.throttle.enabled) args.push_back("--throttle");
+        if (job.throttle.unlinksPerSec) args.push_back("--max-unlinks=" + std::to_string(job.throttle.unlinksPerSec));
+        if (job.throttle.bytesPerSec) args.push_back("--max-delete-bytes=" + std::to_string(job.throttle.bytesPerSec));
+        for (const std::string& p : job.filter.includePatterns()) args.push_back("--data-include=" + p);
+        for (const std::string& p : job.filter.excludePatterns()) args.push_back("--data-exclude=" + p);
+
+        //---Билет на задание: --wait-for=<token>[,pidfd:<fd>|,pid:<pid>]
+        std::string token;
+        if (!issueTicket(job, token, error)) return false;
+        std::string waitFor = token;
+
+        //---Ожидание нашего выхода: pidfd открывается здесь, пока мы гарантированно живы,
+        //   и передаётся уборщику как fd 3
+        constexpr int kWaitFd = 3;
+        int pidfd = -1;
+        if (job.afterExit)
+        {
+            pidfd = int(::syscall(SYS_pidfd_open, ::getpid(), 0));
+            if (pidfd >= 0 && pidfd < kWaitFd)
+            {
+                const int moved = ::fcntl(pidfd, F_DUPFD_CLOEXEC, kWaitFd + 1);
+                ::close(pidfd);
+                pidfd = moved;
+            }
+            waitFor += pidfd >= 0 ? ",pidfd:" + std::to_string(kWaitFd) : ",pid:" + std::to_string(::getpid());
+        }
+        else if (job.delayMs)
+        {
+            waitFor += ",delay:" + std::to_string(job.delayMs);
+        }
+        args.push_back("--wait-for=" + waitFor);
+        std::vector<char*> argv;
+        for (std::string& a : args) argv.push_back(a.data());
+        argv.push_back(nullptr);
+
+        const pid_t pid = ::fork();
+        if (pid < 0)
+        {
+            if (error) *error = sysError("reclaim: fork");
+            if (pidfd >= 0) ::close(pidfd);
+            dropTicket(token);
+            return false;
+        }
+        if (pid == 0)
+        {
+            //---Демон: своя сессия, второй fork (не лидер сессии - терминал не захватит), "/" и /dev/null
+            ::setsid();
+            const pid_t daemon = ::fork();
+            if (daemon != 0) ::_exit(daemon < 0 ? 1 : 0);
+
+            (void)::chdir("/");
+            ::umask(022);
+            const int nul = ::open("/dev/null", O_RDWR);
+            if (nul >= 0)
+            {
+                ::dup2(nul, 0);
+                ::dup2(nul, 1);
+                ::dup2(nul, 2);
+                if (nul > 2 && nul != pidfd) ::close(nul);
+            }
+            int keep = kWaitFd;
+            if (pidfd >= 0)
+            {
+                if (pidfd != kWaitFd) ::dup2(pidfd, kWaitFd);
+                ::fcntl(kWaitFd, F_SETFD, 0);
+                keep = kWaitFd + 1;
+            }
+            if (::syscall(SYS_close_range, unsigned(keep), ~0u, 0u) != 0)
+            {
+                for (int fd = keep; fd < 1024; ++fd) ::close(fd);
+            }
+            sigset_t none;
+            sigemptyset(&none);
+            ::sigprocmask(SIG_SETMASK, &none, nullptr);
+            ::signal(SIGHUP, SIG_DFL);
+            ::signal(SIGPIPE, SIG_DFL);
+
+            ::execv("/proc/self/exe", argv.data());
+            ::_exit(127);
+        }
+
+        if (pidfd >= 0) ::close(pidfd);
+        int status = 0;
+        while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            if (error) *error = "reclaim: failed to start the background reclaimer";
+            dropTicket(token);
+            return false;
+        }
+        if (statusFile) *statusFile = reclaimStatusPath(job.target);
+        return true;
+    }
+
+    bool reclaim(const ReclaimJob& job, const std::string& waitFor, std::string* error)
+    {
+        //---Сначала билет: без него не пишется даже файл состояния
+        const std::size_t comma = waitFor.find(',');
+        if (!redeemTicket(job, waitFor.substr(0, comma), error)) return false;
+        const std::string waitExit = (comma == std::string::npos) ? std::string() : waitFor.substr(comma + 1);
+
+        ReclaimStatus status(job.target);
+        if (!waitExit.empty())
+        {
+            status.write("waiting");
+            if (!waitForExit(waitExit, error))
+            {
+                status.write("failed", nullptr, error ? *error : std::string());
+                return false;
+            }
+        }
+        status.write("running");
+
+        const auto t0 = std::chrono::steady_clock::now();
+        RemoveTreeOptions opt;
+        opt.throttle = job.throttle;
+        if (job.wholeDir) opt.filter = &job.filter;
+        RemoveTreeStats total;
+        std::string err;
+        bool ok;
+        if (!job.wholeDir) ok = emptyTrash(job.target, opt, total, &err);
+        else if (isDangerousPath(job.target))
+        {
+            err = "Refuse to delete dangerous path: " + job.target.string();
+            ok = false;
+        }
+        else ok = removeTree(job.target, opt, total, &err);
+
+        status.write(ok ? "done" : "failed", &total, err);
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+        LOG(INFO) << "reclaimed " << job.target.string() << ": " << total.files << " file(s), " << total.dirs << " dir(s), "
+            << total.bytes << " bytes in " << ms << " ms";
+        if (!ok && error) *error = err;
+        return ok;
+    }
+
 } // namespace svcinst::platform
 
 #endif
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "platform/PlatformImpl.hpp"
+
+//---Параллельное удаление дерева каталогов (удаление InstallDir/DataRoot на Linux)
+namespace svcinst::platform {
+
+    namespace fs = std::filesystem;
+
+    //---Параметры удаления
+    struct RemoveTreeOptions {
+        std::size_t threads = 0;    //	Рабочие потоки; 0 - по числу ядер (не больше 16)
+        bool countBytes = true;     //	Считать объём удалённых файлов (fstatat на каждый обычный файл)
+        DeleteThrottle throttle;    //	Щадящий режим: по умолчанию 1 поток, idle I/O, nice 19, лимиты, PSI
+        const PathFilter* filter = nullptr; //	Выборочное удаление; nullptr или без шаблонов - всё дерево
+    };
+
+    //---Итог удаления
+    struct RemoveTreeStats {
+        std::uint64_t files = 0;    //	Удалено не-каталогов (файлы, симлинки, сокеты...)
+        std::uint64_t dirs = 0;     //	Удалено каталогов, включая сам корень
+        std::uint64_t bytes = 0;    //	Объём удалённых обычных файлов (countBytes)
+        std::uint64_t failed = 0;   //	Записей, которые удалить не удалось
+        std::uint64_t kept = 0;     //	Записей, оставленных фильтром (каталог - вместе с содержимым)
+    };
+
+    //---Удаление dir со всем содержимым
+    //   Каталоги читаются getdents64 большими блоками, записи удаляются unlinkat относительно
+    //   дескриптора каталога - полные пути не собираются; симлинки не раскрываются (удаляется
+    //   сама ссылка). Потоки обходят свои поддеревья в глубину и забирают чужие поддеревья
+    //   с вершины (work stealing). Рекурсии нет: память - по одному узлу на найденный, но ещё
+    //   не удалённый подкаталог; открытых дескрипторов - не больше бюджета от RLIMIT_NOFILE.
+    //   С фильтром каждая запись проходит PathFilter::visit по d_type: оставленные каталоги
+    //   не читаются, каталог снимается, только если выбран и в нём ничего не оставлено.
+    //   Нет dir - true. Проверка опасных путей (isDangerousPath) - на вызывающем.
+    bool removeTree(const fs::path& dir, const RemoveTreeOptions& opt, RemoveTreeStats& stats, std::string* error);
+
+} // namespace svcinst::platform
@@ -0,0 +1,633 @@
+#if defined(__linux__)
+
+#include "platform/linux/RemoveTree.hpp"
+#include "Log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace svcinst::platform {
+
+    namespace {
+
+        constexpr std::size_t kDentsBufBytes = 256 * 1024;   //	Буфер getdents64 на поток
+        constexpr std::size_t kMaxThreads = 16;
+        constexpr int kMaxPasses = 3;                        //	Повторные чтения каталога, не опустевшего к rmdir
+        constexpr std::uint32_t kCheckpointGap = 64;         //	Сверх бюджета дескриптор держит каждый 64-й уровень цепочки
+        constexpr int kDirFlags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+
+        //---Заголовок записи getdents64 (linux_dirent64); имя - сразу за ним
+        struct Dirent64Head {
+            std::uint64_t ino;
+            std::int64_t off;
+            unsigned short reclen;
+            unsigned char type;
+        };
+        constexpr std::size_t kDirentNameOffset = 19;
+
+        static std::string sysError(const std::string& what, int err)
+        {
+            return what + ": " + std::error_code(err, std::generic_category()).message();
+        }
+
+        //---Найденный, но ещё не удалённый каталог
+        struct Node {
+            Node* parent = nullptr;         //	nullptr - корень удаления (родитель - baseFd)
+            std::string name;               //	Имя в родительском каталоге
+            int fd = -1;                    //	Удерживается, пока удаляются подкаталоги (если позволяет бюджет)
+            dev_t dev = 0;                  //	dev/ino при первом открытии: проверка повторных открытий
+            ino_t ino = 0;
+            int pass = 0;                   //	Номер чтения каталога
+            std::uint32_t gap = 0;          //	Уровней до ближайшего предка с дескриптором (0 - держит сам)
+            std::atomic<std::uint32_t> pending{ 1 };    //	Своё чтение + ещё не удалённые подкаталоги
+            std::atomic<bool> failed{ false };          //	В поддереве что-то не удалилось: повторное чтение бесполезно
+            std::atomic<bool> kept{ false };            //	Фильтр что-то оставил: каталог не снимается
+            bool selected = true;                       //	Каталог снимается (фильтр: выбран шаблонами)
+            bool filtered = false;                      //	Записи проходят фильтр с курсором cursor
+            PathFilter::Cursor cursor;
+        };
+
+        //---Дескрипторы, удерживаемые узлами: обычный бюджет и предел для опорных точек глубоких цепочек
+        struct FdLimits {
+            std::size_t budget = 1024;
+            std::size_t hardCap = 2048;
+        };
+
+        static FdLimits fdLimits()
+        {
+            FdLimits l;
+            rlimit rl{};
+            if (::getrlimit(RLIMIT_NOFILE, &rl) != 0 || rl.rlim_cur == RLIM_INFINITY) return l;
+            const std::size_t cur = std::size_t(rl.rlim_cur);
+            l.budget = std::clamp<std::size_t>(cur / 2 > 64 ? cur / 2 - 64 : 0, 16, 4096);
+            l.hardCap = std::max(l.budget, cur > 128 ? cur - 128 : 0);
+            return l;
+        }
+
+        //------------------------------------------------------------
+        //  Щадящий режим (DeleteThrottle)
+        //------------------------------------------------------------
+        constexpr int kIoprioWhoProcess = 1;        //	IOPRIO_WHO_PROCESS: для Linux-потока - его tid
+        constexpr int kIoprioClassIdle = 3;         //	IOPRIO_CLASS_IDLE: диск - только когда он простаивает
+        constexpr int kIoprioClassShift = 13;
+        constexpr double kPressureBackoffPct = 10.0;    //	some avg10 из /proc/pressure/io, выше - пауза
+        constexpr auto kPressureCheckEvery = std::chrono::seconds(1);
+        constexpr auto kPressureBackoff = std::chrono::milliseconds(500);
+        constexpr std::uint32_t kYieldEvery = 256;      //	sched_yield через каждые N удалений потока
+
+        //---Приоритет рабочего потока удаления: idle-класс I/O и nice 19 (tid - только этот поток)
+        //   Вызывается лишь в потоках, созданных под удаление: прежний nice без CAP_SYS_NICE не вернуть,
+        //   поэтому поток вызывающего не трогается, а рабочие потоки завершаются вместе с удалением
+        static void lowerThreadPriority()
+        {
+            const pid_t tid = pid_t(::syscall(SYS_gettid));
+            if (::setpriority(PRIO_PROCESS, id_t(tid), 19) != 0)
+                LOG(WARNING) << "removeTree: setpriority(19) failed: " << std::strerror(errno);
+            if (::syscall(SYS_ioprio_set, kIoprioWhoProcess, tid, kIoprioClassIdle << kIoprioClassShift) != 0)
+                LOG(WARNING) << "removeTree: ioprio_set(idle) failed: " << std::strerror(errno);
+        }
+
+        //---Доля времени, когда задачи ждали I/O (some avg10, %); < 0 - PSI недоступен
+        static double ioPressure()
+        {
+            const int fd = ::open("/proc/pressure/io", O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return -1;
+            char buf[256];
+            const ssize_t n = ::read(fd, buf, sizeof(buf) - 1);
+            ::close(fd);
+            if (n <= 0) return -1;
+            buf[n] = '\0';
+            double avg10 = -1;
+            return (std::sscanf(buf, "some avg10=%lf", &avg10) == 1) ? avg10 : -1;
+        }
+
+        //---Темп удаления: token bucket по unlink'ам и байтам (долг допускается - большой файл
+        //   не блокируется навсегда, следующий ждёт) и пауза, пока PSI io выше порога
+        class Pacer final {
+        public:
+            explicit Pacer(const DeleteThrottle& t)
+                : unlinkRate_(double(t.unlinksPerSec)), byteRate_(double(t.bytesPerSec)),
+                last_(Clock::now()), nextPressureCheck_(last_)
+            {
+            }
+
+            void pace(std::uint64_t bytes)
+            {
+                thread_local std::uint32_t sinceYield = 0;
+                if (++sinceYield >= kYieldEvery)
+                {
+                    sinceYield = 0;
+                    ::sched_yield();
+                }
+
+                std::unique_lock<std::mutex> lock(mutex_);
+                for (;;)
+                {
+                    const Clock::time_point now = Clock::now();
+                    const double dt = std::chrono::duration<double>(now - last_).count();
+                    last_ = now;
+                    //---Запас - не больше 1/10 секунды лимита: без длинных всплесков после пауз
+                    if (unlinkRate_ > 0) unlinkTokens_ = std::min(unlinkTokens_ + dt * unlinkRate_, std::max(1.0, unlinkRate_ / 10));
+                    if (byteRate_ > 0) byteTokens_ = std::min(byteTokens_ + dt * byteRate_, byteRate_ / 10);
+
+                    if (pressureKnown_ && now >= nextPressureCheck_)
+                    {
+                        const double p = ioPressure();
+                        pressureKnown_ = (p >= 0);
+                        const bool high = (p >= kPressureBackoffPct);
+                        if (high) backoffUntil_ = now + kPressureBackoff;
+                        nextPressureCheck_ = now + (high ? Clock::duration(kPressureBackoff) : Clock::duration(kPressureCheckEvery));
+                    }
+
+                    Clock::duration wait = (now < backoffUntil_) ? backoffUntil_ - now : Clock::duration::zero();
+                    if (unlinkRate_ > 0 && unlinkTokens_ < 0)
+                        wait = std::max(wait, std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(-unlinkTokens_ / unlinkRate_)));
+                    if (byteRate_ > 0 && byteTokens_ < 0)
+                        wait = std::max(wait, std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(-byteTokens_ / byteRate_)));
+
+                    if (wait <= Clock::duration::zero())
+                    {
+                        unlinkTokens_ -= 1;
+                        byteTokens_ -= double(bytes);
+                        return;
+                    }
+                    lock.unlock();
+                    std::this_thread::sleep_for(wait);
+                    lock.lock();
+                }
+            }
+
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            std::mutex mutex_;
+            const double unlinkRate_;
+            const double byteRate_;
+            double unlinkTokens_ = 0;
+            double byteTokens_ = 0;
+            Clock::time_point last_;
+            bool pressureKnown_ = true;
+            Clock::time_point nextPressureCheck_;
+            Clock::time_point backoffUntil_{};
+        };
+
+        class TreeRemover final {
+        public:
+            TreeRemover(int baseFd, const RemoveTreeOptions& opt, std::size_t threads)
+                : baseFd_(baseFd), countBytes_(opt.countBytes || opt.throttle.bytesPerSec > 0),
+                lowPriority_(opt.throttle.enabled), filter_(opt.filter), fd_(fdLimits())
+            {
+                if (opt.throttle.enabled) pacer_ = std::make_unique<Pacer>(opt.throttle);
+                queues_.reserve(threads);
+                for (std::size_t i = 0; i < threads; ++i) queues_.push_back(std::make_unique<Queue>());
+            }
+
+            //---Удаление поддерева root (узел передаётся во владение); текущий поток - worker 0,
+            //   в щадящем режиме все рабочие - отдельные потоки: приоритет вызывающего не меняется
+            void run(Node* root)
+            {
+                outstanding_ = 1;
+                queues_[0]->tasks.push_back(root);
+
+                const std::size_t first = lowPriority_ ? 0 : 1;
+                std::vector<std::thread> threads;
+                threads.reserve(queues_.size() - first);
+                for (std::size_t i = first; i < queues_.size(); ++i) threads.emplace_back([this, i] { work(i); });
+                if (first != 0) work(0);
+                for (std::thread& t : threads) t.join();
+            }
+
+            RemoveTreeStats stats() const
+            {
+                RemoveTreeStats s;
+                s.files = files_;
+                s.dirs = dirs_;
+                s.bytes = bytes_;
+                s.failed = failed_;
+                s.kept = kept_;
+                return s;
+            }
+
+            std::string firstError() const
+            {
+                std::lock_guard<std::mutex> lock(errorMutex_);
+                return firstError_;
+            }
+
+        private:
+            //---Очередь потока: владелец берёт с конца (в глубину), остальные крадут с начала
+            struct Queue {
+                std::mutex mutex;
+                std::deque<Node*> tasks;
+            };
+
+            void work(std::size_t self)
+            {
+                if (lowPriority_) lowerThreadPriority();
+
+                std::unique_ptr<char[]> buf(new char[kDentsBufBytes]);
+                for (;;)
+                {
+                    Node* n = pop(self);
+                    if (!n) n = steal(self);
+                    if (n)
+                    {
+                        list(n, self, buf.get());
+                        if (outstanding_.fetch_sub(1) == 1) idleCv_.notify_all();
+                        continue;
+                    }
+                    if (outstanding_ == 0) return;
+
+                    std::unique_lock<std::mutex> lock(idleMutex_);
+                    ++idle_;
+                    idleCv_.wait_for(lock, std::chrono::milliseconds(2));
+                    --idle_;
+                }
+            }
+
+            Node* pop(std::size_t self)
+            {
+                Queue& q = *queues_[self];
+                std::lock_guard<std::mutex> lock(q.mutex);
+                if (q.tasks.empty()) return nullptr;
+                Node* n = q.tasks.back();
+                q.tasks.pop_back();
+                return n;
+            }
+
+            //---Кража с вершины чужой очереди: там самые крупные поддеревья
+            Node* steal(std::size_t self)
+            {
+                for (std::size_t k = 1; k < queues_.size(); ++k)
+                {
+                    Queue& q = *queues_[(self + k) % queues_.size()];
+                    std::lock_guard<std::mutex> lock(q.mutex);
+                    if (q.tasks.empty()) continue;
+                    Node* n = q.tasks.front();
+                    q.tasks.pop_front();
+                    return n;
+                }
+                return nullptr;
+            }
+
+            void push(std::size_t self, std::vector<Node*>& nodes)
+            {
+                if (nodes.empty()) return;
+                outstanding_ += nodes.size();
+                {
+                    Queue& q = *queues_[self];
+                    std::lock_guard<std::mutex> lock(q.mutex);
+                    q.tasks.insert(q.tasks.end(), nodes.begin(), nodes.end());
+                }
+                nodes.clear();
+                if (idle_ > 0) idleCv_.notify_all();
+            }
+
+            //---Запись в n оставлена фильтром
+            void keep(Node* n)
+            {
+                ++kept_;
+                n->kept = true;
+            }
+
+            void fail(Node* where, const std::string& name, int err)
+            {
+                ++failed_;
+                for (Node* n = where; n && !n->failed.exchange(true); n = n->parent) {}
+                std::lock_guard<std::mutex> lock(errorMutex_);
+                if (firstError_.empty()) firstError_ = sysError("cannot remove '" + name + "'", err);
+            }
+
+            //---Дескриптор каталога n: удерживаемый (owned = false) или открытый заново цепочкой
+            //   openat от ближайшего предка с дескриптором (owned = true, закрывает вызывающий)
+            int dirFd(Node* n, bool& owned)
+            {
+                owned = false;
+                if (!n) return baseFd_;
+                if (n->fd >= 0) return n->fd;
+
+                std::vector<Node*> chain;
+                Node* anchor = n;
+                for (; anchor && anchor->fd < 0; anchor = anchor->parent) chain.push_back(anchor);
+
+                int fd = anchor ? anchor->fd : baseFd_;
+                for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+                {
+                    const int next = ::openat(fd, (*it)->name.c_str(), kDirFlags);
+                    const int err = errno;
+                    if (owned) ::close(fd);
+                    if (next < 0)
+                    {
+                        errno = err;
+                        return -1;
+                    }
+                    //---Каталог подменили между чтением и повторным открытием - не трогаем
+                    struct stat st {};
+                    if (::fstat(next, &st) != 0 || st.st_dev != (*it)->dev || st.st_ino != (*it)->ino)
+                    {
+                        ::close(next);
+                        errno = ESTALE;
+                        return -1;
+                    }
+                    fd = next;
+                    owned = true;
+                }
+                return fd;
+            }
+
+            //---Не-каталог: unlinkat; false - это всё-таки каталог (d_type врал или подмена)
+            bool removeEntry(Node* n, int fd, const char* name, unsigned char type)
+            {
+                std::uint64_t size = 0;
+                if (countBytes_ && type == DT_REG)
+                {
+                    struct stat st {};
+                    if (::fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0) size = std::uint64_t(st.st_size);
+                }
+                if (pacer_) pacer_->pace(size);
+                if (::unlinkat(fd, name, 0) == 0)
+                {
+                    ++files_;
+                    bytes_ += size;
+                    return true;
+                }
+                if (errno == EISDIR) return false;
+                if (errno != ENOENT) fail(n, name, errno);
+                return true;
+            }
+
+            //---Чтение каталога: файлы удаляются сразу, подкаталоги становятся задачами
+            void list(Node* n, std::size_t self, char* buf)
+            {
+                bool ownedParent = false;
+                const int pfd = dirFd(n->parent, ownedParent);
+                const int fd = (pfd >= 0) ? ::openat(pfd, n->name.c_str(), kDirFlags) : -1;
+                const int openErr = errno;
+                if (ownedParent) ::close(pfd);
+                if (fd < 0)
+                {
+                    if (openErr != ENOENT) fail(n, n->name, openErr);
+                    release(n, self);
+                    return;
+                }
+                if (n->pass == 0)
+                {
+                    struct stat st {};
+                    if (::fstat(fd, &st) == 0)
+                    {
+                        n->dev = st.st_dev;
+                        n->ino = st.st_ino;
+                    }
+                }
+
+                std::vector<Node*> children;
+                PathFilter::Cursor cursor;
+                for (;;)
+                {
+                    const long got = ::syscall(SYS_getdents64, fd, buf, kDentsBufBytes);
+                    if (got < 0 && errno == EINTR) continue;
+                    if (got < 0)
+                    {
+                        fail(n, n->name, errno);
+                        break;
+                    }
+                    if (got == 0) break;
+
+                    for (long off = 0; off < got;)
+                    {
+                        Dirent64Head h;
+                        std::memcpy(&h, buf + off, sizeof(h));
+                        const char* name = buf + off + kDirentNameOffset;
+                        off += h.reclen;
+                        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+                        unsigned char type = h.type;
+                        if (type == DT_UNKNOWN)
+                        {
+                            struct stat st {};
+                            if (::fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+                            {
+                                if (errno != ENOENT) fail(n, name, errno);
+                                continue;
+                            }
+                            type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_LNK;
+                        }
+                        //---Фильтр: оставленное не трогаем, в каталоги без выбранного не заходим
+                        PathFilter::Action action = PathFilter::Action::Remove;
+                        if (n->filtered) action = filter_->visit(n->cursor, name, type == DT_DIR, cursor);
+                        if (action == PathFilter::Action::Keep)
+                        {
+                            keep(n);
+                            continue;
+                        }
+                        if (type != DT_DIR)
+                        {
+                            if (removeEntry(n, fd, name, type)) continue;
+                            //---d_type врал: решение для каталога
+                            if (n->filtered) action = filter_->visit(n->cursor, name, true, cursor);
+                            if (action == PathFilter::Action::Keep)
+                            {
+                                keep(n);
+                                continue;
+                            }
+                        }
+
+                        Node* child = new Node;
+                        child->parent = n;
+                        child->name = name;
+                        if (action == PathFilter::Action::Descend)
+                        {
+                            child->filtered = true;
+                            child->selected = cursor.selected;
+                            child->cursor = std::move(cursor);
+                            cursor = {};
+                        }
+                        children.push_back(child);
+                    }
+                }
+
+                //---Дескриптор остаётся у узла, пока есть подкаталоги и не исчерпан бюджет;
+                //   иначе потомки откроют каталог заново от ближайшего предка. Чтобы повторное
+                //   открытие в глубокой цепочке не стало квадратичным, каждый kCheckpointGap-й
+                //   уровень держит дескриптор и сверх бюджета (до hardCap)
+                const std::uint32_t gap = (!n->parent || n->parent->fd >= 0) ? 1 : n->parent->gap + 1;
+                const std::size_t limit = (gap >= kCheckpointGap) ? fd_.hardCap : fd_.budget;
+                n->pending += std::uint32_t(children.size());
+                if (!children.empty() && openFds_.fetch_add(1) < limit)
+                {
+                    n->fd = fd;
+                    n->gap = 0;
+                }
+                else
+                {
+                    if (!children.empty()) --openFds_;
+                    ::close(fd);
+                    n->gap = gap;
+                }
+                push(self, children);
+                release(n, self);
+            }
+
+            //---Узел прочитан или удалён его подкаталог; последний снимает каталог и идёт вверх
+            void release(Node* n, std::size_t self)
+            {
+                while (n && n->pending.fetch_sub(1) == 1)
+                {
+                    if (n->fd >= 0)
+                    {
+                        ::close(n->fd);
+                        n->fd = -1;
+                        --openFds_;
+                    }
+
+                    //---Не выбран или что-то оставлено: каталог остаётся, а с ним и родитель
+                    Node* parent = n->parent;
+                    if (!n->selected || n->kept)
+                    {
+                        if (parent) parent->kept = true;
+                        delete n;
+                        n = parent;
+                        continue;
+                    }
+
+                    bool owned = false;
+                    const int pfd = dirFd(parent, owned);
+                    if (pacer_ && pfd >= 0) pacer_->pace(0);
+                    const int rc = (pfd >= 0) ? ::unlinkat(pfd, n->name.c_str(), AT_REMOVEDIR) : -1;
+                    const int err = errno;
+                    if (owned) ::close(pfd);
+
+                    if (rc == 0) ++dirs_;
+                    else if (err == ENOTEMPTY && !n->failed && ++n->pass < kMaxPasses)
+                    {
+                        //---Записи, пропущенные чтением (созданы во время обхода): ещё проход
+                        n->pending = 1;
+                        std::vector<Node*> again{ n };
+                        push(self, again);
+                        return;
+                    }
+                    else if (err == ENOTEMPTY && n->failed) {}  //	Причина уже учтена в поддереве
+                    else if (err != ENOENT) fail(n, n->name, err);
+
+                    delete n;
+                    n = parent;
+                }
+            }
+
+        private:
+            const int baseFd_;
+            const bool countBytes_;
+            const bool lowPriority_;
+            const PathFilter* const filter_;
+            std::unique_ptr<Pacer> pacer_;
+            const FdLimits fd_;
+            std::vector<std::unique_ptr<Queue>> queues_;
+
+            std::atomic<std::size_t> outstanding_{ 0 };    //	Задачи в очередях и в работе
+            std::atomic<std::size_t> openFds_{ 0 };
+            std::mutex idleMutex_;
+            std::condition_variable idleCv_;
+            std::atomic<std::size_t> idle_{ 0 };
+
+            std::atomic<std::uint64_t> files_{ 0 }, dirs_{ 0 }, bytes_{ 0 }, failed_{ 0 }, kept_{ 0 };
+            mutable std::mutex errorMutex_;
+            std::string firstError_;
+        };
+
+    } // namespace
+
+    bool removeTree(const fs::path& dir, const RemoveTreeOptions& opt, RemoveTreeStats& stats, std::string* error)
+    {
+        stats = {};
+        if (dir.empty()) return true;
+
+        std::error_code ec;
+        fs::path p = fs::absolute(dir, ec);
+        if (ec) p = dir;
+        p = p.lexically_normal();
+        if (!p.has_filename()) p = p.parent_path();
+        const std::string name = p.filename().string();
+        if (name.empty() || name == "." || name == "..")
+        {
+            if (error) *error = "removeTree: cannot remove '" + dir.string() + "'";
+            return false;
+        }
+
+        //---Корень открывается относительно родителя: дальше всё - от дескрипторов
+        const int baseFd = ::open(p.has_parent_path() ? p.parent_path().c_str() : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (baseFd < 0)
+        {
+            if (errno == ENOENT) return true;
+            if (error) *error = sysError("removeTree: open '" + p.parent_path().string() + "'", errno);
+            return false;
+        }
+
+        struct stat st {};
+        if (::fstatat(baseFd, name.c_str(), &st, AT_SYMLINK_NOFOLLOW) != 0)
+        {
+            const int err = errno;
+            ::close(baseFd);
+            if (err == ENOENT) return true;
+            if (error) *error = sysError("removeTree: stat '" + p.string() + "'", err);
+            return false;
+        }
+
+        //---Не каталог (в том числе симлинк на каталог) - удаляется сама запись, как remove_all
+        if (!S_ISDIR(st.st_mode))
+        {
+            const bool ok = ::unlinkat(baseFd, name.c_str(), 0) == 0 || errno == ENOENT;
+            if (!ok && error) *error = sysError("removeTree: unlink '" + p.string() + "'", errno);
+            ::close(baseFd);
+            if (ok) stats.files = 1;
+            return ok;
+        }
+
+        std::size_t threads = opt.threads;
+        if (threads == 0 && opt.throttle.enabled) threads = 1;     //	Щадящему удалению параллелизм не нужен
+        if (threads == 0) threads = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), kMaxThreads);
+
+        Node* root = new Node;
+        root->name = name;
+        if (opt.filter && opt.filter->active())
+        {
+            root->filtered = true;
+            root->cursor = opt.filter->root();
+            root->selected = root->cursor.selected;
+        }
+
+        TreeRemover remover(baseFd, opt, threads);
+        remover.run(root);
+        ::close(baseFd);
+
+        stats = remover.stats();
+        if (stats.failed == 0) return true;
+        if (error)
+        {
+            *error = "removeTree '" + p.string() + "': " + std::to_string(stats.failed) + " entr" + (stats.failed == 1 ? "y" : "ies") +
+                " not removed, first: " + remover.firstError();
+        }
+        return false;
+    }
+
+} // namespace svcinst::platform
+
+#endif // __linux__
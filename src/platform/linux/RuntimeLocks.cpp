@@ -0,0 +1,274 @@
+#if defined(__linux__)
+
+#include "platform/linux/RuntimeLocks.hpp"
+#include "platform/linux/SystemdCommon.hpp"
+#include "platform/PlatformImpl.hpp"
+#include "Log.hpp"
+
+#include <cctype>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <system_error>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace svcinst::systemd {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        //---Счётчики поколений daemon-reload (файл reload.gen)
+        //   started   - номер последнего начатого reload'а
+        //   completed - номер последнего успешно завершённого reload'а
+        struct ReloadGen {
+            std::uint64_t started = 0;
+            std::uint64_t completed = 0;
+        };
+
+        //---Открытие (создание) runtime-файла; -1 при ошибке
+        static int openRuntimeFile(const char* name)
+        {
+            const fs::path p = runtimeDir() / name;
+            int fd;
+            do { fd = ::open(p.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644); } while (fd < 0 && errno == EINTR);
+            return fd;
+        }
+
+        //---flock с повтором при EINTR
+        static bool lockFile(int fd, int op)
+        {
+            while (::flock(fd, op) != 0)
+            {
+                if (errno != EINTR) return false;
+            }
+            return true;
+        }
+
+        //---Чтение счётчиков (формат "started completed\n"; пустой файл - нули)
+        static void readGen(int fd, ReloadGen& g)
+        {
+            g = {};
+            char buf[64] = {};
+            const ssize_t n = ::pread(fd, buf, sizeof(buf) - 1, 0);
+            if (n <= 0) return;
+            unsigned long long s = 0, c = 0;
+            if (std::sscanf(buf, "%llu %llu", &s, &c) == 2)
+            {
+                g.started = s;
+                g.completed = c;
+            }
+        }
+
+        static void writeGen(int fd, const ReloadGen& g)
+        {
+            char buf[64];
+            const int n = std::snprintf(buf, sizeof(buf), "%" PRIu64 " %" PRIu64 "\n", g.started, g.completed);
+            if (n <= 0) return;
+            if (::pwrite(fd, buf, (size_t)n, 0) == n) (void)::ftruncate(fd, n);
+        }
+
+        //---Короткая критическая секция над reload.gen: чтение -> (изменение) -> запись
+        template<class Fn>
+        static void withGen(int fd, Fn&& fn)
+        {
+            const bool locked = lockFile(fd, LOCK_EX);
+            ReloadGen g;
+            readGen(fd, g);
+            if (fn(g)) writeGen(fd, g);
+            if (locked) lockFile(fd, LOCK_UN);
+        }
+
+    } // namespace
+
+    //---Каталог runtime-файлов установщика
+    fs::path runtimeDir()
+    {
+        const fs::path p("/run/svcinst");
+        std::error_code ec;
+        fs::create_directories(p, ec);
+        return p;
+    }
+
+    //---Объединение daemon-reload между процессами (group commit)
+    //
+    //   reload.gen  - счётчики started/completed, меняются под коротким flock;
+    //   reload.lock - роль "ведущего": держит тот, кто сейчас выполняет reload.
+    //
+    //   Наши изменения записаны до входа сюда, поэтому их покрывает любой reload, начатый
+    //   позже, т.е. с номером >= need = started + 1. Уже идущий reload (номер started)
+    //   мог прочитать конфигурацию до наших записей - он не засчитывается.
+    //   Ждущие процессы опрашивают completed; кто первым захватил роль - выполняет
+    //   reload за всех, кто встал в очередь до его начала. Упавший ведущий не двигает
+    //   completed, и роль переходит к следующему.
+    bool coalescedReload(const std::function<bool(std::string*)>& reload, std::uint32_t timeoutMs,
+        std::string* error, bool* coalesced)
+    {
+        if (coalesced) *coalesced = false;
+
+        const int genFd = openRuntimeFile("reload.gen");
+        const int roleFd = (genFd >= 0) ? openRuntimeFile("reload.lock") : -1;
+        if (genFd < 0 || roleFd < 0)
+        {
+            //---Нет /run/svcinst (нет прав и т.п.) - координация невозможна, обычный reload
+            VLOG(1) << "reload coalescing unavailable: " << std::error_code(errno, std::generic_category()).message();
+            if (genFd >= 0) ::close(genFd);
+            return reload(error);
+        }
+
+        std::uint64_t need = 0;
+        withGen(genFd, [&](ReloadGen& g) { need = g.started + 1; return false; });
+
+        const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        bool ok = false;
+        for (;;)
+        {
+            //---Наш reload уже сделал кто-то другой?
+            ReloadGen g;
+            withGen(genFd, [&](ReloadGen& cur) { g = cur; return false; });
+            if (g.completed >= need)
+            {
+                if (coalesced) *coalesced = true;
+                ok = true;
+                break;
+            }
+
+            if (::flock(roleFd, LOCK_EX | LOCK_NB) == 0)
+            {
+                //---Роль захвачена. Пока ждали, предыдущий ведущий мог успеть за нас
+                std::uint64_t mine = 0;
+                withGen(genFd, [&](ReloadGen& cur) {
+                    if (cur.completed >= need) return false;
+                    mine = ++cur.started;
+                    return true;
+                    });
+
+                if (mine == 0)
+                {
+                    if (coalesced) *coalesced = true;
+                    ok = true;
+                }
+                else
+                {
+                    ok = reload(error);
+                    if (ok)
+                    {
+                        withGen(genFd, [&](ReloadGen& cur) {
+                            if (cur.completed >= mine) return false;
+                            cur.completed = mine;
+                            return true;
+                            });
+                    }
+                }
+                lockFile(roleFd, LOCK_UN);
+                break;
+            }
+            if (errno != EWOULDBLOCK && errno != EINTR)
+            {
+                //---flock не поддерживается - без координации
+                ok = reload(error);
+                break;
+            }
+
+            if (Clock::now() >= deadline)
+            {
+                if (error) *error = "daemon-reload: timed out waiting for a concurrent reload (" + std::to_string(timeoutMs) + " ms)";
+                break;
+            }
+            ::poll(nullptr, 0, 10);
+        }
+
+        ::close(roleFd);
+        ::close(genFd);
+        return ok;
+    }
+
+} // namespace svcinst::systemd
+
+namespace svcinst::platform {
+
+    namespace {
+
+        //---flock на файле /run/svcinst/locks/<key>.lock; снимается закрытием fd
+        class FlockServiceLock final : public ServiceLock {
+        public:
+            explicit FlockServiceLock(int fd) : fd_(fd) {}
+            ~FlockServiceLock() override { ::close(fd_); }
+        private:
+            int fd_;
+        };
+
+        //---Ключ превращается в имя файла: <имя службы>[@<hex-хэш корня>] (см. serviceLockKey);
+        //   имя - тот же набор, что у isValidUnitName, без ведущей точки
+        static bool isSafeKey(const std::string& key)
+        {
+            const std::size_t at = key.find('@');
+            const std::string name = key.substr(0, at);
+            if (!systemd::isValidUnitName(name) || name[0] == '.') return false;
+            if (at == std::string::npos) return true;
+            if (at + 1 == key.size()) return false;
+            for (std::size_t i = at + 1; i < key.size(); ++i)
+            {
+                if (!std::isxdigit((unsigned char)key[i])) return false;
+            }
+            return true;
+        }
+
+    } // namespace
+
+    //---Захват блокировки службы (flock с ограниченным ожиданием)
+    //   Блокировка привязана к открытому файлу: при падении процесса ядро снимает её само,
+    //   "зависших" lock-файлов не бывает. Сам файл не удаляется - иначе два процесса могли бы
+    //   держать flock на разных inode с одним именем.
+    std::unique_ptr<ServiceLock> lockService(const std::string& key, std::uint32_t waitMs, bool& busy, std::string* error)
+    {
+        busy = false;
+        if (!isSafeKey(key))
+        {
+            if (error) *error = "lockService: invalid lock key (service name A-Za-z0-9_.- not starting with '.', optionally @<hex root hash>)";
+            return nullptr;
+        }
+
+        //---Отдельный подкаталог: имя службы не должно совпасть с reload.lock / reload.gen
+        const fs::path dir = systemd::runtimeDir() / "locks";
+        std::error_code ec;
+        fs::create_directories(dir, ec);
+
+        const fs::path p = dir / (key + ".lock");
+        int fd;
+        do { fd = ::open(p.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644); } while (fd < 0 && errno == EINTR);
+        if (fd < 0)
+        {
+            if (error) *error = "lockService: " + p.string() + " : " + std::error_code(errno, std::generic_category()).message();
+            return nullptr;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(waitMs);
+        for (;;)
+        {
+            if (::flock(fd, LOCK_EX | LOCK_NB) == 0) return std::make_unique<FlockServiceLock>(fd);
+            if (errno != EWOULDBLOCK && errno != EINTR)
+            {
+                if (error) *error = "lockService: flock " + p.string() + " : " + std::error_code(errno, std::generic_category()).message();
+                ::close(fd);
+                return nullptr;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) break;
+            ::poll(nullptr, 0, 10);
+        }
+
+        ::close(fd);
+        busy = true;
+        if (error) *error = "service '" + key + "' is busy: another installer holds " + p.string();
+        return nullptr;
+    }
+
+} // namespace svcinst::platform
+
+#endif // __linux__
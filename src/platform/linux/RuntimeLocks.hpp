@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+
+//---Межпроцессная координация экземпляров установщика на одном хосте (файлы в /run/svcinst)
+namespace svcinst::systemd {
+
+    namespace fs = std::filesystem;
+
+    //---Каталог runtime-файлов установщика: /run/svcinst (создаётся при необходимости)
+    fs::path runtimeDir();
+
+    //---Перезагрузка конфигурации systemd, объединённая между параллельными процессами
+    //   Вызывать после того, как все свои изменения unit'ов/симлинков записаны.
+    //   Если другой процесс начал daemon-reload уже после наших записей, ждём его завершения
+    //   вместо собственного reload: N параллельных установок дают ~2 reload'а вместо N.
+    //   reload - собственно перезагрузка (systemctl daemon-reload / Manager.Reload).
+    //   coalesced (необязательно) - true, если наш reload покрыт чужим.
+    //   Без доступа к /run/svcinst просто вызывает reload.
+    bool coalescedReload(const std::function<bool(std::string*)>& reload, std::uint32_t timeoutMs,
+        std::string* error, bool* coalesced = nullptr);
+
+} // namespace svcinst::systemd
@@ -0,0 +1,324 @@
+#if defined(__linux__)
+
+#include "platform/PlatformImpl.hpp"
+#include "Log.hpp"
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace svcinst::platform {
+
+    namespace {
+
+        constexpr std::size_t kMaxLineBytes = 64 * 1024;   //	Длиннее - клиент отключается
+        constexpr int kIdleTimeoutMs = 60 * 1000;           //	Простаивающее соединение закрывается
+        constexpr std::size_t kMaxPending = 1024;           //	Очередь принятых, но не обслуживаемых соединений
+
+        //---Self-pipe остановки: обработчик сигнала пишет байт, poll'ы всех потоков его видят
+        //   (байт не вычитывается - канал остаётся "готовым" до конца работы сервера)
+        int g_stopPipe[2] = { -1, -1 };
+
+        extern "C" void onStopSignal(int)
+        {
+            const int saved = errno;
+            const char c = 1;
+            (void)!::write(g_stopPipe[1], &c, 1);
+            errno = saved;
+        }
+
+        static std::string sysError(const std::string& what)
+        {
+            return what + ": " + std::error_code(errno, std::generic_category()).message();
+        }
+
+        //---Старый файл сокета: удаляется, только если на нём никто не слушает
+        static bool prepareSocketPath(const fs::path& p, std::string* error)
+        {
+            struct stat st {};
+            if (::lstat(p.c_str(), &st) != 0)
+            {
+                if (errno == ENOENT) return true;
+                if (error) *error = sysError("serve: stat " + p.string());
+                return false;
+            }
+            if (!S_ISSOCK(st.st_mode))
+            {
+                if (error) *error = "serve: " + p.string() + " exists and is not a socket";
+                return false;
+            }
+
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            std::strncpy(addr.sun_path, p.c_str(), sizeof(addr.sun_path) - 1);
+            const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            const bool alive = fd >= 0 && ::connect(fd, (const sockaddr*)&addr, sizeof(addr)) == 0;
+            if (fd >= 0) ::close(fd);
+            if (alive)
+            {
+                if (error) *error = "serve: another agent is already listening on " + p.string();
+                return false;
+            }
+            ::unlink(p.c_str());
+            return true;
+        }
+
+        //---Отправка всего буфера (клиент, переставший читать, отваливается по SO_SNDTIMEO)
+        static bool sendAll(int fd, const std::string& s)
+        {
+            std::size_t off = 0;
+            while (off < s.size())
+            {
+                const ssize_t n = ::send(fd, s.data() + off, s.size() - off, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+                off += (std::size_t)n;
+            }
+            return true;
+        }
+
+        //---Пул рабочих потоков над очередью принятых соединений
+        class Server final {
+        public:
+            Server(std::size_t workers, const ServeHandler& handle) : handle_(handle)
+            {
+                threads_.reserve(workers);
+                for (std::size_t i = 0; i < workers; ++i) threads_.emplace_back([this, i] { work(i); });
+            }
+
+            ~Server()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    stopping_ = true;
+                }
+                cv_.notify_all();
+                for (std::thread& t : threads_) t.join();
+                for (int fd : queue_) ::close(fd);
+            }
+
+            //---false - очередь переполнена, соединение не принято
+            bool push(int fd)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (queue_.size() >= kMaxPending) return false;
+                    queue_.push_back(fd);
+                }
+                cv_.notify_one();
+                return true;
+            }
+
+            std::size_t served() const
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return served_;
+            }
+
+        private:
+            void work(std::size_t worker)
+            {
+                for (;;)
+                {
+                    int fd = -1;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                        if (stopping_) return;
+                        fd = queue_.front();
+                        queue_.pop_front();
+                        ++served_;
+                    }
+                    serveClient(fd, worker);
+                    ::close(fd);
+                }
+            }
+
+            //---Одно соединение: строки запросов по очереди, ответ на каждую
+            void serveClient(int fd, std::size_t worker)
+            {
+                ServeRequest rq;
+                rq.worker = worker;
+
+                ucred cr{};
+                socklen_t len = sizeof(cr);
+                if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cr, &len) == 0)
+                {
+                    rq.uid = (std::uint32_t)cr.uid;
+                    rq.pid = (std::uint32_t)cr.pid;
+                    rq.privileged = (cr.uid == 0 || cr.uid == ::geteuid());
+                }
+                else
+                {
+                    LOG(WARNING) << sysError("serve: SO_PEERCRED");
+                }
+
+                const timeval sendTimeout{ 10, 0 };
+                (void)::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+
+                std::string buf;
+                char chunk[4096];
+                bool eof = false;
+                while (!eof)
+                {
+                    //---Ждём данных; по сигналу остановки простаивающее соединение закрывается
+                    pollfd pfd[2] = { { fd, POLLIN, 0 }, { g_stopPipe[0], POLLIN, 0 } };
+                    const int pr = ::poll(pfd, 2, kIdleTimeoutMs);
+                    if (pr < 0 && errno == EINTR) continue;
+                    if (pr <= 0 || (pfd[1].revents & POLLIN)) return;
+
+                    const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+                    if (n < 0 && errno == EINTR) continue;
+                    if (n < 0) return;
+                    if (n == 0) eof = true;
+                    else buf.append(chunk, (std::size_t)n);
+
+                    //---Полные строки; остаток без '\n' в конце потока - тоже запрос
+                    std::size_t from = 0;
+                    for (;;)
+                    {
+                        std::size_t nl = buf.find('\n', from);
+                        if (nl == std::string::npos)
+                        {
+                            if (!eof || from == buf.size()) break;
+                            nl = buf.size();
+                        }
+                        rq.line.assign(buf, from, nl - from);
+                        if (!rq.line.empty() && rq.line.back() == '\r') rq.line.pop_back();
+                        from = (nl < buf.size()) ? nl + 1 : nl;
+                        ++rq.lineNo;
+
+                        const std::string reply = handle_(rq);
+                        if (!reply.empty() && !sendAll(fd, reply + "\n")) return;
+                    }
+                    buf.erase(0, from);
+                    if (buf.size() > kMaxLineBytes)
+                    {
+                        LOG(WARNING) << "serve: request from pid " << rq.pid << " exceeds " << kMaxLineBytes << " bytes, disconnecting";
+                        return;
+                    }
+                }
+            }
+
+        private:
+            const ServeHandler& handle_;
+            mutable std::mutex mutex_;
+            std::condition_variable cv_;
+            std::deque<int> queue_;
+            std::vector<std::thread> threads_;
+            std::size_t served_ = 0;
+            bool stopping_ = false;
+        };
+
+    } // namespace
+
+    //---Агент на Unix-сокете
+    bool serveLocal(const fs::path& socket, std::size_t workers, const ServeHandler& handle, std::string* error)
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (socket.empty() || socket.native().size() >= sizeof(addr.sun_path))
+        {
+            if (error) *error = "serve: socket path is empty or longer than " + std::to_string(sizeof(addr.sun_path) - 1) + " bytes";
+            return false;
+        }
+        std::memcpy(addr.sun_path, socket.c_str(), socket.native().size());
+
+        std::error_code ec;
+        if (socket.has_parent_path()) fs::create_directories(socket.parent_path(), ec);
+        if (!prepareSocketPath(socket, error)) return false;
+
+        const int listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listenFd < 0)
+        {
+            if (error) *error = sysError("serve: socket");
+            return false;
+        }
+
+        //---Права 0600 с момента создания: без окна, когда сокет доступен всем
+        const mode_t oldMask = ::umask(0177);
+        const int bound = ::bind(listenFd, (const sockaddr*)&addr, sizeof(addr));
+        ::umask(oldMask);
+        if (bound != 0 || ::listen(listenFd, 128) != 0)
+        {
+            if (error) *error = sysError("serve: bind/listen " + socket.string());
+            ::close(listenFd);
+            return false;
+        }
+
+        //---Остановка по SIGINT/SIGTERM; SIGPIPE от ушедших клиентов не нужен (send с MSG_NOSIGNAL)
+        if (::pipe2(g_stopPipe, O_CLOEXEC | O_NONBLOCK) != 0)
+        {
+            if (error) *error = sysError("serve: pipe");
+            ::close(listenFd);
+            ::unlink(socket.c_str());
+            return false;
+        }
+        struct sigaction sa {}, oldInt {}, oldTerm {};
+        sa.sa_handler = onStopSignal;
+        sigemptyset(&sa.sa_mask);
+        ::sigaction(SIGINT, &sa, &oldInt);
+        ::sigaction(SIGTERM, &sa, &oldTerm);
+
+        LOG(INFO) << "serve: listening on " << socket.string() << ", " << workers << " worker(s)";
+        std::size_t accepted = 0, dropped = 0;
+        {
+            Server server(workers, handle);
+            for (;;)
+            {
+                pollfd pfd[2] = { { listenFd, POLLIN, 0 }, { g_stopPipe[0], POLLIN, 0 } };
+                if (::poll(pfd, 2, -1) < 0)
+                {
+                    if (errno == EINTR) continue;
+                    LOG(ERROR) << sysError("serve: poll");
+                    break;
+                }
+                if (pfd[1].revents & POLLIN) break;
+                if (!(pfd[0].revents & POLLIN)) continue;
+
+                const int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+                if (fd < 0)
+                {
+                    if (errno != EINTR && errno != EAGAIN && errno != ECONNABORTED) LOG(WARNING) << sysError("serve: accept");
+                    continue;
+                }
+                if (server.push(fd))
+                {
+                    ++accepted;
+                    continue;
+                }
+                ++dropped;
+                ::close(fd);
+            }
+
+            //---Новых клиентов не ждём; деструктор дожидается начатых запросов
+            ::close(listenFd);
+            ::unlink(socket.c_str());
+            LOG(INFO) << "serve: stopping, " << server.served() << " of " << accepted << " connection(s) served";
+        }
+        if (dropped) LOG(WARNING) << "serve: " << dropped << " connection(s) dropped: queue full";
+
+        ::sigaction(SIGINT, &oldInt, nullptr);
+        ::sigaction(SIGTERM, &oldTerm, nullptr);
+        ::close(g_stopPipe[0]);
+        ::close(g_stopPipe[1]);
+        g_stopPipe[0] = g_stopPipe[1] = -1;
+        return true;
+    }
+
+} // namespace svcinst::platform
+
+#endif // __linux__
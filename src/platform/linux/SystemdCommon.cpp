@@ -0,0 +1,683 @@
+#if defined(__linux__)
+
+#include "platform/linux/SystemdCommon.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace svcinst::systemd {
+
+    namespace {
+
+        //---Очищает описание от символов новой строки
+        static std::string sanitizeDescription(const std::string& s)
+        {
+            // В unit-файле нежелательны переводы строк
+            std::string out;
+            out.reserve(s.size());
+            for (char c : s)
+            {
+                if (c == '\r' || c == '\n') continue;
+                out.push_back(c);
+            }
+            if (out.empty()) out = "service";
+            return out;
+        }
+
+        //---Добавляет кавычки к строке, если она содержит пробелы или кавычки
+        static std::string quoteIfNeeded(const std::string& s)
+        {
+            //---Для ExecStart systemd поддерживает кавычки. Мы гарантируем кавычки для exe с пробелами.
+            //   Аргументы добавляем "как есть" (на следующем шаге можно сделать токенизацию).
+            if (s.empty()) return "\"\"";
+
+            bool need = false;
+            for (char c : s)
+            {
+                if (c == ' ' || c == '\t' || c == '"') { need = true; break; }
+            }
+            if (!need) return s;
+
+            std::string out;
+            out.reserve(s.size() + 2);
+            out.push_back('"');
+            for (char c : s)
+            {
+                if (c == '"') out += "\\\"";  //---Экранируем кавычки внутри строки
+                else out.push_back(c);
+            }
+            out.push_back('"');
+            return out;
+        }
+
+        //---Обрезка пробельных символов по краям
+        static std::string trim(const std::string& s)
+        {
+            const char* ws = " \t\r\n";
+            const auto b = s.find_first_not_of(ws);
+            if (b == std::string::npos) return {};
+            const auto e = s.find_last_not_of(ws);
+            return s.substr(b, e - b + 1);
+        }
+
+        //---Разбиение списка значений ("a.target b.target") по пробелам
+        static void appendWords(const std::string& s, std::vector<std::string>& out)
+        {
+            std::istringstream is(s);
+            std::string w;
+            while (is >> w) out.push_back(w);
+        }
+
+        //---Разбор секции [Install] из текста unit-файла
+        //   Поддерживаются WantedBy= и RequiredBy= (в том числе повторные и списком через пробел);
+        //   пустое значение сбрасывает накопленный список, как в systemd.
+        static void parseInstallSection(const std::string& text, InstallSection& out)
+        {
+            std::istringstream f(text);
+            bool inInstall = false;
+            std::string line;
+            while (std::getline(f, line))
+            {
+                line = trim(line);
+                if (line.empty() || line[0] == '#' || line[0] == ';') continue;
+
+                if (line.front() == '[')
+                {
+                    inInstall = (line == "[Install]");
+                    continue;
+                }
+                if (!inInstall) continue;
+
+                const auto eq = line.find('=');
+                if (eq == std::string::npos) continue;
+                const std::string key = trim(line.substr(0, eq));
+                const std::string value = trim(line.substr(eq + 1));
+
+                std::vector<std::string>* list =
+                    (key == "WantedBy") ? &out.wantedBy :
+                    (key == "RequiredBy") ? &out.requiredBy : nullptr;
+                if (!list) continue;
+
+                if (value.empty()) list->clear();
+                else appendWords(value, *list);
+            }
+        }
+
+        //---Службы из After= секции [Unit] (только *.service, без суффикса)
+        //   Порядок запуска задаёт именно After=; Wants= без After= стартует параллельно
+        static void parseAfterServices(const std::string& text, std::vector<std::string>& out)
+        {
+            std::istringstream f(text);
+            bool inUnit = false;
+            std::string line;
+            std::vector<std::string> words;
+            while (std::getline(f, line))
+            {
+                line = trim(line);
+                if (line.empty() || line[0] == '#' || line[0] == ';') continue;
+
+                if (line.front() == '[')
+                {
+                    inUnit = (line == "[Unit]");
+                    continue;
+                }
+                if (!inUnit) continue;
+
+                const auto eq = line.find('=');
+                if (eq == std::string::npos || trim(line.substr(0, eq)) != "After") continue;
+                const std::string value = trim(line.substr(eq + 1));
+                if (value.empty())
+                {
+                    out.clear();
+                    continue;
+                }
+                words.clear();
+                appendWords(value, words);
+                for (const std::string& w : words)
+                {
+                    constexpr std::string_view kSuffix = ".service";
+                    if (w.size() <= kSuffix.size() || w.compare(w.size() - kSuffix.size(), kSuffix.size(), kSuffix) != 0) continue;
+                    out.push_back(w.substr(0, w.size() - kSuffix.size()));
+                }
+            }
+        }
+
+        //---fsync каталога: фиксирует создание/переименование/удаление записей в нём
+        static bool syncDir(const fs::path& dir, std::string* error)
+        {
+            const int dfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            int err = (dfd < 0) ? errno : 0;
+            if (!err && ::fsync(dfd) != 0) err = errno;
+            if (dfd >= 0) ::close(dfd);
+            if (err)
+            {
+                if (error) *error = "Failed to fsync directory: " + dir.string() + " : " + std::error_code(err, std::generic_category()).message();
+                return false;
+            }
+            return true;
+        }
+
+        //---Создание (или замена) симлинка link -> target
+        //   Симлинк создаётся рядом под временным именем и переименовывается поверх,
+        //   так что link никогда не пропадает и не указывает в никуда.
+        static bool replaceSymlink(const fs::path& target, const fs::path& link, std::string* error)
+        {
+            std::error_code ec;
+            if (fs::is_symlink(fs::symlink_status(link, ec)))
+            {
+                if (fs::read_symlink(link, ec) == target && !ec) return true;
+            }
+
+            fs::path tmp = link;
+            tmp += ".svcinst-tmp";
+            fs::remove(tmp, ec);
+            fs::create_symlink(target, tmp, ec);
+            if (!ec) fs::rename(tmp, link, ec);
+            if (ec)
+            {
+                fs::remove(tmp, ec);
+                if (error)
+                {
+                    std::ostringstream os;
+                    os << "Failed to create symlink: " << link.string() << " -> " << target.string() << " : " << ec.message();
+                    *error = os.str();
+                }
+                return false;
+            }
+            return true;
+        }
+
+    } // namespace
+
+    //---Проверка корректности имени systemd unit
+    //   Имена должны состоять только из безопасных символов
+    //   разрешенные символы: A-Z, a-z, 0-9, '_', '.', '-'
+    bool isValidUnitName(const std::string& name)
+    {
+        //---Минимально строгая валидация: systemd unit name обычно безопаснее
+        //   ограничить на [A-Za-z0-9_.-]. Без пробелов и слэшей.
+        if (name.empty()) return false;
+
+        for (char c : name)
+        {
+            const bool ok =
+                (c >= 'a' && c <= 'z') ||
+                (c >= 'A' && c <= 'Z') ||
+                (c >= '0' && c <= '9') ||
+                c == '_' || c == '.' || c == '-';
+            if (!ok) return false;
+        }
+        return true;
+    }
+    
+    //---Возвращает путь p внутри альтернативного корня
+    fs::path underRoot(const fs::path& root, const fs::path& p)
+    {
+        if (root.empty()) return p;
+        return root / p.relative_path();
+    }
+
+    //---Возвращает каталог системных unit'ов
+    fs::path unitDir(const fs::path& root)
+    {
+        return underRoot(root, "/etc/systemd/system");
+    }
+
+    //---Возвращает полный путь к файлу systemd unit
+    fs::path unitPath(const std::string& name, const fs::path& root)
+    {
+        // системный unit - размещается в /etc/systemd/system/
+        return unitDir(root) / (name + ".service");
+    }
+
+    //---Возвращает полное имя unit с расширением .service
+    std::string unitName(const std::string& name)
+    {
+        return name + ".service";
+    }
+
+    //---Таймаут операции над unit'ом в зависимости от глагола (systemctl / D-Bus)
+    //   start/stop/restart ждут завершения job'а: systemd по умолчанию даёт
+    //   TimeoutStartSec/TimeoutStopSec = 90s, поэтому берём с запасом.
+    //   Остальные операции не зависят от самой службы и должны быть быстрыми.
+    std::uint32_t operationTimeoutMs(const std::string& verb)
+    {
+        struct VerbTimeout { const char* verb; std::uint32_t ms; };
+        static constexpr VerbTimeout kTimeouts[] = {
+            { "daemon-reload", 120 * 1000 },
+            { "enable",         30 * 1000 },
+            { "disable",        30 * 1000 },
+            { "start",         120 * 1000 },
+            { "stop",          120 * 1000 },
+            { "restart",       210 * 1000 },  // stop + start
+        };
+        constexpr std::uint32_t kDefaultMs = 60 * 1000;
+
+        //---SVCINST_UNIT_TIMEOUT_MS (читается один раз) - общий таймаут вместо таблицы:
+        //   медленные стенды и тесты на подменной шине
+        static const std::uint32_t fromEnv = [] {
+            const char* v = std::getenv("SVCINST_UNIT_TIMEOUT_MS");
+            char* end = nullptr;
+            const unsigned long n = (v && *v) ? std::strtoul(v, &end, 10) : 0;
+            return (end && *end == '\0' && n > 0 && n <= 24ul * 3600 * 1000) ? std::uint32_t(n) : 0u;
+        }();
+        if (fromEnv) return fromEnv;
+
+        for (const auto& t : kTimeouts)
+        {
+            if (verb == t.verb) return t.ms;
+        }
+        return kDefaultMs;
+    }
+
+    //---Генерация файла systemd unit
+
+    //---Формирует содержимое unit-файла по спецификации сервиса
+    std::string renderUnit(const ServiceSpec& spec)
+    {
+        const std::string desc = sanitizeDescription(spec.description.empty() ? spec.name : spec.description);
+
+        //---exeAbs должен быть абсолютным путем
+        const std::string exe = spec.exeAbs.string();
+        const std::string execStart = quoteIfNeeded(exe) + (spec.args.empty() ? "" : (" " + spec.args));
+
+        //---Политика восстановления — аналог Windows recovery:
+        //   Restart=on-failure, RestartSec=2, StartLimitBurst=3, StartLimitIntervalSec=10
+        //---Зависимости от других служб: порядок (After=) и подтягивание при запуске (Wants=)
+        std::string deps;
+        for (const std::string& d : spec.dependsOn) deps += " " + unitName(d);
+
+        std::ostringstream f;
+        f << kManagedMarker << "\n"              // По маркеру --reconcile находит свои unit'ы
+            "[Unit]\n"
+            "Description=" << desc << "\n"
+            "After=network.target" << deps << "\n"    // Сервис запускается после настройки сети (и зависимостей)
+            << (deps.empty() ? "" : "Wants=" + deps.substr(1) + "\n") <<
+            "\n"
+            "[Service]\n"
+            "Type=simple\n"                    // Простой сервис без дополнительного контроля
+            "ExecStart=" << execStart << "\n"
+            "Restart=on-failure\n"             // Перезапускать при ошибках
+            "RestartSec=2\n"                   // Ждать 2 секунды перед перезапуском
+            "StartLimitBurst=3\n"              // Максимум 3 попытки запуска
+            "StartLimitIntervalSec=10\n"       // В течение 10 секунд
+            "\n"
+            "[Install]\n"
+            "WantedBy=multi-user.target\n";    // Запускать в multi-user режиме
+        return f.str();
+    }
+
+    //---Атомарно записывает готовое содержимое unit-файла
+    //   Временный файл в том же каталоге -> (fsync) -> renameat поверх -> (fsync каталога):
+    //   читатель (в том числе параллельный daemon-reload) видит либо старый unit, либо новый целиком.
+    bool writeUnitFile(const ServiceSpec& spec, const std::string& content, Durability durability, std::string* error)
+    {
+        const fs::path p = unitPath(spec.name, spec.root);
+        const fs::path dir = p.parent_path();
+        const std::string fileName = p.filename().string();
+
+        auto fail = [&](const char* what, const fs::path& path, int err) {
+            if (error)
+            {
+                std::ostringstream os;
+                os << what << ": " << path.string() << " : " << std::error_code(err, std::generic_category()).message();
+                *error = os.str();
+            }
+            return false;
+        };
+
+        std::error_code ec;
+        // ---Создаем директорию, если она не существует (обычно /etc/systemd/system уже существует)
+        fs::create_directories(dir, ec);
+        //---если ec != 0 — не фатально, ошибку покажет open
+
+        const int dfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dfd < 0) return fail("Failed to open unit directory", dir, errno);
+
+        //---Имя временного файла уникально для процесса; точка в начале - systemd такие файлы не грузит
+        static std::atomic<unsigned> seq{ 0 };
+        const std::string tmpName = "." + fileName + ".svcinst-" + std::to_string(::getpid()) + "-" + std::to_string(seq++);
+
+        const int fd = ::openat(dfd, tmpName.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            const int e = errno;
+            ::close(dfd);
+            return fail("Failed to open unit file for writing", dir / tmpName, e);
+        }
+
+        int err = 0;
+        const char* what = nullptr;
+        const char* data = content.data();
+        size_t left = content.size();
+        while (left > 0)
+        {
+            const ssize_t n = ::write(fd, data, left);
+            if (n < 0)
+            {
+                if (errno == EINTR) continue;
+                err = errno; what = "Failed to write unit file";
+                break;
+            }
+            data += n;
+            left -= (size_t)n;
+        }
+        //---Содержимое должно быть на диске до того, как имя начнёт на него указывать
+        if (!err && durability == Durability::File && ::fsync(fd) != 0) { err = errno; what = "Failed to fsync unit file"; }
+        if (::close(fd) != 0 && !err) { err = errno; what = "Failed to write unit file"; }
+
+        if (!err && ::renameat(dfd, tmpName.c_str(), dfd, fileName.c_str()) != 0) { err = errno; what = "Failed to replace unit file"; }
+        if (err)
+        {
+            ::unlinkat(dfd, tmpName.c_str(), 0);
+            ::close(dfd);
+            return fail(what, p, err);
+        }
+
+        //---Фиксируем сам rename (запись каталога)
+        if (durability == Durability::File && ::fsync(dfd) != 0)
+        {
+            const int e = errno;
+            ::close(dfd);
+            return fail("Failed to fsync unit directory", dir, e);
+        }
+        ::close(dfd);
+        return true;
+    }
+
+    //---Удаляет unit-файл (отсутствие файла - не ошибка)
+    bool removeUnitFile(const std::string& name, const fs::path& root, Durability durability, std::string* error)
+    {
+        const fs::path p = unitPath(name, root);
+        std::error_code ec;
+        if (!fs::remove(p, ec))
+        {
+            if (!ec) return true;
+            if (error)
+            {
+                std::ostringstream os;
+                os << "Failed to remove unit file: " << p.string() << " : " << ec.message();
+                *error = os.str();
+            }
+            return false;
+        }
+        return durability != Durability::File || syncDir(p.parent_path(), error);
+    }
+
+    //---Сбрасывает на диск файловую систему с unit'ами одним syncfs (Durability::Batch)
+    bool syncUnitFs(const fs::path& root, std::string* error)
+    {
+        const fs::path dir = unitDir(root);
+        const int dfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        int err = (dfd < 0) ? errno : 0;
+        if (!err && ::syncfs(dfd) != 0) err = errno;
+        if (dfd >= 0) ::close(dfd);
+        if (err)
+        {
+            if (error) *error = "syncfs " + dir.string() + " : " + std::error_code(err, std::generic_category()).message();
+            return false;
+        }
+        return true;
+    }
+
+    //---Читает unit-файл целиком; false - файла нет или он не читается
+    bool readUnitFile(const std::string& name, const fs::path& root, std::string& out)
+    {
+        out.clear();
+        std::ifstream f(unitPath(name, root), std::ios::binary);
+        if (!f) return false;
+
+        std::ostringstream os;
+        os << f.rdbuf();
+        if (f.bad()) return false;
+        out = os.str();
+        return true;
+    }
+
+    //---Проверяет существование файла systemd unit
+    bool unitFileExists(const std::string& name, const fs::path& root)
+    {
+        std::error_code ec;
+        return fs::exists(unitPath(name, root), ec);
+    }
+
+    //---Проверка имён зависимостей спецификации
+    bool validateDependencies(const ServiceSpec& spec, std::string* error)
+    {
+        for (const std::string& d : spec.dependsOn)
+        {
+            if (!isValidUnitName(d))
+            {
+                if (error) *error = "installOrUpdate: invalid dependency name '" + d + "' (allowed: A-Za-z0-9_.-)";
+                return false;
+            }
+            if (d == spec.name)
+            {
+                if (error) *error = "installOrUpdate: service '" + d + "' cannot depend on itself";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //---Службы, после которых стартует name (After=*.service из unit-файла)
+    bool readUnitDependencies(const std::string& name, const fs::path& root, std::vector<std::string>& out, std::string* error)
+    {
+        out.clear();
+        std::string text;
+        if (!readUnitFile(name, root, text))
+        {
+            if (error) *error = "Failed to open unit file for reading: " + unitPath(name, root).string();
+            return false;
+        }
+        parseAfterServices(text, out);
+        return true;
+    }
+
+    //---Unit создан установщиком: первая строка - маркер
+    bool isManagedUnit(const std::string& content)
+    {
+        const std::string_view m(kManagedMarker);
+        return content.size() > m.size() && content.compare(0, m.size(), m) == 0 && content[m.size()] == '\n';
+    }
+
+    //---Содержимое unit'а совпадает с rendered; отсутствие маркера различием не считается
+    bool unitMatches(const std::string& onDisk, const std::string& rendered)
+    {
+        if (onDisk == rendered) return true;
+        if (!isManagedUnit(rendered)) return false;
+        const std::size_t body = std::strlen(kManagedMarker) + 1;
+        return onDisk.size() + body == rendered.size() && rendered.compare(body, std::string::npos, onDisk) == 0;
+    }
+
+    //---Список служб, unit'ы которых созданы установщиком (<root>/etc/systemd/system/*.service с маркером)
+    bool listManagedUnits(const fs::path& root, std::vector<std::string>& names, std::string* error)
+    {
+        names.clear();
+        const fs::path dir = unitDir(root);
+        std::error_code ec;
+        fs::directory_iterator it(dir, ec);
+        if (ec)
+        {
+            //---Каталога ещё нет (пустой образ) - служб тоже нет
+            if (ec == std::errc::no_such_file_or_directory) return true;
+            if (error) *error = "Failed to list directory: " + dir.string() + " : " + ec.message();
+            return false;
+        }
+
+        //---Читается только начало файла: маркер - первая строка
+        std::string head(std::strlen(kManagedMarker) + 1, '\0');
+        for (const fs::directory_entry& e : it)
+        {
+            const fs::path& p = e.path();
+            if (p.extension() != ".service" || !e.is_regular_file(ec)) continue;
+            const std::string name = p.stem().string();
+            if (!isValidUnitName(name)) continue;
+
+            std::ifstream f(p, std::ios::binary);
+            if (!f.read(head.data(), (std::streamsize)head.size())) continue;
+            if (isManagedUnit(head)) names.push_back(name);
+        }
+        std::sort(names.begin(), names.end());
+        return true;
+    }
+
+    //---Состояние unit'а относительно спецификации (файл и автозапуск)
+    SpecState inspectUnit(const ServiceSpec& spec)
+    {
+        std::string onDisk;
+        if (!readUnitFile(spec.name, spec.root, onDisk)) return SpecState::Missing;
+        if (!unitMatches(onDisk, renderUnit(spec))) return SpecState::Differs;
+        return autostartMatches(spec.name, spec.root, spec.autostart) ? SpecState::UpToDate : SpecState::Differs;
+    }
+
+    //---Включение/отключение автозапуска через симлинки
+
+    //---Читает секцию [Install] unit-файла
+    bool readInstallSection(const std::string& name, const fs::path& root, InstallSection& out, std::string* error)
+    {
+        out = {};
+
+        std::string text;
+        if (!readUnitFile(name, root, text))
+        {
+            if (error) *error = "Failed to open unit file for reading: " + unitPath(name, root).string();
+            return false;
+        }
+        parseInstallSection(text, out);
+        return true;
+    }
+
+    //---Проверяет, что симлинки автозапуска соответствуют желаемому состоянию
+    //   enabled: есть все симлинки из [Install] и они указывают на unit;
+    //   !enabled: ни в одном *.wants/ и *.requires/ нет симлинка на unit.
+    bool autostartMatches(const std::string& name, const fs::path& root, bool enabled)
+    {
+        const std::string u = unitName(name);
+
+        if (!enabled)
+        {
+            std::error_code ec;
+            fs::directory_iterator it(unitDir(root), ec);
+            if (ec) return ec == std::errc::no_such_file_or_directory;
+            for (; it != fs::directory_iterator(); it.increment(ec))
+            {
+                const std::string ext = it->path().extension().string();
+                if (ext != ".wants" && ext != ".requires") continue;
+                std::error_code lec;
+                if (fs::is_symlink(fs::symlink_status(it->path() / u, lec))) return false;
+            }
+            return !ec;
+        }
+
+        InstallSection inst;
+        if (!readInstallSection(name, root, inst, nullptr)) return false;
+
+        const fs::path target = unitPath(name);
+        struct Dep { const std::vector<std::string>* targets; const char* suffix; };
+        const Dep deps[] = { { &inst.wantedBy, ".wants" }, { &inst.requiredBy, ".requires" } };
+        for (const Dep& d : deps)
+        {
+            for (const std::string& t : *d.targets)
+            {
+                std::error_code ec;
+                if (fs::read_symlink(unitDir(root) / (t + d.suffix) / u, ec) != target || ec) return false;
+            }
+        }
+        return true;
+    }
+
+    //---Создает симлинки автозапуска по секции [Install] (аналог systemctl enable)
+    bool enableUnitLinks(const std::string& name, const fs::path& root, Durability durability, std::string* error)
+    {
+        InstallSection inst;
+        if (!readInstallSection(name, root, inst, error)) return false;
+
+        //---Цель симлинка - путь с точки зрения системы, в которой unit будет работать
+        const fs::path target = unitPath(name);
+        const std::string u = unitName(name);
+
+        struct Dep { const std::vector<std::string>* targets; const char* suffix; };
+        const Dep deps[] = { { &inst.wantedBy, ".wants" }, { &inst.requiredBy, ".requires" } };
+
+        for (const Dep& d : deps)
+        {
+            for (const std::string& t : *d.targets)
+            {
+                if (!isValidUnitName(t))
+                {
+                    if (error) *error = "Invalid target in [Install] of " + u + ": " + t;
+                    return false;
+                }
+
+                const fs::path dir = unitDir(root) / (t + d.suffix);
+                std::error_code ec;
+                fs::create_directories(dir, ec);
+                if (ec)
+                {
+                    if (error) *error = "Failed to create directory: " + dir.string() + " : " + ec.message();
+                    return false;
+                }
+                if (!replaceSymlink(target, dir / u, error)) return false;
+                if (durability == Durability::File && !syncDir(dir, error)) return false;
+            }
+        }
+        return true;
+    }
+
+    //---Удаляет симлинки автозапуска unit'а (аналог systemctl disable)
+    //   Просматриваются все *.wants/ и *.requires/, а не только цели из текущего [Install]:
+    //   unit-файл мог поменяться или уже отсутствовать.
+    bool disableUnitLinks(const std::string& name, const fs::path& root, Durability durability, std::string* error)
+    {
+        const std::string u = unitName(name);
+        const fs::path dir = unitDir(root);
+
+        std::error_code ec;
+        fs::directory_iterator it(dir, ec);
+        if (ec)
+        {
+            //---Нет каталога - нет и симлинков
+            if (ec == std::errc::no_such_file_or_directory) return true;
+            if (error) *error = "Failed to list directory: " + dir.string() + " : " + ec.message();
+            return false;
+        }
+
+        for (; it != fs::directory_iterator(); it.increment(ec))
+        {
+            const std::string ext = it->path().extension().string();
+            if (ext != ".wants" && ext != ".requires") continue;
+
+            const fs::path link = it->path() / u;
+            std::error_code lec;
+            if (!fs::is_symlink(fs::symlink_status(link, lec))) continue;
+
+            fs::remove(link, lec);
+            if (lec)
+            {
+                if (error) *error = "Failed to remove symlink: " + link.string() + " : " + lec.message();
+                return false;
+            }
+            if (durability == Durability::File && !syncDir(it->path(), error)) return false;
+        }
+        if (ec)
+        {
+            if (error) *error = "Failed to list directory: " + dir.string() + " : " + ec.message();
+            return false;
+        }
+        return true;
+    }
+
+} // namespace svcinst::systemd
+
+#endif // __linux__
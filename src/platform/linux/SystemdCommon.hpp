@@ -0,0 +1,83 @@
+#pragma once
+#include "service_installer/ServiceSpec.hpp"
+#include "service_installer/IServiceBackend.hpp"
+#include "service_installer/Platform.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+//---Общие для Linux-бэкендов (systemctl / D-Bus) операции с unit-файлами systemd
+namespace svcinst::systemd {
+
+    namespace fs = std::filesystem;
+
+    //---Проверка корректности имени systemd unit (разрешены только A-Z, a-z, 0-9, '_', '.', '-')
+    bool isValidUnitName(const std::string& name);
+    //---Путь p внутри альтернативного корня (пустой root - живая система)
+    fs::path underRoot(const fs::path& root, const fs::path& p);
+    //---Каталог системных unit'ов: <root>/etc/systemd/system
+    fs::path unitDir(const fs::path& root = {});
+    //---Полный путь к файлу unit: <root>/etc/systemd/system/<name>.service
+    fs::path unitPath(const std::string& name, const fs::path& root = {});
+    //---Полное имя unit с расширением .service
+    std::string unitName(const std::string& name);
+    //---Таймаут операции над unit'ом по глаголу ("daemon-reload", "start", ...), мс
+    std::uint32_t operationTimeoutMs(const std::string& verb);
+
+    //---Первая строка каждого unit'а, созданного установщиком
+    inline constexpr const char* kManagedMarker = "# Managed by service-installer: manual edits are overwritten";
+    //---Содержимое unit-файла для спецификации сервиса (то, что пишет writeUnitFile)
+    std::string renderUnit(const ServiceSpec& spec);
+    //---Имена зависимостей (spec.dependsOn) допустимы и не ссылаются на саму службу
+    bool validateDependencies(const ServiceSpec& spec, std::string* error);
+    //---Службы, после которых запускается name: *.service из After= секции [Unit]
+    bool readUnitDependencies(const std::string& name, const fs::path& root, std::vector<std::string>& out, std::string* error);
+    //---Unit создан установщиком (начинается с kManagedMarker)
+    bool isManagedUnit(const std::string& content);
+    //---Файл на диске совпадает с rendered (результат renderUnit). Unit, записанный до появления
+    //   маркера, с тем же остальным содержимым тоже совпадает: иначе первый запуск новой версии
+    //   перезаписал бы каждый unit и перезапустил работающие службы ради строки комментария
+    bool unitMatches(const std::string& onDisk, const std::string& rendered);
+    //---Службы, unit'ы которых созданы установщиком: <root>/etc/systemd/system/*.service с маркером
+    //   Unit'ы без маркера (чужие или записанные старой версией) не попадают - их --reconcile не удаляет
+    bool listManagedUnits(const fs::path& root, std::vector<std::string>& names, std::string* error);
+    //---Состояние unit'а относительно спецификации: нет файла / файл или автозапуск отличаются / совпадает
+    SpecState inspectUnit(const ServiceSpec& spec);
+    //---Атомарная запись сформированного содержимого unit-файла (под spec.root)
+    //   temp-файл + rename; durability: File - fsync файла и каталога, Batch/None - без fsync
+    bool writeUnitFile(const ServiceSpec& spec, const std::string& content, Durability durability, std::string* error);
+    //---Удаление unit-файла (отсутствие файла - не ошибка)
+    bool removeUnitFile(const std::string& name, const fs::path& root, Durability durability, std::string* error);
+    //---Один syncfs файловой системы с unit'ами (завершение Durability::Batch)
+    bool syncUnitFs(const fs::path& root, std::string* error);
+    //---Чтение unit-файла целиком (false - файла нет или он не читается)
+    bool readUnitFile(const std::string& name, const fs::path& root, std::string& out);
+    //---Проверка существования файла unit
+    bool unitFileExists(const std::string& name, const fs::path& root = {});
+
+    //---Цели из секции [Install] unit-файла
+    struct InstallSection {
+        std::vector<std::string> wantedBy;      //	WantedBy=   -> <target>.wants/
+        std::vector<std::string> requiredBy;    //	RequiredBy= -> <target>.requires/
+    };
+    //---Чтение секции [Install] записанного unit-файла
+    bool readInstallSection(const std::string& name, const fs::path& root, InstallSection& out, std::string* error);
+
+    //---Включение автозапуска без systemctl: симлинки <target>.wants/<unit> -> unitPath(name)
+    //   по секции [Install]. Работает и без запущенного systemd; вступает в силу после daemon-reload.
+    //   Под альтернативным корнем симлинк указывает на путь внутри образа, а не на <root>/...
+    bool enableUnitLinks(const std::string& name, const fs::path& root, Durability durability, std::string* error);
+    //---Отключение автозапуска без systemctl: удаление всех симлинков на unit
+    //   из <target>.wants/ и <target>.requires/ в unitDir(root)
+    bool disableUnitLinks(const std::string& name, const fs::path& root, Durability durability, std::string* error);
+    //---Соответствуют ли симлинки автозапуска желаемому состоянию (enabled / disabled)
+    bool autostartMatches(const std::string& name, const fs::path& root, bool enabled);
+
+    //---Бэкенд, вызывающий systemd напрямую по D-Bus (BackendLinuxDbus.cpp)
+    //   Есть только в сборке с SVCINST_HAVE_DBUS.
+    std::unique_ptr<IServiceBackend> makeDbusBackend(const BackendOptions& opt);
+
+} // namespace svcinst::systemd
@@ -1,13 +1,15 @@
 #ifdef _WIN32
 
 #include "service_installer/IServiceBackend.hpp"
+#include "service_installer/Plan.hpp"
 #include "service_installer/Process.hpp"
+#include "platform/PlatformImpl.hpp"
+#include "Log.hpp"
 
 #include <windows.h>
 #include <filesystem>
 #include <memory>
 #include <sstream>
-#include <glog/logging.h>
 
 
 namespace svcinst {
@@ -61,6 +63,12 @@ namespace svcinst {
             }
             return false;
         }
+        //---Учёт времени sc.exe (подробности на VLOG(1))
+        VLOG(1) << what << ": wall=" << rr.stats.wallUs / 1000 << "ms"
+            << " user=" << rr.stats.userCpuUs / 1000 << "ms"
+            << " sys=" << rr.stats.sysCpuUs / 1000 << "ms"
+            << " maxRss=" << rr.stats.maxRssKb << "KiB";
+
         //---Проверяем код завершения sc.exe
         if (!scOkExit(rr.exitCode, okExitCodes))
         {
@@ -211,10 +219,13 @@ namespace svcinst {
     //------------------------------------------------------------
     class BackendWinSc final : public IServiceBackend {
     public:
+        //---plan != nullptr - режим --plan: sc.exe запускается только для чтения (sc query)
+        explicit BackendWinSc(Plan* plan) : plan_(plan) {}
+
         //------------------------------------------------------------
 		//  Установка или обновление службы
         //------------------------------------------------------------
-        bool installOrUpdate(const ServiceSpec& spec, std::string* error) override
+        bool installOrUpdate(const ServiceSpec& spec, std::string* error, InstallReport* report = nullptr) override
         {
             //---Проверка на пустое имя службы
 			if (spec.name.empty())
@@ -246,12 +257,20 @@ namespace svcinst {
             const std::string startType = spec.autostart ? "auto" : "demand";   
             //---Формируем значение binPath
             const std::string binValue = buildBinPathValue(spec);
+            //---Зависимости: depend= a/b/c ("/" - сбросить список)
+            std::string dependValue;
+            for (const std::string& d : spec.dependsOn)
+            {
+                if (!dependValue.empty()) dependValue += "/";
+                dependValue += d;
+            }
+            if (dependValue.empty()) dependValue = "/";
 
             //---Если службы не существует - создаем новую
             if (!exists)
             {
                 //---Команда создания службы: sc create "<name>" binPath= "<value>" start= auto
-                if (!runSc(
+                if (!sc(
                     { 
                         "create", spec.name,            // Команда create и имя службы
                         "binPath=", binValue,           // binPath= "<путь к exe> [аргументы]"
@@ -268,7 +287,7 @@ namespace svcinst {
             else
             {
 				//---Если служба уже существует, останавливаем её перед обновлением параметров
-                if (!runSc(
+                if (!sc(
                     {"stop" , spec.name},
                     {0,(int)ERROR_SERVICE_NOT_ACTIVE},
                     error,
@@ -282,11 +301,12 @@ namespace svcinst {
             //---Всегда выполняем config - обновляем параметры существующей службы
             //   Даже если только что создали службу, настраиваем её параметры
             //   всегда config (обновить binPath/start)
-            if (!runSc(
+            if (!sc(
                 { 
                     "config", spec.name,               // Команда config и имя службы 
                     "binPath=", binValue,              // Обновляем путь к исполняемому файлу
-                    "start=", startType                // Обновляем тип запуска
+                    "start=", startType,               // Обновляем тип запуска
+                    "depend=", dependValue             // Обновляем зависимости
                 },
                 { 0 },                                 // Только код 0 считается успехом
                 error,                                 // Указатель для ошибки
@@ -299,7 +319,7 @@ namespace svcinst {
 			//---Установка описания службы (опционально)
 			if (!spec.description.empty())  // Если описание не пустое
 			{
-				if (!runSc(
+				if (!sc(
 					{
 						"description", spec.name, spec.description          // Команда description и имя службы
 					},
@@ -314,7 +334,7 @@ namespace svcinst {
             //---Настройка восстановления службы при сбоях
             //   reset= 10 - сбрасывать счетчик сбоев через 10 секунд
             //   actions= restart/2000/restart/2000/restart/2000 - три попытки перезапуска с интервалом 2 сек
-			if (!runSc(
+			if (!sc(
 				{
 					"failure", spec.name,                                   // Команда failure и имя службы
 					"reset=", "10",                                         // Сброс счетчика через 10 сек
@@ -330,7 +350,7 @@ namespace svcinst {
              
 			//---Включение флага восстановления службы
 			//   failureflag 1 - включаем обработку сбоев
-			if (!runSc(
+			if (!sc(
 				{
 					"failureflag", spec.name, "1"                           // Команда failureflag и имя службы
 				},
@@ -341,6 +361,13 @@ namespace svcinst {
 			{
 				return false;   // Если включение флага не удалось
 			}
+            //---sc config выполняется всегда; запуск (runNow) остаётся за вызывающим
+            if (report)
+            {
+                *report = InstallReport{};
+                report->unitWritten = true;
+                report->autostartChanged = true;
+            }
             return true;    // Все операции успешно выполнены
         }
         //------------------------------------------------------------
@@ -370,7 +397,7 @@ namespace svcinst {
             {
                 // Команда остановки службы
                 // ERROR_SERVICE_NOT_ACTIVE (1062) - "служба не запущена", считается допустимым
-                if (!runSc(
+                if (!sc(
                     { "stop", name },                           // Команда stop и имя службы
                     { 0, (int)ERROR_SERVICE_NOT_ACTIVE },       // Допустимые коды: 0 или 1062
                     error,                                      // Указатель для ошибки
@@ -382,7 +409,7 @@ namespace svcinst {
             }
             //---Удаление службы
             //   ERROR_SERVICE_MARKED_FOR_DELETE (1072) - "служба помечена на удаление", допустимо
-            if (!runSc(
+            if (!sc(
                 { "delete", name },                             // Команда delete и имя службы
                 { 0, (int)ERROR_SERVICE_MARKED_FOR_DELETE },    // Допустимые коды: 0 или 1072
                 error,                                          // Указатель для ошибки
@@ -400,7 +427,7 @@ namespace svcinst {
 		{
 			//---Команда запуска службы
 			//   ERROR_SERVICE_ALREADY_RUNNING (1056) - "служба уже запущена", допустимо
-			return runSc(
+			return sc(
 				{ "start", name },                              // Команда start и имя службы
 				{ 0, (int)ERROR_SERVICE_ALREADY_RUNNING },      // Допустимые коды: 0 или 1056
 				error,                                          // Указатель для ошибки                                
@@ -414,13 +441,29 @@ namespace svcinst {
 		{
 			//---Команда остановки службы
 			//  ERROR_SERVICE_NOT_ACTIVE (1062) - "служба не запущена", допустимо
-			return runSc(
+			return sc(
 				{ "stop", name },                               // Команда stop и имя службы
 				{ 0, (int)ERROR_SERVICE_NOT_ACTIVE },           // Допустимые коды: 0 или 1062
 				error,                                          // Указатель для ошибки 
 				"sc stop"                                       // Описание операции
 			);
 		}
+
+    private:
+        //------------------------------------------------------------
+        //  Изменяющий вызов sc.exe; в режиме --plan - только запись шага
+        //------------------------------------------------------------
+        bool sc(const std::vector<std::string>& args, std::initializer_list<int> okExitCodes, std::string* error, const char* what)
+        {
+            if (!plan_) return runSc(args, okExitCodes, error, what);
+
+            std::string cmd = "sc";
+            for (const std::string& a : args) cmd += " " + a;
+            plan_->add({ "sc", cmd, 0, 0, {} });
+            return true;
+        }
+
+        Plan* plan_ = nullptr;
     };
 } // namespace svcinst
 
@@ -428,9 +471,11 @@ namespace svcinst::platform {
     //------------------------------------------------------------
     //  Cоздание бэкенда для текущей платформы
     //------------------------------------------------------------
-    std::unique_ptr<IServiceBackend> makeBackend()
+    std::unique_ptr<IServiceBackend> makeBackend(const BackendOptions& opt)
     {
-        return std::make_unique<svcinst::BackendWinSc>();
+        //---D-Bus/systemd и offline-режим (--root) на Windows не поддерживаются
+        if (opt.kind != BackendKind::Default || !opt.root.empty()) return nullptr;
+        return std::make_unique<svcinst::BackendWinSc>(opt.plan);
     }
 } // namespace svcinst::platform
 
@@ -35,5 +35,69 @@ namespace svcinst::platform {
         return isAdmin == TRUE;
     }
 
+    namespace {
+        //------------------------------------------------------------
+        //  Именованный mutex; освобождается и закрывается деструктором
+        //------------------------------------------------------------
+        class MutexServiceLock final : public ServiceLock {
+        public:
+            explicit MutexServiceLock(HANDLE h) : h_(h) {}
+            ~MutexServiceLock() override
+            {
+                ReleaseMutex(h_);
+                CloseHandle(h_);
+            }
+        private:
+            HANDLE h_;
+        };
+    } // namespace
+
+    //------------------------------------------------------------
+    //  Захват блокировки службы: mutex Global\svcinst-<key>
+    //  Брошенный (WAIT_ABANDONED) mutex - владелец упал, захват успешен
+    //------------------------------------------------------------
+    std::unique_ptr<ServiceLock> lockService(const std::string& key, std::uint32_t waitMs, bool& busy, std::string* error)
+    {
+        busy = false;
+        if (key.empty() || key.find('\\') != std::string::npos)
+        {
+            if (error) *error = "lockService: invalid service name";
+            return nullptr;
+        }
+
+        const std::wstring name = L"Global\\svcinst-" + fs::path(key).wstring();
+        HANDLE h = CreateMutexW(nullptr, FALSE, name.c_str());
+        if (!h)
+        {
+            if (error) *error = "lockService: CreateMutex failed, error=" + std::to_string(GetLastError());
+            return nullptr;
+        }
+
+        const DWORD w = WaitForSingleObject(h, waitMs);
+        if (w == WAIT_OBJECT_0 || w == WAIT_ABANDONED) return std::make_unique<MutexServiceLock>(h);
+
+        CloseHandle(h);
+        if (w == WAIT_TIMEOUT)
+        {
+            busy = true;
+            if (error) *error = "service '" + key + "' is busy: another installer is working with it";
+        }
+        else if (error)
+        {
+            *error = "lockService: WaitForSingleObject failed, error=" + std::to_string(GetLastError());
+        }
+        return nullptr;
+    }
+
+    //------------------------------------------------------------
+    //  Агент (--serve): Unix-сокет и SO_PEERCRED - только Linux
+    //------------------------------------------------------------
+    bool serveLocal(const fs::path& socket, std::size_t workers, const ServeHandler& handle, std::string* error)
+    {
+        (void)socket; (void)workers; (void)handle;
+        if (error) *error = "--serve is not supported on Windows";
+        return false;
+    }
+
 } // namespace svcinst::platform
 #endif
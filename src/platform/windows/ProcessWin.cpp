@@ -1,9 +1,12 @@
 #ifdef _WIN32
 
 #include "platform/ProcessImpl.hpp"
+#include "Log.hpp"
 #include <windows.h>
+#include <psapi.h>
+#include <chrono>
+#include <memory>
 #include <vector>
-#include <glog/logging.h>
 
 namespace svcinst::process::detail {
     //------------------------------------------------------------
@@ -92,12 +95,44 @@ namespace svcinst::process::detail {
         }
         return cmd;
     }
+    //------------------------------------------------------------
+    //  FILETIME (интервал в единицах по 100 нс) -> микросекунды
+    //------------------------------------------------------------
+    static std::uint64_t fileTimeToUs(const FILETIME& ft)
+    {
+        ULARGE_INTEGER v{};
+        v.LowPart = ft.dwLowDateTime;
+        v.HighPart = ft.dwHighDateTime;
+        return v.QuadPart / 10;
+    }
+    //------------------------------------------------------------
+    //  Учёт ресурсов завершившегося процесса
+    //  (переключения контекста Windows не отдаёт - остаются 0)
+    //------------------------------------------------------------
+    static void fillStats(RunStats& st, HANDLE process, std::chrono::steady_clock::time_point started)
+    {
+        st.wallUs = (std::uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - started).count();
+
+        FILETIME createTime{}, exitTime{}, kernelTime{}, userTime{};
+        if (GetProcessTimes(process, &createTime, &exitTime, &kernelTime, &userTime))
+        {
+            st.userCpuUs = fileTimeToUs(userTime);
+            st.sysCpuUs = fileTimeToUs(kernelTime);
+        }
+
+        PROCESS_MEMORY_COUNTERS pmc{};
+        if (GetProcessMemoryInfo(process, &pmc, sizeof(pmc)))
+        {
+            st.maxRssKb = (std::uint64_t)pmc.PeakWorkingSetSize / 1024;
+        }
+    }
     //------------------------------------------------------------
 	//  Платформенно-специфичная реализация запуска процесса для Windows
     //------------------------------------------------------------
     bool runPlatform(const fs::path& exe, const std::vector<std::string>& args, RunResult& out, const RunOptions& opt)
     {
-        out = {};
+        out.reset();
 
         //---Собираем командную строку из пути к исполняемому файлу и аргументов
         const std::wstring cmdLine = buildCommandLine(exe, args);
@@ -107,6 +142,9 @@ namespace svcinst::process::detail {
 
         PROCESS_INFORMATION pi{};
 
+        //---Момент запуска для RunStats::wallUs
+        const auto startedAt = std::chrono::steady_clock::now();
+
         //---Подготовка буфера командной строки
         std::vector<wchar_t> buf(cmdLine.begin(), cmdLine.end());
         buf.push_back(L'\0');
@@ -174,11 +212,59 @@ namespace svcinst::process::detail {
             return false;
         }
 
+        //---Учёт ресурсов потомка
+        fillStats(out.stats, pi.hProcess, startedAt);
+
         //---Закрываем декриптор процесса
         CloseHandle(pi.hProcess);
         //---Сохраняем код завершения
         out.exitCode = (int)code;
         return true;
     }
+    //------------------------------------------------------------
+    //  Асинхронный движок для Windows.
+    //  Пока без параллелизма: процесс выполняется синхронно в spawn(),
+    //  а результат доставляется колбэком из poll(), как и на Linux
+    //------------------------------------------------------------
+    class WinAsyncEngine final : public AsyncEngine {
+    public:
+        bool spawn(const fs::path& exe, const std::vector<std::string>& args,
+            const RunOptions& opt, RunCallback cb) override
+        {
+            Done d;
+            d.cb = std::move(cb);
+            const bool ok = runPlatform(exe, args, d.result, opt);
+            ready_.push_back(std::move(d));
+            return ok || ready_.back().result.started;
+        }
+
+        bool poll(int /*timeoutMs*/) override
+        {
+            //---Колбэк может запускать новые процессы, поэтому очередь забирается целиком
+            std::vector<Done> batch;
+            batch.swap(ready_);
+            for (auto& d : batch)
+            {
+                if (d.cb) d.cb(d.result);
+            }
+            return !ready_.empty();
+        }
+
+        std::size_t pending() const override { return ready_.size(); }
+
+    private:
+        struct Done {
+            RunResult result;
+            RunCallback cb;
+        };
+        std::vector<Done> ready_;
+    };
+    //------------------------------------------------------------
+    //  Фабрика асинхронного движка для Windows
+    //------------------------------------------------------------
+    std::unique_ptr<AsyncEngine> makeAsyncEngine()
+    {
+        return std::make_unique<WinAsyncEngine>();
+    }
 } // namespace svcinst::process::detail
 #endif
@@ -1,13 +1,15 @@
 #ifdef _WIN32
 
 #include "service_installer/Platform.hpp"
+#include "platform/PlatformImpl.hpp"
+#include "Log.hpp"
 #include <windows.h>
 
+#include <cstdint>
 #include <filesystem>
 #include <string>
 #include <system_error>
 #include <vector>
-#include <glog/logging.h>
 
 
 
@@ -149,6 +151,106 @@ namespace svcinst::platform {
         return false;
     }
 
+    //------------------------------------------------------------
+    //  Имя записи в UTF-8 (шаблоны PathFilter - UTF-8)
+    //------------------------------------------------------------
+    static std::string utf8Name(const fs::path& p)
+    {
+        const std::u8string s = p.filename().u8string();
+        return std::string(s.begin(), s.end());
+    }
+    //------------------------------------------------------------
+    //  Выборочное удаление: записи каталога по фильтру
+    //  (true - в каталоге ничего не осталось)
+    //------------------------------------------------------------
+    static bool removeSelected(const fs::path& dir, const PathFilter& filter, const PathFilter::Cursor& cursor,
+        std::uint64_t& kept, std::string& firstError)
+    {
+        bool empty = true;
+        std::error_code ec;
+        fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != fs::directory_iterator(); it.increment(ec))
+        {
+            std::error_code sec;
+            const fs::file_status st = it->symlink_status(sec);
+            const bool isDir = !sec && fs::is_directory(st);
+
+            //---Оставленное не трогаем; в каталог без выбранного не заходим
+            PathFilter::Cursor child;
+            const PathFilter::Action action = filter.visit(cursor, utf8Name(it->path()), isDir, child);
+            if (action == PathFilter::Action::Keep)
+            {
+                ++kept;
+                empty = false;
+                continue;
+            }
+            if (action == PathFilter::Action::Descend)
+            {
+                if (!removeSelected(it->path(), filter, child, kept, firstError) || !child.selected)
+                {
+                    empty = false;
+                    continue;
+                }
+                makeNormalAttributes(it->path());
+                (void)fs::remove(it->path(), sec);
+            }
+            else
+            {
+                //---Ниже фильтр ничего не оставит: поддерево целиком
+                if (isDir) clearAttributesRecursive(it->path());
+                else makeNormalAttributes(it->path());
+                (void)fs::remove_all(it->path(), sec);
+            }
+            if (sec)
+            {
+                empty = false;
+                if (firstError.empty()) firstError = "remove failed for '" + it->path().string() + "': " + sec.message();
+            }
+        }
+        if (ec)
+        {
+            empty = false;
+            if (firstError.empty()) firstError = "cannot list '" + dir.string() + "': " + ec.message();
+        }
+        return empty;
+    }
+    //------------------------------------------------------------
+    //  Выборочное удаление DataRoot (--data-include/--data-exclude):
+    //  сам каталог снимается, только если выбран и опустел
+    //------------------------------------------------------------
+    static bool removeFilteredNow(const fs::path& dir, const PathFilter& filter, std::string* error)
+    {
+        //---Проверка на пустой путь
+        if (dir.empty()) return true;
+
+        //---Те же проверки, что и перед полным удалением
+        if (isDangerousPath(dir))
+        {
+            if (error) *error = "Refuse to delete dangerous path: " + dir.string();
+            LOG(ERROR) << "Refuse to delete dangerous path: " + dir.string();
+            return false;
+        }
+
+        std::error_code ec;
+        if (!fs::exists(dir, ec)) return true;
+
+        std::uint64_t kept = 0;
+        std::string firstError;
+        const PathFilter::Cursor root = filter.root();
+        if (removeSelected(dir, filter, root, kept, firstError) && root.selected)
+        {
+            makeNormalAttributes(dir);
+            (void)fs::remove(dir, ec);
+            if (ec) firstError = "remove failed for '" + dir.string() + "': " + ec.message();
+        }
+        LOG(INFO) << "removed selected entries of " << dir.string() << ", " << kept << " entr" << (kept == 1 ? "y" : "ies") << " kept";
+        if (firstError.empty()) return true;
+
+        if (error) *error = firstError;
+        LOG(ERROR) << firstError;
+        return false;
+    }
+
     //------------------------------------------------------------
     //  Отложенное удаление: cmd.exe в фоне
     //------------------------------------------------------------
@@ -253,7 +355,7 @@ namespace svcinst::platform {
     //------------------------------------------------------------
     //  Удаление директории установки приложения
     //------------------------------------------------------------
-    bool removeInstallDir(const fs::path& installDir, std::string* error,bool fromInno)
+    bool removeInstallDir(const fs::path& installDir, std::string* error,bool fromInno, const DeleteThrottle& /*throttle*/, DeferredRemove* defer)
     {
         //---Если удаление выполняется из InnoSetup
         if (fromInno) return true; // Inno сам удалит {app}, а helper не должен удалять installDir
@@ -265,7 +367,12 @@ namespace svcinst::platform {
 
         //---Если немедленное удаление не удалось, пробуем отложенное удаление
         std::string err2;
-        if (deferRemoveWithCmd(installDir, fs::path{}, &err2)) return true;
+        //   (cmd.exe ждёт не выхода процесса, а 2 секунды - untilExit не различается)
+        if (deferRemoveWithCmd(installDir, fs::path{}, &err2))
+        {
+            if (defer) defer->deferred = true;
+            return true;
+        }
         
         //---Если оба метода не сработали, формируем объединенное сообщение об ошибке
         if (error) 
@@ -277,15 +384,22 @@ namespace svcinst::platform {
     //------------------------------------------------------------
     //  Удаление директории с данными приложения
     //------------------------------------------------------------
-    bool removeDataRoot(const fs::path& dataRoot, std::string* error)
+    bool removeDataRoot(const fs::path& dataRoot, std::string* error, const DeleteThrottle& /*throttle*/, const PathFilter* filter, DeferredRemove* defer)
     {
+        //---Выборочно - только на месте: отложенный rmdir /s снёс бы и оставленное
+        if (filter && filter->active()) return removeFilteredNow(dataRoot, *filter, error);
+
         std::string err;
         //---Пытаемся удалить директорию немедленно
         if (removeTreeNow(dataRoot, &err)) return true;
 
         std::string err2;
         //---Если немедленное удаление не удалось, пробуем отложенное удаление
-        if (deferRemoveWithCmd(fs::path{}, dataRoot, &err2)) return true;
+        if (deferRemoveWithCmd(fs::path{}, dataRoot, &err2))
+        {
+            if (defer) defer->deferred = true;
+            return true;
+        }
 
         //---Если оба метода не сработали, формируем объединенное сообщение об ошибке
         if (error)
@@ -294,6 +408,81 @@ namespace svcinst::platform {
         }
         return false;
     }
+    //------------------------------------------------------------
+    //  Оценка удаления для --plan: файлы и байты, ничего не удаляется
+    //------------------------------------------------------------
+    bool estimateRemoveDir(const fs::path& dir, std::uint64_t& files, std::uint64_t& bytes, std::string* error, const PathFilter* filter)
+    {
+        files = bytes = 0;
+        //---Проверка на пустой путь
+        if (dir.empty()) return true;
+
+        //---Те же проверки, что и перед настоящим удалением
+        if (isDangerousPath(dir))
+        {
+            if (error) *error = "Refuse to delete dangerous path: " + dir.string();
+            return false;
+        }
+
+        std::error_code ec;
+        if (!fs::exists(dir, ec)) return true;
+
+        //---Обход без перехода по симлинкам/junction'ам; с фильтром - курсор на каждый уровень,
+        //   оставленные каталоги не читаются
+        const bool filtered = filter && filter->active();
+        std::vector<PathFilter::Cursor> cursors;
+        if (filtered) cursors.push_back(filter->root());
+        fs::recursive_directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec))
+        {
+            std::error_code sec;
+            const fs::file_status st = it->symlink_status(sec);
+            if (sec)
+            {
+                if (filtered) it.disable_recursion_pending();
+                continue;
+            }
+            if (filtered)
+            {
+                cursors.resize(std::size_t(it.depth()) + 1);
+                PathFilter::Cursor child;
+                const PathFilter::Action action = filter->visit(cursors.back(), utf8Name(it->path()), fs::is_directory(st), child);
+                if (action == PathFilter::Action::Keep)
+                {
+                    if (fs::is_directory(st)) it.disable_recursion_pending();
+                    continue;
+                }
+                //---Remove: ниже фильтр ничего не оставит - курсор "выбрано всё"
+                if (fs::is_directory(st)) cursors.push_back(action == PathFilter::Action::Descend ? std::move(child) : PathFilter::Cursor{});
+            }
+            if (fs::is_directory(st)) continue;
+            ++files;
+            if (!fs::is_regular_file(st)) continue;
+            const std::uintmax_t n = it->file_size(sec);
+            if (!sec) bytes += n;
+        }
+        return true;
+    }
+    //------------------------------------------------------------
+    //  Корзина с фоновой очисткой (--trash) - только Linux:
+    //  на Windows удаление идёт на месте
+    //------------------------------------------------------------
+    bool moveToTrash(const fs::path& /*dir*/, fs::path& trash, std::string* error)
+    {
+        trash.clear();
+        if (error) *error = "--trash is not supported on Windows";
+        return false;
+    }
+    bool startReclaimer(const ReclaimJob& /*job*/, fs::path* /*statusFile*/, std::string* error)
+    {
+        if (error) *error = "--trash is not supported on Windows";
+        return false;
+    }
+    bool reclaim(const ReclaimJob& /*job*/, const std::string& /*waitFor*/, std::string* error)
+    {
+        if (error) *error = "--reclaim is not supported on Windows";
+        return false;
+    }
 } // namespace svcinst::platform
 
 #endif // _WIN32
@@ -0,0 +1,61 @@
+#pragma once
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//---Минимальный каркас тестов без внешних зависимостей: TEST_CASE регистрирует функцию,
+//	CHECK/CHECK_EQ отмечают провал и продолжают, REQUIRE - прерывает случай.
+//	main() - в TestMain.cpp: прогоняет все случаи, код выхода 1 - есть провалы.
+namespace svcinst::test {
+
+	struct Case {
+		const char* name;
+		std::function<void()> fn;
+	};
+	inline std::vector<Case>& cases()
+	{
+		static std::vector<Case> all;
+		return all;
+	}
+	inline int& failures()
+	{
+		static int n = 0;
+		return n;
+	}
+	struct Registrar {
+		Registrar(const char* name, std::function<void()> fn) { cases().push_back({ name, std::move(fn) }); }
+	};
+	struct Abort {};
+
+	inline void fail(const char* file, int line, const std::string& what)
+	{
+		++failures();
+		std::cerr << file << ":" << line << ": FAILED: " << what << "\n";
+	}
+
+	template <class A, class B>
+	std::string describe(const char* expr, const A& a, const B& b)
+	{
+		std::ostringstream os;
+		os << expr << " (" << a << " vs " << b << ")";
+		return os.str();
+	}
+
+} // namespace svcinst::test
+
+#define SVCINST_TEST_CAT2(a, b) a##b
+#define SVCINST_TEST_CAT(a, b) SVCINST_TEST_CAT2(a, b)
+#define TEST_CASE(name) \
+	static void SVCINST_TEST_CAT(test_, __LINE__)(); \
+	static ::svcinst::test::Registrar SVCINST_TEST_CAT(reg_, __LINE__)(name, SVCINST_TEST_CAT(test_, __LINE__)); \
+	static void SVCINST_TEST_CAT(test_, __LINE__)()
+
+#define CHECK(expr) \
+	do { if (!(expr)) ::svcinst::test::fail(__FILE__, __LINE__, #expr); } while (0)
+#define CHECK_EQ(a, b) \
+	do { const auto& va_ = (a); const auto& vb_ = (b); \
+		if (!(va_ == vb_)) ::svcinst::test::fail(__FILE__, __LINE__, ::svcinst::test::describe(#a " == " #b, va_, vb_)); } while (0)
+#define REQUIRE(expr) \
+	do { if (!(expr)) { ::svcinst::test::fail(__FILE__, __LINE__, #expr); throw ::svcinst::test::Abort{}; } } while (0)
@@ -0,0 +1,107 @@
+#include "Check.hpp"
+#include "service_installer/Cli.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+using namespace svcinst;
+
+namespace {
+
+	CliOptions parse(std::vector<std::string> args)
+	{
+		return parceCli(args);
+	}
+
+	bool startsWith(const std::string& s, const std::string& prefix)
+	{
+		return s.compare(0, prefix.size(), prefix) == 0;
+	}
+
+	//---Все ключи таблицы опций (Cli.cpp, kOptions) и требуется ли им значение
+	struct Key { const char* key; bool hasValue; };
+	const Key kKeys[] = {
+		{ "--install", false }, { "--uninstall", false }, { "--start", false }, { "--stop", false },
+		{ "--status", false }, { "--help", false }, { "--stop-first", false }, { "--run", false },
+		{ "--from-inno", false }, { "--stdin", false }, { "--plan", false }, { "--trash", false },
+		{ "--throttle", false },
+		{ "--name", true }, { "--exe", true }, { "--args", true }, { "--desc", true },
+		{ "--depends-on", true }, { "--group", true }, { "--delete", true }, { "--data-root", true },
+		{ "--root", true }, { "--backend", true }, { "--enable-via", true }, { "--durability", true },
+		{ "--lock-wait", true }, { "--manifest", true }, { "--reconcile", true }, { "--serve", true },
+		{ "--workers", true }, { "--reclaim", true }, { "--reclaim-dir", true }, { "--wait-for", true },
+		{ "--max-unlinks", true }, { "--max-delete-bytes", true }, { "--data-include", true },
+		{ "--data-exclude", true },
+	};
+
+} // namespace
+
+TEST_CASE("Cli: every key of the option table is found by the perfect hash")
+{
+	for (const Key& k : kKeys)
+	{
+		const std::string arg = std::string(k.key) + (k.hasValue ? "=1" : "");
+		const CliOptions o = parse({ arg });
+		if (startsWith(o.error, "unknown option")) test::fail(__FILE__, __LINE__, std::string(k.key) + ": " + o.error);
+
+		//---Наличие значения проверяется по той же записи таблицы
+		const std::string wrong = k.hasValue ? std::string(k.key) : std::string(k.key) + "=1";
+		const CliOptions w = parse({ wrong });
+		CHECK(w.cmd == Command::Invalid);
+		CHECK(w.error.find(k.hasValue ? "requires a value" : "does not take a value") != std::string::npos);
+	}
+}
+
+TEST_CASE("Cli: near-miss keys are unknown options")
+{
+	for (const char* key : { "--nam", "--name2", "--NAME", "--installx", "--", "--data", "--reclaim-di" })
+	{
+		const CliOptions o = parse({ std::string(key) + "=x" });
+		CHECK(o.cmd == Command::Invalid);
+		CHECK_EQ(o.error, "unknown option: " + std::string(key));
+	}
+	const CliOptions o = parse({ "install" });
+	CHECK_EQ(o.error, std::string("unexpected argument: install"));
+}
+
+TEST_CASE("Cli: a command line is parsed in one pass")
+{
+	const CliOptions o = parse({ "--install", "--name=api", "--exe=/opt/api/api", "--args=-v", "--args=--port 80",
+		"--depends-on=db", "--depends-on=cache", "--run", "--desc=\"API server\"" });
+	CHECK_EQ(o.error, std::string());
+	CHECK(o.cmd == Command::Install);
+	CHECK_EQ(o.name, std::string("api"));
+	CHECK_EQ(o.exe, std::string("/opt/api/api"));
+	CHECK_EQ(o.args, std::string("-v --port 80"));				//	Repeat::Join
+	CHECK_EQ(o.dependsOn, std::string("db,cache"));				//	Repeat::List
+	CHECK_EQ(o.description, std::string("API server"));			//	Кавычки вокруг значения снимаются
+	CHECK(o.runNow);
+}
+
+TEST_CASE("Cli: a repeated single-valued option must agree")
+{
+	const CliOptions same = parse({ "--start", "--name=a", "--name=a" });
+	CHECK_EQ(same.error, std::string());
+
+	const CliOptions diff = parse({ "--install", "--name=a", "--exe=/bin/a", "--exe=/bin/b" });
+	CHECK(diff.cmd == Command::Invalid);
+	CHECK_EQ(diff.error, std::string("conflicting values for --exe: '/bin/a' and '/bin/b'"));
+}
+
+TEST_CASE("Cli: @file expands to the arguments in that file")
+{
+	const std::string file = "cli_test_args.txt";
+	{
+		std::ofstream out(file);
+		out << "# comment\n--start\n\n--name=\"my svc\"\n";
+	}
+	const CliOptions o = parse({ "@" + file });
+	std::remove(file.c_str());
+	CHECK_EQ(o.error, std::string());
+	CHECK(o.cmd == Command::Start);
+	CHECK_EQ(o.name, std::string("my svc"));
+
+	const CliOptions missing = parse({ "@/nonexistent/cli_test_args.txt" });
+	CHECK(missing.cmd == Command::Invalid);
+	CHECK(startsWith(missing.error, "cannot open response file"));
+}
@@ -0,0 +1,153 @@
+#include "Check.hpp"
+#include "FakeSystemd.hpp"
+#include "service_installer/IServiceBackend.hpp"
+#include "service_installer/Platform.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+
+#include <sched.h>
+#include <sys/mount.h>
+#include <unistd.h>
+
+using namespace svcinst;
+using svcinst::test::FakeSystemd;
+
+namespace {
+
+	//---Окружение один раз на процесс, до первого обращения к шине и к таймаутам:
+	//	короткий таймаут операций, свой /etc/systemd/system (tmpfs в своём mount namespace,
+	//	только root) и подменный systemd
+	struct Env {
+		bool privateUnitDir = false;
+
+		Env()
+		{
+			::setenv("SVCINST_UNIT_TIMEOUT_MS", "1500", 1);
+			privateUnitDir = ::geteuid() == 0
+				&& ::unshare(CLONE_NEWNS) == 0
+				&& ::mount(nullptr, "/", nullptr, MS_REC | MS_PRIVATE, nullptr) == 0
+				&& ::mount("tmpfs", "/etc/systemd/system", "tmpfs", 0, "mode=0755") == 0;
+			FakeSystemd::instance();
+		}
+	};
+
+	Env& env()
+	{
+		static Env e;
+		return e;
+	}
+
+	std::unique_ptr<IServiceBackend> dbusBackend()
+	{
+		env();
+		BackendOptions bo;
+		bo.kind = BackendKind::SystemdDbus;
+		return makeBackend(bo);
+	}
+
+	bool called(const std::string& call)
+	{
+		const auto calls = FakeSystemd::instance().calls();
+		return std::find(calls.begin(), calls.end(), call) != calls.end();
+	}
+
+} // namespace
+
+TEST_CASE("dbus: the fake systemd is up")
+{
+	env();
+	CHECK_EQ(FakeSystemd::instance().error(), std::string());
+	REQUIRE(FakeSystemd::instance().ready());
+}
+
+TEST_CASE("dbus: start waits for its own JobRemoved \"done\"")
+{
+	auto backend = dbusBackend();
+	REQUIRE(backend && FakeSystemd::instance().ready());
+	FakeSystemd::instance().clearCalls();
+
+	std::string err;
+	CHECK(backend->start("svcinst-test-ok", &err));
+	CHECK_EQ(err, std::string());
+	CHECK(called("Subscribe"));
+	CHECK(called("StartUnit svcinst-test-ok.service"));
+
+	ServiceStatus st;
+	CHECK(backend->status("svcinst-test-ok", st, &err));
+	CHECK_EQ(st.activeState, std::string("active"));
+}
+
+TEST_CASE("dbus: a failed job is an error naming the result")
+{
+	auto backend = dbusBackend();
+	REQUIRE(backend && FakeSystemd::instance().ready());
+	FakeSystemd::instance().failUnit("svcinst-test-fail.service");
+
+	std::string err;
+	CHECK(!backend->start("svcinst-test-fail", &err));
+	CHECK(err.find("dbus StartUnit") != std::string::npos);
+	CHECK(err.find("svcinst-test-fail.service: job failed") != std::string::npos);
+}
+
+TEST_CASE("dbus: NoSuchUnit reads as inactive")
+{
+	auto backend = dbusBackend();
+	REQUIRE(backend && FakeSystemd::instance().ready());
+	FakeSystemd::instance().clearCalls();
+
+	std::string err;
+	ServiceStatus st;
+	CHECK(backend->status("svcinst-test-absent", st, &err));
+	CHECK(called("GetUnit svcinst-test-absent.service"));
+	CHECK_EQ(st.activeState, std::string("inactive"));
+	CHECK(!st.installed);
+}
+
+TEST_CASE("dbus: a job without JobRemoved times out")
+{
+	auto backend = dbusBackend();
+	REQUIRE(backend && FakeSystemd::instance().ready());
+	FakeSystemd::instance().hangUnit("svcinst-test-hang.service");
+
+	std::string err;
+	const auto t0 = std::chrono::steady_clock::now();
+	CHECK(!backend->start("svcinst-test-hang", &err));
+	const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+	CHECK(err.find("timed out after 1500 ms") != std::string::npos);
+	CHECK(ms >= 1400);
+	CHECK(ms < 10000);
+}
+
+TEST_CASE("dbus: install reloads and enables, uninstall disables and reloads")
+{
+	auto backend = dbusBackend();
+	REQUIRE(backend && FakeSystemd::instance().ready());
+	if (!env().privateUnitDir)
+	{
+		std::cout << "        (skipped: needs root for a private /etc/systemd/system)\n";
+		return;
+	}
+	FakeSystemd::instance().clearCalls();
+
+	ServiceSpec spec;
+	spec.name = "svcinst-test-install";
+	spec.exeAbs = "/bin/true";
+	spec.autostart = true;
+	std::string err;
+	InstallReport rep;
+	CHECK(backend->installOrUpdate(spec, &err, &rep));
+	CHECK_EQ(err, std::string());
+	CHECK(rep.unitWritten);
+	CHECK(rep.reloaded);
+	CHECK(rep.autostartChanged);
+	CHECK(called("Reload"));
+	CHECK(called("EnableUnitFiles svcinst-test-install.service"));
+
+	FakeSystemd::instance().clearCalls();
+	CHECK(backend->uninstall(spec.name, false, &err));
+	CHECK(called("DisableUnitFiles svcinst-test-install.service"));
+	CHECK(called("Reload"));
+}
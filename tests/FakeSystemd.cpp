@@ -0,0 +1,288 @@
+#include "FakeSystemd.hpp"
+
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace svcinst::test {
+
+	namespace {
+
+		constexpr const char* kDest = "org.freedesktop.systemd1";
+		constexpr const char* kPath = "/org/freedesktop/systemd1";
+		constexpr const char* kManager = "org.freedesktop.systemd1.Manager";
+
+		//---Первый строковый аргумент вызова (для *UnitFiles - первый элемент массива)
+		std::string firstString(DBusMessage* m)
+		{
+			DBusMessageIter it, arr;
+			const char* s = nullptr;
+			if (!dbus_message_iter_init(m, &it)) return {};
+			if (dbus_message_iter_get_arg_type(&it) == DBUS_TYPE_ARRAY)
+			{
+				dbus_message_iter_recurse(&it, &arr);
+				if (dbus_message_iter_get_arg_type(&arr) == DBUS_TYPE_STRING) dbus_message_iter_get_basic(&arr, &s);
+			}
+			else if (dbus_message_iter_get_arg_type(&it) == DBUS_TYPE_STRING)
+			{
+				dbus_message_iter_get_basic(&it, &s);
+			}
+			return s ? s : "";
+		}
+
+		//---Пустой a(sss): список изменений Enable/DisableUnitFiles
+		void appendNoChanges(DBusMessageIter* it)
+		{
+			DBusMessageIter arr;
+			dbus_message_iter_open_container(it, DBUS_TYPE_ARRAY, "(sss)", &arr);
+			dbus_message_iter_close_container(it, &arr);
+		}
+
+	} // namespace
+
+	FakeSystemd& FakeSystemd::instance()
+	{
+		static FakeSystemd fake;
+		return fake;
+	}
+
+	FakeSystemd::FakeSystemd()
+	{
+		dbus_threads_init_default();
+		if (!startBus()) return;
+		thread_ = std::thread([this] { serve(); });
+	}
+
+	FakeSystemd::~FakeSystemd()
+	{
+		stop_ = true;
+		if (thread_.joinable()) thread_.join();
+		if (conn_)
+		{
+			dbus_connection_close(conn_);
+			dbus_connection_unref(conn_);
+		}
+		if (daemon_ > 0)
+		{
+			::kill(daemon_, SIGTERM);
+			::waitpid(daemon_, nullptr, 0);
+		}
+		std::error_code ec;
+		if (!dir_.empty()) std::filesystem::remove_all(dir_, ec);
+	}
+
+	bool FakeSystemd::startBus()
+	{
+		char tmpl[] = "/tmp/svcinst-dbus-XXXXXX";
+		if (!::mkdtemp(tmpl))
+		{
+			error_ = "mkdtemp failed";
+			return false;
+		}
+		dir_ = tmpl;
+		const std::string sock = (dir_ / "bus").string();
+		const std::string conf = (dir_ / "bus.conf").string();
+		std::ofstream(conf) <<
+			"<!DOCTYPE busconfig PUBLIC \"-//freedesktop//DTD D-Bus Bus Configuration 1.0//EN\"\n"
+			" \"http://www.freedesktop.org/standards/dbus/1.0/busconfig.dtd\">\n"
+			"<busconfig><type>custom</type><listen>unix:path=" << sock << "</listen><auth>EXTERNAL</auth>\n"
+			"<policy context=\"default\"><allow send_destination=\"*\" eavesdrop=\"true\"/><allow eavesdrop=\"true\"/>"
+			"<allow own=\"*\"/><allow user=\"*\"/></policy></busconfig>\n";
+
+		const std::string confArg = "--config-file=" + conf;
+		const char* argv[] = { SVCINST_DBUS_DAEMON, confArg.c_str(), "--nofork", "--nopidfile", nullptr };
+		if (::posix_spawn(&daemon_, SVCINST_DBUS_DAEMON, nullptr, nullptr, const_cast<char**>(argv), environ) != 0)
+		{
+			daemon_ = -1;
+			error_ = std::string("cannot start ") + SVCINST_DBUS_DAEMON;
+			return false;
+		}
+
+		//---Ждём сокет шины (до 5 с)
+		const std::string address = "unix:path=" + sock;
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		DBusError err;
+		dbus_error_init(&err);
+		while (!conn_ && std::chrono::steady_clock::now() < deadline)
+		{
+			if (::access(sock.c_str(), F_OK) == 0) conn_ = dbus_connection_open_private(address.c_str(), &err);
+			if (dbus_error_is_set(&err)) dbus_error_free(&err);
+			if (!conn_) ::usleep(20 * 1000);
+		}
+		if (!conn_)
+		{
+			error_ = "dbus-daemon did not come up at " + address;
+			return false;
+		}
+		dbus_connection_set_exit_on_disconnect(conn_, FALSE);
+		if (!dbus_bus_register(conn_, &err)
+			|| dbus_bus_request_name(conn_, kDest, DBUS_NAME_FLAG_DO_NOT_QUEUE, &err) != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER)
+		{
+			error_ = std::string("cannot own ") + kDest + ": " + (dbus_error_is_set(&err) ? err.message : "not primary owner");
+			dbus_error_free(&err);
+			dbus_connection_close(conn_);
+			dbus_connection_unref(conn_);
+			conn_ = nullptr;
+			return false;
+		}
+		::setenv("DBUS_SYSTEM_BUS_ADDRESS", address.c_str(), 1);
+		return true;
+	}
+
+	void FakeSystemd::serve()
+	{
+		while (!stop_)
+		{
+			if (!dbus_connection_read_write(conn_, 50)) return;
+			while (DBusMessage* m = dbus_connection_pop_message(conn_))
+			{
+				if (dbus_message_get_type(m) == DBUS_MESSAGE_TYPE_METHOD_CALL) handle(m);
+				dbus_message_unref(m);
+			}
+		}
+	}
+
+	void FakeSystemd::handle(DBusMessage* m)
+	{
+		const std::string member = dbus_message_get_member(m) ? dbus_message_get_member(m) : "";
+		const std::string unit = firstString(m);
+		record(unit.empty() || member == "Get" ? member : member + " " + unit);
+
+		DBusMessage* reply = nullptr;
+		std::vector<DBusMessage*> signals;
+		if (member == "Subscribe" || member == "Reload")
+		{
+			reply = dbus_message_new_method_return(m);
+		}
+		else if (member == "EnableUnitFiles")
+		{
+			reply = dbus_message_new_method_return(m);
+			DBusMessageIter it;
+			dbus_message_iter_init_append(reply, &it);
+			const dbus_bool_t carriesInstallInfo = TRUE;
+			dbus_message_iter_append_basic(&it, DBUS_TYPE_BOOLEAN, &carriesInstallInfo);
+			appendNoChanges(&it);
+		}
+		else if (member == "DisableUnitFiles")
+		{
+			reply = dbus_message_new_method_return(m);
+			DBusMessageIter it;
+			dbus_message_iter_init_append(reply, &it);
+			appendNoChanges(&it);
+		}
+		else if (member == "StartUnit" || member == "StopUnit" || member == "RestartUnit")
+		{
+			std::string result = "done";
+			bool hang = false;
+			dbus_uint32_t id = 0;
+			{
+				std::lock_guard<std::mutex> lock(mu_);
+				id = ++jobId_;
+				hang = hang_.count(unit) != 0;
+				if (fail_.count(unit)) result = "failed";
+				else if (member == "StopUnit") active_.erase(unit);
+				else active_.insert(unit);
+			}
+			const std::string job = std::string(kPath) + "/job/" + std::to_string(id);
+			const char* jobPath = job.c_str();
+			reply = dbus_message_new_method_return(m);
+			dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &jobPath, DBUS_TYPE_INVALID);
+
+			//---Сначала чужой job: бэкенд должен ждать именно свой
+			auto jobRemoved = [](dbus_uint32_t jid, const std::string& path, const std::string& u, const std::string& res) {
+				DBusMessage* sig = dbus_message_new_signal(kPath, kManager, "JobRemoved");
+				const char* p = path.c_str();
+				const char* uu = u.c_str();
+				const char* r = res.c_str();
+				dbus_message_append_args(sig, DBUS_TYPE_UINT32, &jid, DBUS_TYPE_OBJECT_PATH, &p,
+					DBUS_TYPE_STRING, &uu, DBUS_TYPE_STRING, &r, DBUS_TYPE_INVALID);
+				return sig;
+			};
+			signals.push_back(jobRemoved(999999, std::string(kPath) + "/job/999999", "other.service", "done"));
+			if (!hang) signals.push_back(jobRemoved(id, job, unit, result));
+		}
+		else if (member == "GetUnit")
+		{
+			bool active;
+			{
+				std::lock_guard<std::mutex> lock(mu_);
+				active = active_.count(unit) != 0;
+			}
+			if (active)
+			{
+				std::string obj = std::string(kPath) + "/unit/";
+				for (char c : unit) obj += std::isalnum((unsigned char)c) ? c : '_';
+				const char* p = obj.c_str();
+				reply = dbus_message_new_method_return(m);
+				dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &p, DBUS_TYPE_INVALID);
+			}
+			else
+			{
+				reply = dbus_message_new_error(m, "org.freedesktop.systemd1.NoSuchUnit", ("Unit " + unit + " not loaded.").c_str());
+			}
+		}
+		else if (member == "Get")
+		{
+			reply = dbus_message_new_method_return(m);
+			DBusMessageIter it, var;
+			const char* state = "active";
+			dbus_message_iter_init_append(reply, &it);
+			dbus_message_iter_open_container(&it, DBUS_TYPE_VARIANT, "s", &var);
+			dbus_message_iter_append_basic(&var, DBUS_TYPE_STRING, &state);
+			dbus_message_iter_close_container(&it, &var);
+		}
+		else
+		{
+			reply = dbus_message_new_error(m, "org.freedesktop.DBus.Error.UnknownMethod", member.c_str());
+		}
+
+		dbus_connection_send(conn_, reply, nullptr);
+		dbus_message_unref(reply);
+		for (DBusMessage* sig : signals)
+		{
+			dbus_connection_send(conn_, sig, nullptr);
+			dbus_message_unref(sig);
+		}
+		dbus_connection_flush(conn_);
+	}
+
+	void FakeSystemd::record(const std::string& call)
+	{
+		std::lock_guard<std::mutex> lock(mu_);
+		calls_.push_back(call);
+	}
+
+	std::vector<std::string> FakeSystemd::calls()
+	{
+		std::lock_guard<std::mutex> lock(mu_);
+		return calls_;
+	}
+
+	void FakeSystemd::clearCalls()
+	{
+		std::lock_guard<std::mutex> lock(mu_);
+		calls_.clear();
+	}
+
+	void FakeSystemd::failUnit(const std::string& unit)
+	{
+		std::lock_guard<std::mutex> lock(mu_);
+		fail_.insert(unit);
+	}
+
+	void FakeSystemd::hangUnit(const std::string& unit)
+	{
+		std::lock_guard<std::mutex> lock(mu_);
+		hang_.insert(unit);
+	}
+
+} // namespace svcinst::test
@@ -0,0 +1,63 @@
+#pragma once
+#include <dbus/dbus.h>
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+
+//---Подменный org.freedesktop.systemd1 для тестов D-Bus бэкенда
+//	Поднимает свой dbus-daemon (сокет во временном каталоге), занимает на нём имя
+//	org.freedesktop.systemd1 и отвечает на вызовы Manager из отдельного потока:
+//	Subscribe/Reload/EnableUnitFiles/DisableUnitFiles - успех, Start/Stop/RestartUnit -
+//	путь job'а и затем JobRemoved (сначала чужой, потом свой) с "done", для failUnits -
+//	"failed", для hangUnits сигнала нет вовсе; GetUnit - NoSuchUnit для незапущенного.
+//	Адрес шины - в DBUS_SYSTEM_BUS_ADDRESS: libdbus читает его один раз, поэтому экземпляр
+//	один на процесс (instance()).
+namespace svcinst::test {
+
+	class FakeSystemd final {
+	public:
+		static FakeSystemd& instance();
+
+		~FakeSystemd();
+		FakeSystemd(const FakeSystemd&) = delete;
+		FakeSystemd& operator=(const FakeSystemd&) = delete;
+
+		//---Шина поднята и имя занято (иначе - error())
+		bool ready() const { return conn_ != nullptr; }
+		const std::string& error() const { return error_; }
+
+		//---Принятые вызовы: "<метод>[ <unit>]", по порядку
+		std::vector<std::string> calls();
+		void clearCalls();
+
+		void failUnit(const std::string& unit);
+		void hangUnit(const std::string& unit);
+
+	private:
+		FakeSystemd();
+		bool startBus();
+		void serve();
+		void handle(DBusMessage* m);
+		void record(const std::string& call);
+
+		std::filesystem::path dir_;
+		pid_t daemon_ = -1;
+		DBusConnection* conn_ = nullptr;
+		std::string error_;
+		std::thread thread_;
+		std::atomic<bool> stop_{ false };
+
+		std::mutex mu_;
+		std::vector<std::string> calls_;
+		std::set<std::string> fail_, hang_, active_;
+		dbus_uint32_t jobId_ = 0;
+	};
+
+} // namespace svcinst::test
@@ -0,0 +1,165 @@
+#include "Check.hpp"
+#include "service_installer/Installer.hpp"
+
+#include <map>
+#include <set>
+
+using namespace svcinst;
+
+namespace {
+
+	//---Бэкенд в памяти: зависимости задаются тестом, каждая волна (*Many) записывается
+	class FakeBackend final : public IServiceBackend {
+	public:
+		std::map<std::string, std::vector<std::string>> deps;
+		std::set<std::string> failing;				//	start/stop этих служб завершаются ошибкой
+		std::set<std::string> unreadable;			//	dependencies() для этих служб - ошибка
+		std::vector<std::string> waves;				//	"a b" - одна волна startMany/stopMany
+
+		bool installOrUpdate(const ServiceSpec&, std::string* error, InstallReport*) override { return unsupported(error); }
+		bool uninstall(const std::string&, bool, std::string* error) override { return unsupported(error); }
+		bool start(const std::string& name, std::string* error) override { return act(name, error); }
+		bool stop(const std::string& name, std::string* error) override { return act(name, error); }
+
+		void startMany(const std::vector<std::string>& names, std::vector<BatchResult>& results) override
+		{
+			record(names);
+			IServiceBackend::startMany(names, results);
+		}
+		void stopMany(const std::vector<std::string>& names, std::vector<BatchResult>& results) override
+		{
+			record(names);
+			IServiceBackend::stopMany(names, results);
+		}
+
+		bool dependencies(const std::string& name, std::vector<std::string>& out, std::string* error) override
+		{
+			out.clear();
+			if (unreadable.count(name))
+			{
+				if (error) *error = "cannot read unit";
+				return false;
+			}
+			const auto it = deps.find(name);
+			if (it != deps.end()) out = it->second;
+			return true;
+		}
+
+	private:
+		static bool unsupported(std::string* error)
+		{
+			if (error) *error = "not supported";
+			return false;
+		}
+		bool act(const std::string& name, std::string* error)
+		{
+			if (!failing.count(name)) return true;
+			if (error) *error = "job failed";
+			return false;
+		}
+		void record(const std::vector<std::string>& names)
+		{
+			std::string w;
+			for (const std::string& n : names) w += (w.empty() ? "" : " ") + n;
+			waves.push_back(w);
+		}
+	};
+
+	CommandResult group(FakeBackend& backend, Command cmd, const std::string& names)
+	{
+		CliOptions o;
+		o.cmd = cmd;
+		o.group = names;
+		o.lockWaitMs = 0;
+		return execute(o, backend);
+	}
+
+	std::string joined(const std::vector<std::string>& v)
+	{
+		std::string s;
+		for (const std::string& a : v) s += "[" + a + "]";
+		return s;
+	}
+
+	//---web -> api -> db, cache ни от чего не зависит
+	FakeBackend stack()
+	{
+		FakeBackend b;
+		b.deps["svcinst-t-web"] = { "svcinst-t-api" };
+		b.deps["svcinst-t-api"] = { "svcinst-t-db", "svcinst-t-outside" };	//	Вне группы - не учитывается
+		return b;
+	}
+
+	const char* kStack = "svcinst-t-web,svcinst-t-api,svcinst-t-db,svcinst-t-cache";
+
+} // namespace
+
+TEST_CASE("group: start runs dependencies first, independent services in one wave")
+{
+	FakeBackend b = stack();
+	const CommandResult r = group(b, Command::Start, kStack);
+	CHECK_EQ(r.error, std::string());
+	CHECK(r.ok());
+	CHECK_EQ(joined(b.waves), std::string("[svcinst-t-db svcinst-t-cache][svcinst-t-api][svcinst-t-web]"));
+}
+
+TEST_CASE("group: stop runs the same waves in reverse")
+{
+	FakeBackend b = stack();
+	const CommandResult r = group(b, Command::Stop, kStack);
+	CHECK(r.ok());
+	CHECK_EQ(joined(b.waves), std::string("[svcinst-t-web svcinst-t-cache][svcinst-t-api][svcinst-t-db]"));
+}
+
+TEST_CASE("group: a failed dependency leaves its dependents untouched")
+{
+	FakeBackend b = stack();
+	b.failing.insert("svcinst-t-db");
+	const CommandResult r = group(b, Command::Start, kStack);
+	CHECK_EQ(r.code, 1);
+	CHECK_EQ(joined(b.waves), std::string("[svcinst-t-db svcinst-t-cache]"));
+	CHECK_EQ(r.error, std::string(
+		"svcinst-t-web: dependency 'svcinst-t-api' failed to start; "
+		"svcinst-t-api: dependency 'svcinst-t-db' failed to start; "
+		"svcinst-t-db: job failed"));
+
+	//---stop: служба, зависимая от которой не остановилась, не трогается
+	FakeBackend s = stack();
+	s.failing.insert("svcinst-t-web");
+	const CommandResult rs = group(s, Command::Stop, kStack);
+	CHECK_EQ(joined(s.waves), std::string("[svcinst-t-web svcinst-t-cache]"));
+	CHECK(rs.error.find("svcinst-t-api: dependent 'svcinst-t-web' failed to stop") != std::string::npos);
+}
+
+TEST_CASE("group: services in a dependency cycle are reported, the rest still run")
+{
+	FakeBackend b;
+	b.deps["svcinst-t-a"] = { "svcinst-t-b" };
+	b.deps["svcinst-t-b"] = { "svcinst-t-a" };
+	b.deps["svcinst-t-d"] = { "svcinst-t-a" };		//	Зависит от цикла - тоже не запускается
+	const CommandResult r = group(b, Command::Start, "svcinst-t-a,svcinst-t-b,svcinst-t-c,svcinst-t-d");
+	CHECK_EQ(r.code, 1);
+	CHECK_EQ(joined(b.waves), std::string("[svcinst-t-c]"));
+	CHECK_EQ(r.error, std::string(
+		"svcinst-t-a: dependency cycle involving 'svcinst-t-a'; "
+		"svcinst-t-b: dependency cycle involving 'svcinst-t-b'; "
+		"svcinst-t-d: dependency cycle involving 'svcinst-t-d'"));
+}
+
+TEST_CASE("group: unreadable dependencies fail only that service")
+{
+	FakeBackend b = stack();
+	b.unreadable.insert("svcinst-t-cache");
+	const CommandResult r = group(b, Command::Start, kStack);
+	CHECK_EQ(r.error, std::string("svcinst-t-cache: cannot read unit"));
+	CHECK_EQ(joined(b.waves), std::string("[svcinst-t-db][svcinst-t-api][svcinst-t-web]"));
+}
+
+TEST_CASE("group: an empty group is an error")
+{
+	FakeBackend b;
+	const CommandResult r = group(b, Command::Start, " , ");
+	CHECK_EQ(r.code, 1);
+	CHECK_EQ(r.error, std::string("--group is empty"));
+	CHECK(b.waves.empty());
+}
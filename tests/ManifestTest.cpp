@@ -0,0 +1,108 @@
+#include "Check.hpp"
+#include "service_installer/Manifest.hpp"
+
+using namespace svcinst;
+
+namespace {
+
+	std::vector<std::string> split(const std::string& line)
+	{
+		std::vector<std::string> out;
+		std::string err;
+		if (!splitCommandLine(line, out, &err)) test::fail(__FILE__, __LINE__, "split '" + line + "': " + err);
+		return out;
+	}
+
+	ManifestEntry command(const std::string& line)
+	{
+		ManifestEntry e;
+		parseCommand(line, e);
+		return e;
+	}
+
+	std::string joined(const std::vector<std::string>& v)
+	{
+		std::string s;
+		for (const std::string& a : v) s += "[" + a + "]";
+		return s;
+	}
+
+} // namespace
+
+TEST_CASE("splitCommandLine: blanks separate, quotes group and are removed")
+{
+	CHECK_EQ(joined(split("  --start \t --name=a  ")), std::string("[--start][--name=a]"));
+	CHECK_EQ(joined(split("--desc=\"my service\" --args='-x \"y\"'")), std::string("[--desc=my service][--args=-x \"y\"]"));
+	CHECK_EQ(joined(split("a\"b c\"d")), std::string("[ab cd]"));
+	CHECK_EQ(joined(split("\"\"")), std::string("[]"));		//	Пустой аргумент в кавычках - аргумент
+	CHECK_EQ(joined(split("")), std::string());
+}
+
+TEST_CASE("splitCommandLine: backslash escapes only quotes and blanks")
+{
+	CHECK_EQ(joined(split("--exe=C:\\svc\\a.exe")), std::string("[--exe=C:\\svc\\a.exe]"));
+	CHECK_EQ(joined(split("a\\ b")), std::string("[a b]"));
+	CHECK_EQ(joined(split("\"say \\\"hi\\\"\"")), std::string("[say \"hi\"]"));
+	CHECK_EQ(joined(split("'a\\\"b'")), std::string("[a\\\"b]"));	//	В '...' \ экранирует только '
+}
+
+TEST_CASE("splitCommandLine: an unterminated quote is an error")
+{
+	std::vector<std::string> out;
+	std::string err;
+	CHECK(!splitCommandLine("--name=\"a", out, &err));
+	CHECK_EQ(err, std::string("unterminated \" quote"));
+}
+
+TEST_CASE("parseCommand: command-line form")
+{
+	const ManifestEntry e = command("--install --name=api --exe=/opt/api/api --run");
+	CHECK_EQ(e.error, std::string());
+	CHECK(!e.json);
+	CHECK(e.opt.cmd == Command::Install);
+	CHECK_EQ(e.opt.name, std::string("api"));
+	CHECK(e.opt.runNow);
+
+	CHECK_EQ(command("--start --name=a --backend=dbus").error, std::string("--backend applies to the whole run; pass it on the command line"));
+	CHECK_EQ(command("--start --name=a @more.txt").error, std::string("response files (@more.txt) are accepted on the command line only"));
+	CHECK_EQ(command("--start").error, std::string("missing required option: --name=<service_name>"));
+}
+
+TEST_CASE("JsonCommandReader: keys map to options, id is returned verbatim")
+{
+	const ManifestEntry e = command(R"( {"cmd":"install", "name":"api", "exe":"/opt/api/api", "run":true, "stop-first":false, "desc":null, "id":42} )");
+	CHECK_EQ(e.error, std::string());
+	CHECK(e.json);
+	CHECK_EQ(e.id, std::string("42"));
+	CHECK(e.opt.cmd == Command::Install);
+	CHECK_EQ(e.opt.name, std::string("api"));
+	CHECK_EQ(e.opt.exe, std::string("/opt/api/api"));
+	CHECK(e.opt.runNow);
+	CHECK(!e.opt.stopFirst);
+	CHECK_EQ(e.opt.description, std::string());
+
+	CHECK_EQ(command(R"({"cmd":"start","name":"a","id":"req-7"})").id, std::string("\"req-7\""));
+	CHECK_EQ(command(R"({"cmd":"start","name":"a","lock-wait":500})").error, std::string("--lock-wait applies to the whole run; pass it on the command line"));
+}
+
+TEST_CASE("JsonCommandReader: string escapes, including surrogate pairs")
+{
+	const ManifestEntry e = command(R"({"cmd":"start","name":"a\u00e9\ud83d\ude00\"\\\/\t"})");
+	CHECK_EQ(e.error, std::string());
+	CHECK_EQ(e.opt.name, std::string("a\xC3\xA9\xF0\x9F\x98\x80\"\\/\t"));
+}
+
+TEST_CASE("JsonCommandReader: malformed input is rejected with an offset")
+{
+	CHECK_EQ(command("{\"cmd\":\"start\" \"name\":\"a\"}").error, std::string("json: expected ',' or '}' at offset 15"));
+	CHECK_EQ(command("{\"cmd\":\"start\"} x").error, std::string("json: trailing characters after '}' at offset 16"));
+	CHECK_EQ(command("{\"cmd\":\"\"}").error, std::string("json: \"cmd\" must be a non-empty string at offset 9"));
+	CHECK(command("{\"cmd\":\"start\",\"name\":[1]}").error.find("unsupported value for \"name\"") != std::string::npos);
+	CHECK(command("{\"cmd\":\"start\",\"name\":\"\\ud800\"}").error.find("bad string value") != std::string::npos);
+	CHECK(command("{\"cmd\":\"start\",\"name\":\"a").error.find("bad string value") != std::string::npos);
+}
+
+TEST_CASE("jsonEscape: control characters and quotes")
+{
+	CHECK_EQ(jsonEscape("a\"b\\c\nd\x01"), std::string("a\\\"b\\\\c\\nd\\u0001"));
+}
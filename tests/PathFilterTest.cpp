@@ -0,0 +1,149 @@
+#include "Check.hpp"
+#include "PathFilter.hpp"
+
+using namespace svcinst;
+using Action = PathFilter::Action;
+
+namespace {
+
+	PathFilter make(const std::vector<std::string>& include, const std::vector<std::string>& exclude)
+	{
+		PathFilter f;
+		std::string err;
+		if (!f.compile(include, exclude, &err)) test::fail(__FILE__, __LINE__, "compile: " + err);
+		return f;
+	}
+
+	//---Решение для пути "a/b/c" так, как его принял бы обход: промежуточные каталоги
+	//	проходятся visit'ом; первый уровень, где решение не Descend, - итог (в каталог не зашли)
+	Action decide(const PathFilter& f, const std::string& path, bool isDir)
+	{
+		PathFilter::Cursor cur = f.root();
+		for (std::size_t pos = 0;;)
+		{
+			const std::size_t slash = path.find('/', pos);
+			const bool last = slash == std::string::npos;
+			const std::string name = path.substr(pos, last ? std::string::npos : slash - pos);
+			PathFilter::Cursor child;
+			const Action a = f.visit(cur, name, last ? isDir : true, child);
+			if (last || a != Action::Descend) return a;
+			cur = std::move(child);
+			pos = slash + 1;
+		}
+	}
+
+	const char* name(Action a)
+	{
+		return a == Action::Keep ? "Keep" : a == Action::Remove ? "Remove" : "Descend";
+	}
+
+} // namespace
+
+#define CHECK_ACTION(f, path, isDir, expected) CHECK_EQ(std::string(name(decide(f, path, isDir))), std::string(name(expected)))
+
+TEST_CASE("PathFilter: without patterns everything is removed whole")
+{
+	const PathFilter f = make({}, {});
+	CHECK(!f.active());
+	CHECK(f.root().selected);
+	CHECK_ACTION(f, "a", true, Action::Remove);
+	CHECK_ACTION(f, "a.txt", false, Action::Remove);
+}
+
+TEST_CASE("PathFilter: a pattern without '/' matches at any depth, with '/' only from the root")
+{
+	const PathFilter any = make({ "*.log" }, {});
+	CHECK_ACTION(any, "x.log", false, Action::Remove);
+	CHECK_ACTION(any, "a/b/x.log", false, Action::Remove);
+	CHECK_ACTION(any, "a/b/x.txt", false, Action::Keep);
+
+	const PathFilter anchored = make({ "logs/*.log" }, {});
+	CHECK_ACTION(anchored, "logs/x.log", false, Action::Remove);
+	CHECK_ACTION(anchored, "sub/logs/x.log", false, Action::Keep);
+
+	const PathFilter leading = make({ "/x.log" }, {});
+	CHECK_ACTION(leading, "x.log", false, Action::Remove);
+	CHECK_ACTION(leading, "a/x.log", false, Action::Keep);
+}
+
+TEST_CASE("PathFilter: '**' matches zero or more levels")
+{
+	const PathFilter f = make({ "cache/**/*.tmp" }, {});
+	CHECK_ACTION(f, "cache/a.tmp", false, Action::Remove);
+	CHECK_ACTION(f, "cache/x/a.tmp", false, Action::Remove);
+	CHECK_ACTION(f, "cache/x/y/z/a.tmp", false, Action::Remove);
+	CHECK_ACTION(f, "cache/x/a.dat", false, Action::Keep);
+	CHECK_ACTION(f, "other/a.tmp", false, Action::Keep);
+
+	const PathFilter tail = make({ "cache/**" }, {});
+	CHECK_ACTION(tail, "cache/x", true, Action::Remove);
+	CHECK_ACTION(tail, "cache/x/y.dat", false, Action::Remove);
+}
+
+TEST_CASE("PathFilter: a trailing '/' matches directories only")
+{
+	const PathFilter f = make({}, { "tmp/" });
+	CHECK_ACTION(f, "tmp", true, Action::Keep);
+	CHECK_ACTION(f, "tmp", false, Action::Remove);
+	CHECK_ACTION(f, "a/tmp", true, Action::Keep);
+}
+
+TEST_CASE("PathFilter: character classes, [!x] and escapes")
+{
+	const PathFilter cls = make({ "file[!0-9].txt", "v[ab].dat" }, {});
+	CHECK_ACTION(cls, "filea.txt", false, Action::Remove);
+	CHECK_ACTION(cls, "file1.txt", false, Action::Keep);
+	CHECK_ACTION(cls, "va.dat", false, Action::Remove);
+	CHECK_ACTION(cls, "vc.dat", false, Action::Keep);
+
+	const PathFilter esc = make({ "a\\*b", "q\\?" }, {});
+	CHECK_ACTION(esc, "a*b", false, Action::Remove);
+	CHECK_ACTION(esc, "axb", false, Action::Keep);
+	CHECK_ACTION(esc, "q?", false, Action::Remove);
+	CHECK_ACTION(esc, "qx", false, Action::Keep);
+
+	const PathFilter q = make({ "?.log" }, {});
+	CHECK_ACTION(q, "a.log", false, Action::Remove);
+	CHECK_ACTION(q, "ab.log", false, Action::Keep);
+}
+
+TEST_CASE("PathFilter: an excluded or unreachable directory is kept without descending")
+{
+	const PathFilter excl = make({}, { "data/" });
+	PathFilter::Cursor child;
+	CHECK_EQ(std::string(name(excl.visit(excl.root(), "data", true, child))), std::string("Keep"));
+
+	//---Под "other" include уже не совпадёт - туда не заходим
+	const PathFilter incl = make({ "logs/*.log" }, {});
+	CHECK_EQ(std::string(name(incl.visit(incl.root(), "other", true, child))), std::string("Keep"));
+	CHECK_EQ(std::string(name(incl.visit(incl.root(), "logs", true, child))), std::string("Descend"));
+
+	//---Выбранный каталог без исключений ниже удаляется целиком, без обхода
+	const PathFilter whole = make({ "cache/" }, {});
+	CHECK_EQ(std::string(name(whole.visit(whole.root(), "cache", true, child))), std::string("Remove"));
+}
+
+TEST_CASE("PathFilter: exclude wins over include")
+{
+	const PathFilter f = make({ "*.log" }, { "keep/", "important.log" });
+	CHECK_ACTION(f, "a.log", false, Action::Remove);
+	CHECK_ACTION(f, "important.log", false, Action::Keep);
+	CHECK_ACTION(f, "x/important.log", false, Action::Keep);
+	CHECK_ACTION(f, "keep/a.log", false, Action::Keep);
+
+	//---Выбранный каталог, под которым что-то исключено: обходится, а не удаляется целиком
+	const PathFilter sel = make({ "cache/" }, { "cache/pinned" });
+	CHECK_ACTION(sel, "cache", true, Action::Descend);
+	CHECK_ACTION(sel, "cache/pinned", false, Action::Keep);
+	CHECK_ACTION(sel, "cache/other", false, Action::Remove);
+}
+
+TEST_CASE("PathFilter: invalid patterns are rejected")
+{
+	PathFilter f;
+	std::string err;
+	CHECK(!f.compile({ "../etc" }, {}, &err));
+	CHECK(err.find("'..'") != std::string::npos);
+	CHECK(!f.compile({}, { "/" }, &err));
+	CHECK(err.find("empty pattern") != std::string::npos);
+}
@@ -0,0 +1,148 @@
+#include "Check.hpp"
+#include "service_installer/Process.hpp"
+
+#include <chrono>
+#include <optional>
+
+using namespace svcinst::process;
+
+namespace {
+
+	using Clock = std::chrono::steady_clock;
+
+	long long msSince(Clock::time_point t0)
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - t0).count();
+	}
+
+	Task<int> exitCodeOf(AsyncRunner& runner, std::string script)
+	{
+		std::vector<std::string> args{ "-c", std::move(script) };
+		RunResult r = co_await runner.runAsync("/bin/sh", std::move(args));
+		co_return r.exitCode;
+	}
+
+	Task<int> markAfterRun(AsyncRunner& runner, bool& resumed)
+	{
+		std::vector<std::string> args{ "-c", "sleep 0.2" };
+		RunResult r = co_await runner.runAsync("/bin/sh", std::move(args));
+		resumed = true;
+		co_return r.exitCode;
+	}
+
+} // namespace
+
+TEST_CASE("AsyncRunner: children run in parallel")
+{
+	AsyncRunner runner;
+	int done = 0;
+	const auto t0 = Clock::now();
+	for (int i = 0; i < 4; ++i)
+	{
+		CHECK(runner.spawn("/bin/sh", { "-c", "sleep 0.3; exit " + std::to_string(i) }, {}, [&, i](RunResult& r) {
+			CHECK(r.started);
+			CHECK_EQ(r.exitCode, i);
+			++done;
+		}));
+	}
+	CHECK_EQ(runner.pending(), std::size_t(4));
+	runner.run();
+	CHECK_EQ(done, 4);
+	CHECK_EQ(runner.pending(), std::size_t(0));
+	CHECK(msSince(t0) < 1000);		//	Последовательно было бы >= 1200 мс
+}
+
+TEST_CASE("AsyncRunner: timeout escalates from SIGTERM to SIGKILL")
+{
+	AsyncRunner runner;
+	RunOptions opt;
+	opt.timeoutMs = 200;
+	opt.killGraceMs = 200;
+	std::optional<RunResult> res;
+	const auto t0 = Clock::now();
+	//---SIGTERM игнорируется (и наследуется sleep) - завершит только SIGKILL
+	runner.spawn("/bin/sh", { "-c", "trap '' TERM; sleep 5" }, opt, [&](RunResult& r) { res = std::move(r); });
+	runner.run();
+	REQUIRE(res.has_value());
+	CHECK(res->started);
+	CHECK(res->timedOut);
+	CHECK_EQ(res->exitCode, 128 + 9);
+	const long long ms = msSince(t0);
+	CHECK(ms >= 350);
+	CHECK(ms < 3000);
+}
+
+TEST_CASE("AsyncRunner: timeout ends on SIGTERM when the child honours it")
+{
+	AsyncRunner runner;
+	RunOptions opt;
+	opt.timeoutMs = 100;
+	opt.killGraceMs = 5000;
+	std::optional<RunResult> res;
+	const auto t0 = Clock::now();
+	runner.spawn("/bin/sleep", { "5" }, opt, [&](RunResult& r) { res = std::move(r); });
+	runner.run();
+	REQUIRE(res.has_value());
+	CHECK(res->timedOut);
+	CHECK_EQ(res->exitCode, 128 + 15);
+	CHECK(msSince(t0) < 2000);
+}
+
+TEST_CASE("AsyncRunner: captures stdout and stderr separately, with truncation")
+{
+	AsyncRunner runner;
+	RunOptions opt;
+	opt.captureOutput = true;
+	opt.maxCaptureBytes = 8;
+	std::optional<RunResult> a, b;
+	runner.spawn("/bin/sh", { "-c", "echo out; echo err >&2; exit 3" }, opt, [&](RunResult& r) { a = std::move(r); });
+	runner.spawn("/bin/sh", { "-c", "printf 0123456789abcdef" }, opt, [&](RunResult& r) { b = std::move(r); });
+	runner.run();
+	REQUIRE(a.has_value() && b.has_value());
+	CHECK_EQ(a->exitCode, 3);
+	CHECK_EQ(a->stdOut, std::string("out\n"));
+	CHECK_EQ(a->stdErr, std::string("err\n"));
+	CHECK(!a->stdOutTruncated);
+	CHECK_EQ(b->stdOut, std::string("01234567"));
+	CHECK(b->stdOutTruncated);
+}
+
+TEST_CASE("AsyncRunner: spawn failure is delivered through the callback")
+{
+	AsyncRunner runner;
+	std::optional<RunResult> res;
+	const bool ok = runner.spawn("/nonexistent/svcinst-test", {}, {}, [&](RunResult& r) { res = std::move(r); });
+	CHECK(!ok);
+	CHECK(!res.has_value());		//	Не из spawn: только из цикла
+	runner.run();
+	REQUIRE(res.has_value());
+	CHECK(!res->started);
+	CHECK(res->sysError != 0);
+}
+
+TEST_CASE("AsyncRunner: co_await runAsync resumes the task with the result")
+{
+	AsyncRunner runner;
+	Task<int> a = exitCodeOf(runner, "exit 7");
+	Task<int> b = exitCodeOf(runner, "sleep 0.1; exit 9");
+	CHECK(!a.done());
+	runner.run();
+	REQUIRE(a.done() && b.done());
+	CHECK_EQ(a.result(), 7);
+	CHECK_EQ(b.result(), 9);
+}
+
+TEST_CASE("AsyncRunner: destroying a task parked in co_await cancels the delivery")
+{
+	AsyncRunner runner;
+	bool resumed = false;
+	{
+		Task<int> t = markAfterRun(runner, resumed);
+		CHECK(!t.done());
+	}
+	//---Кадр уже уничтожен: завершение потомка не должно его возобновить
+	CHECK_EQ(runner.pending(), std::size_t(1));
+	runner.run();
+	CHECK(!resumed);
+	CHECK_EQ(runner.pending(), std::size_t(0));
+}
@@ -0,0 +1,122 @@
+#include "Check.hpp"
+#include "platform/linux/SystemdCommon.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+using namespace svcinst;
+using namespace svcinst::systemd;
+
+namespace {
+
+	ServiceSpec spec(const fs::path& root = {})
+	{
+		ServiceSpec s;
+		s.name = "svcinst-test";
+		s.exeAbs = "/opt/test/svc";
+		s.args = "--port 80";
+		s.autostart = false;
+		s.root = root;
+		return s;
+	}
+
+	//---Unit без первой строки-маркера: так писала версия до --reconcile
+	std::string withoutMarker(const std::string& rendered)
+	{
+		return rendered.substr(std::strlen(kManagedMarker) + 1);
+	}
+
+	//---Временный альтернативный корень с каталогом unit'ов
+	struct TempRoot {
+		fs::path path;
+
+		TempRoot()
+		{
+			char tmpl[] = "/tmp/svcinst-root-XXXXXX";
+			if (::mkdtemp(tmpl)) path = tmpl;
+			fs::create_directories(unitDir(path));
+		}
+		~TempRoot()
+		{
+			std::error_code ec;
+			if (!path.empty()) fs::remove_all(path, ec);
+		}
+
+		void write(const std::string& file, const std::string& content) const
+		{
+			std::ofstream(unitDir(path) / file, std::ios::binary) << content;
+		}
+	};
+
+} // namespace
+
+TEST_CASE("systemd: a rendered unit starts with the managed marker")
+{
+	const std::string unit = renderUnit(spec());
+	CHECK(isManagedUnit(unit));
+	CHECK(!isManagedUnit(withoutMarker(unit)));
+	CHECK(!isManagedUnit(kManagedMarker));							//	Маркер без перевода строки - не маркер
+	CHECK(!isManagedUnit(std::string(kManagedMarker) + " x\n"));
+	CHECK(unit.find("ExecStart=/opt/test/svc --port 80\n") != std::string::npos);
+}
+
+TEST_CASE("systemd: unitMatches ignores only a missing marker")
+{
+	const std::string unit = renderUnit(spec());
+	CHECK(unitMatches(unit, unit));
+	CHECK(unitMatches(withoutMarker(unit), unit));
+
+	//---Любое другое отличие - изменение
+	std::string edited = unit;
+	edited.replace(edited.find("RestartSec=2"), 12, "RestartSec=5");
+	CHECK(!unitMatches(edited, unit));
+	CHECK(!unitMatches(withoutMarker(edited), unit));
+	CHECK(!unitMatches(withoutMarker(unit) + "\n", unit));
+	CHECK(!unitMatches("", unit));
+
+	//---Без маркера в rendered сравнение точное
+	CHECK(!unitMatches(withoutMarker(withoutMarker(unit)), withoutMarker(unit)));
+}
+
+TEST_CASE("systemd: inspectUnit under an alternate root")
+{
+	const TempRoot root;
+	REQUIRE(!root.path.empty());
+	const ServiceSpec s = spec(root.path);
+	CHECK(inspectUnit(s) == SpecState::Missing);
+
+	root.write("svcinst-test.service", renderUnit(s));
+	CHECK(inspectUnit(s) == SpecState::UpToDate);
+
+	root.write("svcinst-test.service", withoutMarker(renderUnit(s)));
+	CHECK(inspectUnit(s) == SpecState::UpToDate);
+
+	ServiceSpec changed = s;
+	changed.args = "--port 81";
+	CHECK(inspectUnit(changed) == SpecState::Differs);
+}
+
+TEST_CASE("systemd: listManagedUnits returns only units with the marker")
+{
+	const TempRoot root;
+	REQUIRE(!root.path.empty());
+	const std::string unit = renderUnit(spec());
+	root.write("b-managed.service", unit);
+	root.write("a-managed.service", unit);
+	root.write("legacy.service", withoutMarker(unit));
+	root.write("foreign.service", "[Unit]\nDescription=x\n");
+	root.write("short.service", kManagedMarker);
+	root.write("not-a-unit.conf", unit);
+
+	std::vector<std::string> names;
+	std::string err;
+	CHECK(listManagedUnits(root.path, names, &err));
+	REQUIRE(names.size() == 2);
+	CHECK_EQ(names[0], std::string("a-managed"));
+	CHECK_EQ(names[1], std::string("b-managed"));
+
+	//---Каталога unit'ов нет - служб нет, это не ошибка
+	CHECK(listManagedUnits(root.path / "absent", names, &err));
+	CHECK(names.empty());
+}
@@ -0,0 +1,26 @@
+#include "Check.hpp"
+
+#include <exception>
+
+int main()
+{
+	using namespace svcinst::test;
+	for (const Case& c : cases())
+	{
+		const int before = failures();
+		try
+		{
+			c.fn();
+		}
+		catch (const Abort&)
+		{
+		}
+		catch (const std::exception& e)
+		{
+			fail(__FILE__, __LINE__, std::string(c.name) + ": exception: " + e.what());
+		}
+		std::cout << (failures() == before ? "ok      " : "FAILED  ") << c.name << "\n";
+	}
+	std::cout << cases().size() << " case(s), " << failures() << " failure(s)\n";
+	return failures() == 0 ? 0 : 1;
+}